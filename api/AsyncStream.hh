@@ -0,0 +1,284 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef avro_AsyncStream_hh__
+#define avro_AsyncStream_hh__
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <vector>
+#include "ResumableDecoder.hh"
+#include "Stream.hh"
+
+#if defined(__cpp_impl_coroutine) && __cpp_impl_coroutine >= 201902L
+#include <coroutine>
+#define AVRO_HAS_COROUTINES 1
+#endif
+
+/* Streams over non-blocking file descriptors, such as sockets, driven by an epoll event loop.
+
+   Nothing here ever blocks: a stream that has no data to offer, or no room to take any, registers its descriptor with an EpollReactor and
+   carries on from the reactor's callback once the descriptor is ready.  A single thread running the reactor can therefore serve any number
+   of streams, each of them costing only its buffers.  A reactor keeps one handler per descriptor, so a socket that is both read and
+   written needs a dup() of its descriptor for one of the two streams.  When the compiler supports C++20 coroutines,
+   AsyncInputStream::next() can also be co_awaited.*/
+namespace avro {
+
+  /* Waits for readiness of file descriptors with epoll and calls their handlers, all from the thread that calls poll() or run().  Handlers
+     may add, modify and remove descriptors, including their own.  Descriptors are level-triggered, so a handler that leaves data unread is
+     called again on the next poll().*/
+  class EpollReactor {
+  public:
+
+    /* Called with the epoll events that are ready, EPOLLIN, EPOLLOUT, EPOLLHUP or EPOLLERR.*/
+    typedef std::function<void(uint32_t events)> Handler;
+
+    EpollReactor();
+    ~EpollReactor();
+
+    EpollReactor(const EpollReactor&) = delete;
+    const EpollReactor& operator=(const EpollReactor&) = delete;
+
+    /* Starts watching fd for the given events.  The descriptor should be non-blocking.*/
+    void add(int fd, uint32_t events, const Handler& handler);
+
+    /* Changes the events watched for on fd.*/
+    void modify(int fd, uint32_t events);
+
+    /* Stops watching fd.  Its handler is not called anymore, even for events already collected.*/
+    void remove(int fd);
+
+    /* Whether fd is being watched.*/
+    bool contains(int fd) const {
+      return handlers_.find(fd) != handlers_.end();
+    }
+
+    /* The number of descriptors being watched.*/
+    size_t size() const {
+      return handlers_.size();
+    }
+
+    /* Waits up to timeoutMs milliseconds, forever if negative, for some descriptor to be ready and calls the handlers of those that are.
+       Returns the number of handlers called.  An exception thrown by a handler is passed on to the caller.*/
+    size_t poll(int timeoutMs = -1);
+
+    /* Calls poll() until stop() is called or no descriptors are left.*/
+    void run();
+
+    /* Makes run() return after the handlers of the current poll().*/
+    void stop() {
+      stopped_ = true;
+    }
+
+  private:
+
+    int epfd_;
+    std::map<int, std::shared_ptr<Handler> > handlers_;
+    bool stopped_;
+  };
+
+  /* The reading end of a non-blocking file descriptor, handing out whatever the descriptor has to offer as it arrives.  This is the
+     asynchronous counterpart of an InputStream: instead of waiting for the next chunk, next() asks for the handler to be called with it
+     once the descriptor is readable.
+
+     A chunk is valid until the next chunk is asked for.  Only one request may be outstanding at a time.  The descriptor is not closed.*/
+  class AsyncInputStream {
+  public:
+
+    /* Called with the next chunk, or with len 0 at the end of the stream.*/
+    typedef std::function<void(const uint8_t* data, size_t len)> ChunkHandler;
+
+    AsyncInputStream(EpollReactor& reactor, int fd, size_t chunkSize = 64 * 1024);
+    ~AsyncInputStream();
+
+    AsyncInputStream(const AsyncInputStream&) = delete;
+    const AsyncInputStream& operator=(const AsyncInputStream&) = delete;
+
+    /* Reads the next chunk if one is available right away, without involving the reactor.  Returns true with the chunk, or with len 0 at
+       the end of the stream; false if the descriptor has nothing to offer yet.  Throws if the read fails.*/
+    bool tryNext(const uint8_t** data, size_t* len);
+
+    /* Calls handler with the next chunk from a later poll() of the reactor, never from within this call.*/
+    void next(const ChunkHandler& handler);
+
+    /* Whether the end of the stream has been seen.*/
+    bool eof() const {
+      return eof_;
+    }
+
+    /* The number of bytes read so far.*/
+    size_t byteCount() const {
+      return byteCount_;
+    }
+
+#ifdef AVRO_HAS_COROUTINES
+
+    /* Resumes the awaiting coroutine with the next chunk, as a pair of data and length, once the reactor finds the descriptor readable.*/
+    class ChunkAwaiter {
+    public:
+
+      explicit ChunkAwaiter(AsyncInputStream& in) : in_(in), data_(0), len_(0) { }
+
+      bool await_ready() {
+        return in_.tryNext(&data_, &len_);
+      }
+
+      void await_suspend(std::coroutine_handle<> h) {
+        in_.next([this, h](const uint8_t* data, size_t len) {
+          data_ = data;
+          len_ = len;
+          h.resume();
+        });
+      }
+
+      std::pair<const uint8_t*, size_t> await_resume() const {
+        return std::make_pair(data_, len_);
+      }
+
+    private:
+      AsyncInputStream& in_;
+      const uint8_t* data_;
+      size_t len_;
+    };
+
+    ChunkAwaiter next() {
+      return ChunkAwaiter(*this);
+    }
+#endif
+
+  private:
+
+    void onReady();
+
+    EpollReactor& reactor_;
+    const int fd_;
+    std::vector<uint8_t> buffer_;
+    ChunkHandler pending_;
+    bool eof_;
+    size_t byteCount_;
+  };
+
+  /* An OutputStream whose bytes go to a non-blocking file descriptor.  Written bytes are buffered; flush() writes what the descriptor takes
+     right away and leaves the rest to be written from the reactor once it is writable again, so flush() never waits.  Watch pendingBytes()
+     and onDrained() to keep a slow peer from piling up data.  The descriptor is not closed.*/
+  class AsyncOutputStream : public OutputStream {
+  public:
+
+    AsyncOutputStream(EpollReactor& reactor, int fd, size_t chunkSize = 64 * 1024);
+    ~AsyncOutputStream();
+
+    bool next(uint8_t** data, size_t* len) override;
+    void backup(size_t len) override;
+    uint64_t byteCount() const override;
+
+    /* Writes as much of the buffered data as the descriptor takes without blocking.*/
+    void flush() override;
+
+    /* The number of bytes flushed but not yet written to the descriptor.*/
+    size_t pendingBytes() const {
+      return flushed_ - head_;
+    }
+
+    /* Calls handler, from the reactor, each time all the flushed data has been written after some of it had to wait.*/
+    void onDrained(const std::function<void()>& handler) {
+      drained_ = handler;
+    }
+
+  private:
+
+    /* Writes flushed data until it is all written or the descriptor is full, returns whether it is all written.*/
+    bool writePending();
+    void onReady(uint32_t events);
+
+    EpollReactor& reactor_;
+    const int fd_;
+    const size_t chunkSize_;
+    std::vector<uint8_t> buffer_;
+    size_t head_; // start of the bytes not yet written to fd_
+    size_t flushed_; // end of the flushed bytes
+    size_t used_; // end of the bytes handed out by next()
+    uint64_t byteCount_;
+    std::function<void()> drained_;
+  };
+
+  /* Decodes the datums of a non-blocking file descriptor as their bytes arrive, handing each to a handler.  Every chunk that is read goes
+     through a ResumableDecoder, which decodes it straight into the datum and keeps the state of a datum cut off at the end of the chunk,
+     so the decoding suspends at chunk boundaries and picks up again from the reactor.  The datum passed to the handler is reused for the
+     next one.
+
+     start() begins reading.  At the end of the stream the end handler is called; if the stream ends within a datum an exception is thrown
+     from the reactor instead.*/
+  template <typename T>
+  class AsyncDatumReader {
+  public:
+
+    typedef std::function<void(T& datum)> DatumHandler;
+    typedef std::function<void()> EndHandler;
+
+    AsyncDatumReader(EpollReactor& reactor, int fd, const ValidSchema& schema, const DatumHandler& onDatum, const EndHandler& onEnd,
+      const T& datum = T(), size_t chunkSize = 64 * 1024) :
+    in_(reactor, fd, chunkSize), decoder_(schema), datum_(datum), onDatum_(onDatum), onEnd_(onEnd), count_(0) { }
+
+    void start() {
+      in_.next([this](const uint8_t* data, size_t len) {
+        onChunk(data, len);
+      });
+    }
+
+    /* The number of datums decoded so far.*/
+    size_t count() const {
+      return count_;
+    }
+
+  private:
+
+    /* Decodes the chunk and whatever else the descriptor has to offer right away, then waits for more.*/
+    void onChunk(const uint8_t* data, size_t len) {
+      do {
+        if (len == 0) {
+          if (decoder_.partialBytes() != 0) {
+            throw Exception(boost::format("Stream ended within a datum, after %1% of its bytes") % decoder_.partialBytes());
+          }
+          onEnd_();
+          return;
+        }
+        while (len > 0) {
+          size_t consumed;
+          if (decoder_.decode(data, len, consumed, datum_) == DecodeStatus::DATUM_READY) {
+            ++count_;
+            onDatum_(datum_);
+          }
+          data += consumed;
+          len -= consumed;
+        }
+      } while (in_.tryNext(&data, &len));
+      start();
+    }
+
+    AsyncInputStream in_;
+    ResumableDecoder decoder_;
+    T datum_;
+    DatumHandler onDatum_;
+    EndHandler onEnd_;
+    size_t count_;
+  };
+
+} // namespace avro
+
+#endif
@@ -0,0 +1,55 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef avro_BinaryCompare_hh__
+#define avro_BinaryCompare_hh__
+
+#include <cstdint>
+#include "CompiledSchema.hh"
+
+/* Comparison and hashing of binary encoded datums directly on their bytes, for sorting, merging, partitioning and deduplication.*/
+namespace avro {
+
+  /* Compares two binary encoded datums of the schema in the Avro sort order and returns a negative number, zero or a positive number as
+     the first sorts before, together with or after the second.
+
+     Records compare field by field, skipping fields whose order is "ignore" and reversing those whose order is "descending".  Ints, longs,
+     floats and doubles compare numerically, with NaN after everything else and -0.0 before 0.0; false comes before true; strings and bytes
+     compare as unsigned bytes; arrays compare item by item.  A string, bytes or array that is a prefix of the other comes first.  Maps
+     cannot be compared unless they are ignored.
+
+     Only the bytes up to the first difference are looked at.  Throws if a datum ends before its encoding does.*/
+  int compareBinary(const CompiledSchema& schema, const uint8_t* a, size_t alen, const uint8_t* b, size_t blen);
+
+  /* As above, compiling the schema on every call; keep a CompiledSchema to compare many datums.*/
+  int compareBinary(const ValidSchema& schema, const uint8_t* a, size_t alen, const uint8_t* b, size_t blen);
+
+  /* Returns a 64-bit hash of a binary encoded datum of the schema, mixing its values in the manner of wyhash without decoding them.
+
+     Fields whose order is "ignore" are skipped, so a schema compiled with key fields hashes only the key.  The hash is over the values,
+     not the bytes: it does not depend on how arrays and maps were split into blocks, map entries may come in any order, and all NaNs hash
+     alike.  Datums that compareBinary() finds equal therefore hash equal.  The hash is the same on every run and every machine for the same
+     seed.  Throws if the datum ends before its encoding does.*/
+  uint64_t hashBinary(const CompiledSchema& schema, const uint8_t* data, size_t len, uint64_t seed = 0);
+
+  /* As above, compiling the schema on every call.*/
+  uint64_t hashBinary(const ValidSchema& schema, const uint8_t* data, size_t len, uint64_t seed = 0);
+
+} // namespace avro
+
+#endif
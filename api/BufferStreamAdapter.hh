@@ -0,0 +1,155 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef avro_BufferStreamAdapter_hh__
+#define avro_BufferStreamAdapter_hh__
+
+#include "Stream.hh"
+#include "buffer/Buffer.hh"
+
+/* Adapters exposing the chunks of OutputBuffer and InputBuffer through the OutputStream and InputStream interfaces, without copying.*/
+namespace avro {
+
+  /* An output stream that hands out the free space of an OutputBuffer directly.
+
+     Bytes handed out by next() become part of the buffer on the following next(), on flush() or when the stream is destroyed, so flush the
+     stream before reading the buffer.  The buffer is held by a shallow copy and therefore stays valid for as long as the stream lives.*/
+  class BufferOutputStream : public OutputStream {
+    OutputBuffer buffer_;
+    const size_t chunkSize_;
+    size_t pending_; // bytes handed out but not yet committed to buffer_
+    uint64_t byteCount_;
+
+    void commit() {
+      if (pending_) {
+        buffer_.wroteTo(pending_);
+        pending_ = 0;
+      }
+    }
+
+  public:
+
+    BufferOutputStream(const OutputBuffer &buffer, size_t chunkSize = detail::kDefaultBlockSize) :
+    buffer_(buffer), chunkSize_(chunkSize), pending_(0), byteCount_(0) { }
+
+    ~BufferOutputStream() {
+      commit();
+    }
+
+    bool next(uint8_t** data, size_t* len) {
+      commit();
+      if (buffer_.freeSpace() == 0) {
+        buffer_.reserve(chunkSize_);
+      }
+      OutputBuffer::const_iterator it = buffer_.begin();
+      *data = reinterpret_cast<uint8_t*> (it->data());
+      *len = it->size();
+      pending_ = *len;
+      byteCount_ += *len;
+      return true;
+    }
+
+    void backup(size_t len) {
+      pending_ -= len;
+      byteCount_ -= len;
+    }
+
+    uint64_t byteCount() const {
+      return byteCount_;
+    }
+
+    void flush() {
+      commit();
+    }
+
+    /* Commits the bytes written so far and links the given memory into the buffer after them, see OutputBuffer::appendForeignData().*/
+    void appendForeignData(const uint8_t* data, size_t len, const detail::free_func &func) {
+      commit();
+      buffer_.appendForeignData(reinterpret_cast<const detail::data_type*> (data), len, func);
+      byteCount_ += len;
+    }
+
+    /* The buffer this stream writes into. Bytes not yet flushed are not part of it.*/
+    OutputBuffer &buffer() {
+      return buffer_;
+    }
+  };
+
+  /* An input stream that returns the chunks of an InputBuffer directly.  The buffer is shared, not copied.*/
+  class BufferInputStream : public InputStream {
+    const InputBuffer buffer_;
+    InputBuffer::const_iterator iter_;
+    size_t offset_; // bytes of *iter_ already consumed
+    size_t byteCount_;
+
+  public:
+
+    BufferInputStream(const InputBuffer &buffer) :
+    buffer_(buffer), iter_(buffer_.begin()), offset_(0), byteCount_(0) { }
+
+    bool next(const uint8_t** data, size_t* len) {
+      while (iter_ != buffer_.end() && offset_ == iter_->size()) {
+        ++iter_;
+        offset_ = 0;
+      }
+      if (iter_ == buffer_.end()) {
+        return false;
+      }
+      *data = reinterpret_cast<const uint8_t*> (iter_->data()) + offset_;
+      *len = iter_->size() - offset_;
+      offset_ = iter_->size();
+      byteCount_ += *len;
+      return true;
+    }
+
+    void backup(size_t len) {
+      offset_ -= len;
+      byteCount_ -= len;
+    }
+
+    void skip(size_t len) {
+      while (len > 0 && iter_ != buffer_.end()) {
+        size_t n = std::min(iter_->size() - offset_, len);
+        offset_ += n;
+        byteCount_ += n;
+        len -= n;
+        if (offset_ == iter_->size()) {
+          ++iter_;
+          offset_ = 0;
+        }
+      }
+    }
+
+    size_t byteCount() const {
+      return byteCount_;
+    }
+  };
+
+  /* Returns a new OutputStream that writes directly into the chunks of the given buffer.*/
+  inline std::shared_ptr<OutputStream> bufferOutputStream(OutputBuffer& buffer, size_t chunkSize = detail::kDefaultBlockSize) {
+    return std::shared_ptr<OutputStream>(new BufferOutputStream(buffer, chunkSize));
+  }
+
+  /* Returns a new InputStream that reads the chunks of the given buffer in place.*/
+  inline std::shared_ptr<InputStream> bufferInputStream(const InputBuffer& buffer) {
+    return std::shared_ptr<InputStream>(new BufferInputStream(buffer));
+  }
+
+} // namespace avro
+
+#endif
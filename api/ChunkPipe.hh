@@ -0,0 +1,91 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef avro_ChunkPipe_hh__
+#define avro_ChunkPipe_hh__
+
+#include <atomic>
+#include <vector>
+#include "Stream.hh"
+#include "buffer/detail/BufferDetail.hh"
+
+namespace avro {
+
+  /* A bounded, lock-free pipe of buffer chunks between exactly one producer thread and one consumer thread.
+
+     The producer writes through output(), typically with a binaryEncoder().  Each filled chunk, and the partial chunk on every flush(), is
+     published into a fixed ring of slots with a release store; the consumer picks slots up with an acquire load, either through input() or
+     with drainTo(), which hands whole runs of chunks to writev().  A side waits by yielding when the ring is full or empty, no mutex is
+     involved.  Blocks come from the producer's chunk pool and go back to it once the consumer is done with them, so the memory in flight is
+     bounded by capacity chunks of chunkSize bytes.
+
+     The producer calls close() after its last write, after which the consumer sees end of stream once the ring is empty.  Use either input()
+     or drainTo() on the consumer side, not both.
+
+     close() is required: the destructor does not publish anything, since the consumer may be gone and the ring full, so bytes written since
+     the last flush() of a pipe destroyed without close() are dropped.*/
+  class ChunkPipe {
+  public:
+
+    ChunkPipe(size_t capacity = 64, size_t chunkSize = detail::kDefaultBlockSize);
+    ~ChunkPipe();
+
+    ChunkPipe(const ChunkPipe&) = delete;
+    const ChunkPipe& operator=(const ChunkPipe&) = delete;
+
+    /* The producer end.  Data becomes visible to the consumer when a chunk fills up or the stream is flushed.*/
+    OutputStream& output();
+
+    /* The consumer end.  next() waits for the producer and returns false once the pipe is closed and empty.*/
+    InputStream& input();
+
+    /* Publishes any pending data and marks the end of the stream.  Called by the producer, before the pipe is destroyed.*/
+    void close();
+
+    /* Writes everything that passes through the pipe to the file descriptor until the pipe is closed and empty, gathering the available
+       chunks into a single writev() call each time.  Returns the number of bytes written.  Called by the consumer.*/
+    size_t drainTo(int fd);
+
+  private:
+
+    class Output;
+    class Input;
+
+    /* Producer side.*/
+    void publish(const detail::Chunk& chunk);
+
+    /* Consumer side, waits until at least one slot is readable and returns the number of readable slots, 0 at the end of the stream.*/
+    size_t waitReadable();
+    const detail::Chunk& front() const;
+    const detail::Chunk& slot(size_t i) const;
+    void pop(size_t n);
+
+    std::vector<detail::Chunk> slots_;
+    const size_t chunkSize_;
+
+    alignas(64) std::atomic<size_t> head_; // next slot the producer publishes to
+    alignas(64) std::atomic<size_t> tail_; // next slot the consumer reads from
+    std::atomic<bool> closed_;
+
+    Output* output_;
+    Input* input_;
+  };
+
+} // namespace avro
+
+#endif
@@ -0,0 +1,69 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef avro_CompiledSchema_hh__
+#define avro_CompiledSchema_hh__
+
+#include <string>
+#include <vector>
+#include "Node.hh"
+#include "Types.hh"
+#include "ValidSchema.hh"
+
+namespace avro {
+
+  /* A schema compiled into the flat sequence of primitive values that make up its binary encoding, in encoding order.  Records contribute
+     their fields in turn, so walking the encoded bytes of a datum needs neither the schema tree nor recursion.
+
+     An array or a map is an op of its own, followed by the ops of one item: the map key first and then the value.  Its end is the index
+     just past the item, where the item count of the next block is read.  A record that contains itself, even through an array or a map,
+     cannot be compiled.
+
+     Every op also carries the sort order of the field it belongs to, combined with the orders of the enclosing fields: a field inside an
+     ignored field is ignored, and a descending field inside a descending one is ascending.*/
+  class CompiledSchema {
+  public:
+
+    /* One primitive value of the encoding.*/
+    struct Op {
+      Type type;
+      size_t end; // for an array or a map, the index of the first op after its item
+      FieldOrder order; // the sort order of the value
+    };
+
+    explicit CompiledSchema(const ValidSchema& schema);
+
+    /* Compiles a record schema with only the named fields as the key: the other fields of the record are ignored, whatever their order in
+       the schema.  The key fields keep their own order and are still compared in schema order, not in the order they are named.  Throws if
+       the schema is not a record or has no field of one of the names.*/
+    CompiledSchema(const ValidSchema& schema, const std::vector<std::string>& keyFields);
+
+    const std::vector<Op>& ops() const {
+      return ops_;
+    }
+
+  private:
+
+    void compile(const NodePtr& node, size_t depth, FieldOrder order);
+
+    std::vector<Op> ops_;
+  };
+
+} // namespace avro
+
+#endif
@@ -23,6 +23,7 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include <memory_resource>
 
 #include "ValidSchema.hh"
 #include "Stream.hh"
@@ -72,6 +73,13 @@ namespace avro {
     /* Decodes a UTF-8 string from the stream and assigns it to value*/
     virtual void decodeString(std::string& value) = 0;
 
+    /* Decodes a UTF-8 string from the stream into value, which keeps its allocator.  The default decodes into a std::string and copies it.*/
+    virtual void decodeString(std::pmr::string& value) {
+      std::string s;
+      decodeString(s);
+      value.assign(s.data(), s.size());
+    }
+
     /* Skips a string on the current stream*/
     virtual void skipString() = 0;
 
@@ -85,8 +93,38 @@ namespace avro {
     /* Decodes arbitrary binary data from the current stream and puts it in value*/
     virtual void decodeBytes(std::vector<uint8_t>& value) = 0;
 
+    /* Decodes arbitrary binary data from the current stream into value, which keeps its allocator.  The default decodes into a std::vector 
+       and copies it.*/
+    virtual void decodeBytes(std::pmr::vector<uint8_t>& value) {
+      std::vector<uint8_t> b;
+      decodeBytes(b);
+      value.assign(b.begin(), b.end());
+    }
+
     /* Skips bytes on the current stream*/
-    virtual void skipBytes() = 0;   
+    virtual void skipBytes() = 0;
+
+    /* Start decoding an array. Returns the number of entries in first chunk*/
+    virtual size_t arrayStart() = 0;
+
+    /* Returns the number of entries in next chunk. 0 if last*/
+    virtual size_t arrayNext() = 0;
+
+    /* Tries to skip an array. If it can, it returns 0. Otherwise it returns the number of elements to be skipped. The client should skip the
+       individual items. In such cases, after skipping an element the client should call arrayNext() to find out if there are more items to
+       skip.  Blocks written with their size in bytes are skipped without decoding their items*/
+    virtual size_t skipArray() = 0;
+
+    /* Start decoding a map. Returns the number of entries in first chunk*/
+    virtual size_t mapStart() = 0;
+
+    /* Returns the number of entries in next chunk. 0 if last*/
+    virtual size_t mapNext() = 0;
+
+    /* Tries to skip a map. If it can, it returns 0. Otherwise it returns the number of elements to be skipped. The client should skip the
+       individual items. In such cases, after skipping an element the client should call mapNext() to find out if there are more items to
+       skip*/
+    virtual size_t skipMap() = 0;
   };
 
   /* Shared pointer to Decoder*/
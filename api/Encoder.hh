@@ -23,6 +23,7 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include <memory_resource>
 
 #include "ValidSchema.hh"
 #include "Stream.hh"
@@ -69,6 +70,11 @@ namespace avro {
     /* Encodes a UTF-8 string to the current stream*/
     virtual void encodeString(const std::string& s) = 0;
 
+    /* Encodes a UTF-8 string of len bytes at s to the current stream.  The default copies it into a std::string.*/
+    virtual void encodeString(const char* s, size_t len) {
+      encodeString(std::string(s, len));
+    }
+
     /* Encodes arbitrary binary data into the current stream as Avro "bytes" data type.
         @param bytes Where the data is
         @param len Number of bytes at bytes*/
@@ -81,6 +87,18 @@ namespace avro {
       encodeBytes(bytes.empty() ? &b : &bytes[0], bytes.size());
     }  
 
+    /* Indicates that an array of items is being encoded*/
+    virtual void arrayStart() = 0;
+
+    /* Indicates that the current array of items have been completely encoded*/
+    virtual void arrayEnd() = 0;
+
+    /* Indicates that a map of items is being encoded*/
+    virtual void mapStart() = 0;
+
+    /* Indicates that the current map of items have been completely encoded*/
+    virtual void mapEnd() = 0;
+
     /* Indicates that count number of items are to follow in the current array or map*/
     virtual void setItemCount(size_t count) = 0;
 
@@ -95,6 +113,18 @@ namespace avro {
   /* Returns an encoder that can encode binary Avro standard*/
   EncoderPtr binaryEncoder();
 
+  /* Returns a binary encoder that, when initialized with a stream returned by bufferOutputStream(), links string and bytes values of at least
+     foreignThreshold bytes into the OutputBuffer as foreign chunks instead of copying them.  Only the length is written inline.  The values
+     are borrowed: their memory must stay valid and unchanged for as long as the buffer, or any buffer sharing its data, is in use.  With any
+     other stream it behaves exactly like binaryEncoder().*/
+  EncoderPtr bufferEncoder(size_t foreignThreshold = 64 * 1024);
+
+  /* Returns a binary encoder that writes every block of an array or map with a negative item count followed by the size of the block in
+     bytes, which the Avro specification allows so that readers can skip the whole block without decoding its items.  Each block is
+     buffered in memory until the next setItemCount() or the end of the array or map, so nested arrays and maps are buffered once per
+     level.  The output can be read by any binary decoder.*/
+  EncoderPtr blockingBinaryEncoder();
+
   /* Returns an encoder that validates sequence of calls to an underlying Encoder against the given schema*/
   EncoderPtr validatingEncoder(const ValidSchema& schema,
     const EncoderPtr& base);
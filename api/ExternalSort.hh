@@ -0,0 +1,70 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef avro_ExternalSort_hh__
+#define avro_ExternalSort_hh__
+
+#include <string>
+#include "CompiledSchema.hh"
+#include "Stream.hh"
+
+/* Sorting of streams of binary encoded datums that do not fit in memory.*/
+namespace avro {
+
+  /* Sorts a stream of binary encoded datums of one schema, one after the other with nothing in between, in the order compareBinary()
+     defines.  The datums are never decoded: their bytes are split into datums by a DatumScanner and compared in place.
+
+     The input is cut into runs of about runSize bytes.  Each run is sorted in memory and spilled to a temporary file, on up to threads
+     runs at a time while the next run is read, so up to threads + 1 runs are held in memory.  The runs are then merged through a heap,
+     each run read ahead by a few chunks.  When there are more than maxFanIn runs, groups of them are first merged into longer runs, again on
+     up to threads groups at a time.  The reading ahead is shared by all the runs being merged, on a pool of threads threads, so merging
+     takes at most 2 * threads threads besides the calling one, whatever the number of runs and maxFanIn.  Input that fits in a single run
+     is sorted in memory, splitting the work between the threads, and never touches the disk.
+
+     The sort is stable: datums that compare equal come out in the order they came in.*/
+  class ExternalSorter {
+  public:
+
+    /* Threads of 0 uses one thread per core.  The temporary files go to tempDirectory, or to TMPDIR or /tmp if it is empty.*/
+    ExternalSorter(const CompiledSchema& schema, size_t runSize = 64 * 1024 * 1024, size_t threads = 0,
+      const std::string& tempDirectory = "");
+
+    /* Sorts all the datums of in into out and returns the number of datums.  Throws if in ends within a datum.*/
+    size_t sort(InputStream& in, OutputStream& out);
+
+    /* The most runs merged at once.*/
+    void setMaxFanIn(size_t maxFanIn);
+
+    /* The number of runs the last sort() spilled to disk, 0 if it was done in memory.*/
+    size_t spilledRuns() const {
+      return spilledRuns_;
+    }
+
+  private:
+
+    const CompiledSchema schema_;
+    const size_t runSize_;
+    const size_t threads_;
+    const std::string tempDirectory_;
+    size_t maxFanIn_;
+    size_t spilledRuns_;
+  };
+
+} // namespace avro
+
+#endif
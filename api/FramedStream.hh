@@ -0,0 +1,112 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef avro_FramedStream_hh__
+#define avro_FramedStream_hh__
+
+#include <vector>
+#include "Stream.hh"
+
+/* Length-prefixed framing of independent datums over a single underlying stream, such as a socket or a pipe.*/
+namespace avro {
+
+  enum class FrameLengthEncoding {
+    /* The length is written as an Avro long, zig-zag varint encoded.*/
+    VARINT,
+
+    /* The length is written as 4 bytes in network (big-endian) order, as in Avro RPC framing.*/
+    FIXED32
+  };
+
+  /* Writes every frame as its length followed by its bytes into an underlying stream.
+
+     The bytes of the frame being written are collected in a buffer that is reused for every frame. flush() ends the frame, so flushing an
+     encoder after each datum makes one frame per datum.  Ended frames are written into the underlying stream, which is only flushed once
+     batchSize bytes have accumulated, so many small frames go out in a single write.  sync() flushes the underlying stream regardless, call
+     it before the stream is destroyed.*/
+  class FramedOutputStream : public OutputStream {
+  public:
+
+    FramedOutputStream(OutputStream& out, FrameLengthEncoding encoding = FrameLengthEncoding::VARINT, size_t batchSize = 0);
+
+    bool next(uint8_t** data, size_t* len) override;
+    void backup(size_t len) override;
+    uint64_t byteCount() const override;
+
+    /* Ends the current frame if anything has been written into it, and flushes the underlying stream if the batch is full.*/
+    void flush() override;
+
+    /* Ends the current frame, even if it is empty.*/
+    void endFrame();
+
+    /* Ends the current frame if anything has been written into it and flushes the underlying stream.*/
+    void sync();
+
+  private:
+
+    StreamWriter out_;
+    const FrameLengthEncoding encoding_;
+    const size_t batchSize_;
+    std::vector<uint8_t> frame_;
+    size_t frameLen_; // bytes of frame_ holding data
+    size_t batched_; // bytes written into out_ since it was last flushed
+    uint64_t byteCount_;
+  };
+
+  /* Reads the frames written by a FramedOutputStream.  nextFrame() moves to the next frame, whose bytes are then read through the InputStream
+     interface, directly from the chunks of the underlying stream.*/
+  class FramedInputStream : public InputStream {
+  public:
+
+    FramedInputStream(InputStream& in, FrameLengthEncoding encoding = FrameLengthEncoding::VARINT);
+
+    /* Skips whatever is left of the current frame and reads the length of the next one.  Returns false if the underlying stream ends before
+       the next frame, throws if it ends within a frame length.*/
+    bool nextFrame();
+
+    /* Skips the rest of the current frame without reading it.*/
+    void skipFrame();
+
+    /* The size of the current frame.*/
+    size_t frameSize() const {
+      return frameSize_;
+    }
+
+    /* Returns the rest of the current frame, consuming it, if it is all in the current chunk of the underlying stream. Otherwise returns null
+       and leaves the frame to be read through next().*/
+    const uint8_t* contiguousFrame();
+
+    bool next(const uint8_t** data, size_t* len) override;
+    void backup(size_t len) override;
+    void skip(size_t len) override;
+    size_t byteCount() const override;
+
+  private:
+
+    bool readByte(uint8_t& b);
+
+    InputStream& in_;
+    const FrameLengthEncoding encoding_;
+    size_t frameSize_;
+    size_t remaining_; // bytes of the current frame not yet handed out
+    size_t byteCount_;
+  };
+
+} // namespace avro
+
+#endif
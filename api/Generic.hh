@@ -80,6 +80,9 @@ namespace avro {
     static void write(Encoder& e, const GenericDatum& g, const ValidSchema&) {
       write(e, g);
     }
+
+    /* Returns the number of bytes the binary encoding of a generic datum takes, without encoding it.*/
+    static size_t encodedSize(const GenericDatum& g);
   };
 
   template <typename T> struct codec_traits;
@@ -98,6 +101,11 @@ namespace avro {
     static void decode(Decoder& d, std::pair<ValidSchema, GenericDatum>& p) {
       GenericReader::read(d, p.second, p.first);
     }
+
+    /* Size of the binary encoding */
+    static size_t encodedSize(const std::pair<ValidSchema, GenericDatum>& p) {
+      return GenericWriter::encodedSize(p.second);
+    }
   };
 
   /* Specialization of codec_traits for GenericDatum*/
@@ -112,6 +120,11 @@ namespace avro {
     static void decode(Decoder& d, GenericDatum& g) {
       GenericReader::read(d, g);
     }
+
+    /* Size of the binary encoding */
+    static size_t encodedSize(const GenericDatum& g) {
+      return GenericWriter::encodedSize(g);
+    }
   };
 
 }
@@ -43,7 +43,9 @@ namespace avro {
    * \li Avro <tt>float</tt> maps to C++ <tt>float</tt>.
    * \li Avro <tt>double</tt> maps to C++ <tt>double</tt>.
    * \li Avro <tt>string</tt> maps to C++ <tt>std::string</tt>.
-   * \li Avro <tt>bytes</tt> maps to C++ <tt>std::vector&lt;uint_t&gt;</tt>.   
+   * \li Avro <tt>bytes</tt> maps to C++ <tt>std::vector&lt;uint_t&gt;</tt>.
+   * \li Avro <tt>array</tt> maps to C++ class <tt>GenericArray</tt>.
+   * \li Avro <tt>map</tt> maps to C++ class <tt>GenericMap</tt>.
    * object should have the C++ type corresponing to one of the constituent
    * types of the union.
    *
@@ -200,6 +202,50 @@ namespace avro {
     }
   };
 
+  /* The generic container for Avro arrays.*/
+  class GenericArray : public GenericContainer {
+  public:
+    /* The contents type for the array.*/
+    typedef std::vector<GenericDatum> Value;
+
+    /* Constructs a generic array corresponding to the given schema schema, which should be of Avro type array.*/
+    GenericArray(const NodePtr& schema) : GenericContainer(Type::AVRO_ARRAY, schema) { }
+
+    /* Returns the contents of this array.*/
+    const Value& value() const {
+      return value_;
+    }
+
+    /* Returns the reference to the contents of this array.*/
+    Value& value() {
+      return value_;
+    }
+  private:
+    Value value_;
+  };
+
+  /* The generic container for Avro maps.*/
+  class GenericMap : public GenericContainer {
+  public:
+    /* The contents type for the map, its entries in the order they were added or decoded.*/
+    typedef std::vector<std::pair<std::string, GenericDatum> > Value;
+
+    /* Constructs a generic map corresponding to the given schema schema, which should be of Avro type map.*/
+    GenericMap(const NodePtr& schema) : GenericContainer(Type::AVRO_MAP, schema) { }
+
+    /* Returns the contents of this map.*/
+    const Value& value() const {
+      return value_;
+    }
+
+    /* Returns the reference to the contents of this map.*/
+    Value& value() {
+      return value_;
+    }
+  private:
+    Value value_;
+  };
+
   inline Type GenericDatum::type() const {
     return type_;
   }
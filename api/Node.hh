@@ -33,6 +33,13 @@ namespace avro {
 
   typedef std::shared_ptr<Node> NodePtr;
 
+  /* How a record field takes part in the sort order of its record, the "order" attribute of the field.*/
+  enum class FieldOrder {
+    ASCENDING,
+    DESCENDING,
+    IGNORE
+  };
+
   class Name {
     std::string ns_;
     std::string simpleName_;
@@ -146,6 +153,10 @@ namespace avro {
       throw Exception(boost::format("No default value at: %1%") % index);
     }
 
+    virtual FieldOrder fieldOrderAt(int index) const {
+      return FieldOrder::ASCENDING;
+    }
+
     void addName(const std::string &name) {
       checkLock();
       checkName(name);
@@ -225,15 +225,17 @@ namespace avro {
 
   class NodeRecord : public NodeImplRecord {
     std::vector<GenericDatum> defaultValues;
+    std::vector<FieldOrder> fieldOrders; // fields past the end are ascending
   public:
 
     NodeRecord() : NodeImplRecord(Type::AVRO_RECORD) { }
 
     NodeRecord(const HasName &name, const MultiLeaves &fields,
       const LeafNames &fieldsNames,
-      const std::vector<GenericDatum>& dv) :
+      const std::vector<GenericDatum>& dv,
+      const std::vector<FieldOrder>& orders = std::vector<FieldOrder>()) :
     NodeImplRecord(Type::AVRO_RECORD, name, fields, fieldsNames, NoSize()),
-    defaultValues(dv) {
+    defaultValues(dv), fieldOrders(orders) {
       for (size_t i = 0; i < leafNameAttributes_.size(); ++i) {
         if (!nameIndex_.add(leafNameAttributes_.get(i), i)) {
           throw Exception(boost::format(
@@ -246,6 +248,7 @@ namespace avro {
     void swap(NodeRecord& r) {
       NodeImplRecord::swap(r);
       defaultValues.swap(r.defaultValues);
+      fieldOrders.swap(r.fieldOrders);
     }
 
     SchemaResolution resolve(const Node &reader) const;
@@ -260,8 +263,62 @@ namespace avro {
     const GenericDatum& defaultValueAt(int index) {
       return defaultValues[index];
     }
+
+    FieldOrder fieldOrderAt(int index) const {
+      return static_cast<size_t> (index) < fieldOrders.size() ? fieldOrders[index] : FieldOrder::ASCENDING;
+    }
+
+    void setFieldOrder(size_t index, FieldOrder order) {
+      if (index >= fieldOrders.size()) {
+        fieldOrders.resize(index + 1, FieldOrder::ASCENDING);
+      }
+      fieldOrders[index] = order;
+    }
+  };
+
+  class NodeArray : public NodeImplArray {
+  public:
+
+    NodeArray() : NodeImplArray(Type::AVRO_ARRAY) { }
+
+    explicit NodeArray(const SingleLeaf &items) :
+    NodeImplArray(Type::AVRO_ARRAY, NoName(), items, NoLeafNames(), NoSize()) { }
+
+    SchemaResolution resolve(const Node &reader) const;
+
+    void printJson(std::ostream &os, int depth) const;
+
+    bool isValid() const {
+      return (leafAttributes_.size() == 1);
+    }
+  };
+
+  /* A map has two leaves, the string type of its keys followed by the type of its values.*/
+  class NodeMap : public NodeImplMap {
+  public:
+
+    NodeMap() : NodeImplMap(Type::AVRO_MAP) {
+      NodePtr key(new NodePrimitive(Type::AVRO_STRING));
+      doAddLeaf(key);
+    }
+
+    explicit NodeMap(const SingleLeaf &values) :
+    NodeImplMap(Type::AVRO_MAP, NoName(), MultiLeaves(values), NoLeafNames(), NoSize()) {
+      // the key goes before the values
+      NodePtr key(new NodePrimitive(Type::AVRO_STRING));
+      doAddLeaf(key);
+      std::swap(leafAttributes_.get(0), leafAttributes_.get(1));
+    }
+
+    SchemaResolution resolve(const Node &reader) const;
+
+    void printJson(std::ostream &os, int depth) const;
+
+    bool isValid() const {
+      return (leafAttributes_.size() == 2);
+    }
   };
-   
+
 
   template < class A, class B, class C, class D >
   inline void NodeImpl<A, B, C, D>::setLeafToSymbolic(int index, const NodePtr &node) {
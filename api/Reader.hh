@@ -23,6 +23,7 @@
 #include <vector>
 #include "Zigzag.hh"
 #include "Types.hh"
+#include "Exception.hh"
 #include "Validator.hh"
 #include "buffer/BufferReader.hh"
 
@@ -104,6 +105,27 @@ namespace avro {
       reader_.read(reinterpret_cast<char *> (&val[0]), size);
     }
 
+    /* Skips the given number of bytes of fixed size values.  Skipping is not validated.*/
+    void skipBytes(size_t bytes) {
+      if (!reader_.skip(bytes)) {
+        throw Exception("Truncated data");
+      }
+    }
+
+    /* Skips count ints or longs.*/
+    void skipVarInts(size_t count) {
+      for (size_t i = 0; i < count; ++i) {
+        readVarInt();
+      }
+    }
+
+    /* Skips count strings or bytes.*/
+    void skipLengthPrefixed(size_t count) {
+      for (size_t i = 0; i < count; ++i) {
+        skipBytes(static_cast<size_t> (readSize()));
+      }
+    }
+
     void readRecord() {
       validator_.checkTypeExpected(Type::AVRO_RECORD);
       validator_.checkTypeExpected(Type::AVRO_LONG);
@@ -132,15 +154,9 @@ namespace avro {
 
     uint64_t readVarInt() {
       uint64_t encoded = 0;
-      uint8_t val = 0;
-      int shift = 0;
-      do {
-        reader_.read(val);
-        uint64_t newbits = static_cast<uint64_t> (val & 0x7f) << shift;
-        encoded |= newbits;
-        shift += 7;
-      } while (val & 0x80);
-
+      if (!reader_.readVarInt(encoded)) {
+        throw Exception("Invalid or truncated variable length integer");
+      }
       return encoded;
     }
 
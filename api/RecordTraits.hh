@@ -0,0 +1,106 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef avro_RecordTraits_hh__
+#define avro_RecordTraits_hh__
+
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+#include "Types.hh"
+
+/* Compile-time descriptions of the fields of generated records.
+
+   avrogencpp specializes record_traits for every record it generates, with a constexpr tuple of FieldDescriptors in schema order.
+   visit_fields() walks that tuple, so code that is written once for any record, such as projection, hashing, comparison or columnar
+   export, works on the generated structs directly and is inlined like hand-written code, without going through GenericDatum.*/
+namespace avro {
+
+  /* One field of record type R, held in a member of type M.*/
+  template <typename R, typename M>
+  struct FieldDescriptor {
+    typedef R record_type;
+    typedef M value_type;
+
+    /* The name of the field in the schema.*/
+    const char* name;
+
+    /* The position of the field in the schema, which is also the order it is encoded in.*/
+    size_t index;
+
+    M R::* member;
+
+    /* The Avro type of the field, symbolic references resolved.*/
+    Type type;
+
+    constexpr const M& get(const R& r) const {
+      return r.*member;
+    }
+
+    constexpr M& get(R& r) const {
+      return r.*member;
+    }
+  };
+
+  template <typename R, typename M>
+  constexpr FieldDescriptor<R, M> makeField(const char* name, size_t index, M R::* member, Type type) {
+    return FieldDescriptor<R, M>{name, index, member, type};
+  }
+
+  /* Specialized for every generated record R with:
+      static constexpr size_t fieldCount;
+      static constexpr auto fields; // a std::tuple of FieldDescriptor<R, ...>, in schema order*/
+  template <typename R>
+  struct record_traits;
+
+  /* Whether T has record_traits, that is whether it is a generated record.  Lets a visitor recurse into nested records.*/
+  template <typename T, typename = void>
+  struct is_record : std::false_type {
+  };
+
+  template <typename T>
+  struct is_record<T, decltype(static_cast<void> (record_traits<T>::fieldCount))> : std::true_type {
+  };
+
+  /* Calls f(descriptor) for every field of R, in schema order, without a record.*/
+  template <typename R, typename F>
+  void visit_field_descriptors(F&& f) {
+    std::apply([&f](const auto&... field) {
+      (f(field), ...);
+    }, record_traits<R>::fields);
+  }
+
+  /* Calls f(descriptor, value) for every field of the record, in schema order.  The values are const if the record is.*/
+  template <typename R, typename F>
+  void visit_fields(R& r, F&& f) {
+    std::apply([&r, &f](const auto&... field) {
+      (f(field, r.*(field.member)), ...);
+    }, record_traits<typename std::remove_const<R>::type>::fields);
+  }
+
+  /* Calls f(descriptor, a's value, b's value) for every field of the two records, in schema order.*/
+  template <typename R, typename F>
+  void visit_fields(const R& a, const R& b, F&& f) {
+    std::apply([&a, &b, &f](const auto&... field) {
+      (f(field, a.*(field.member), b.*(field.member)), ...);
+    }, record_traits<R>::fields);
+  }
+
+} // namespace avro
+
+#endif
@@ -21,11 +21,13 @@
 
 #include "Reader.hh"
 #include <cstdint>
+#include <vector>
 
 namespace avro {
 
   class ValidSchema;
   class Layout;
+  class ResolverProgram;
 
   class Resolver {
   public:
@@ -36,10 +38,88 @@ namespace avro {
 
     virtual void parse(Reader &reader, uint8_t *address) const = 0;
 
+    /* Appends the instructions that do the same as parse() to the program.*/
+    virtual void compile(ResolverProgram &program) const = 0;
+
     virtual ~Resolver() { }
 
   };
 
+  /* A tree of Resolvers flattened into a list of instructions, run by a single loop without virtual calls.
+
+     Nested records need no instructions of their own, as the offsets of a Layout are all relative to the outermost object.  Consecutive
+     values that are skipped are fused into a single instruction where their kind allows it.*/
+  class ResolverProgram {
+  public:
+
+    enum class Opcode : uint8_t {
+      READ_STRING,
+      READ_BYTES,
+      READ_INT,
+      READ_LONG,
+      READ_FLOAT,
+      READ_DOUBLE,
+      READ_BOOL,
+
+      INT_TO_LONG,
+      INT_TO_FLOAT,
+      INT_TO_DOUBLE,
+      LONG_TO_FLOAT,
+      LONG_TO_DOUBLE,
+      FLOAT_TO_DOUBLE,
+
+      /* Skips offset bytes of fixed size values, floats, doubles and booleans.*/
+      SKIP_BYTES,
+
+      /* Skips offset ints or longs.*/
+      SKIP_VARINTS,
+
+      /* Skips offset strings or bytes.*/
+      SKIP_LENGTH_PREFIXED
+    };
+
+    struct Op {
+      Opcode opcode;
+      size_t offset; // where the value goes in the object, or how many bytes or values a skip covers
+    };
+
+    explicit ResolverProgram(const Resolver &resolver) {
+      resolver.compile(*this);
+    }
+
+    /* Appends an instruction that reads or promotes a value into the object.*/
+    void add(Opcode opcode, size_t offset) {
+      Op op = {opcode, offset};
+      ops_.push_back(op);
+    }
+
+    /* Appends a skip instruction, extending the previous one if it skips the same kind of values.*/
+    void addSkip(Opcode opcode, size_t n) {
+      if (!ops_.empty() && ops_.back().opcode == opcode) {
+        ops_.back().offset += n;
+      } else {
+        add(opcode, n);
+      }
+    }
+
+    const std::vector<Op> &ops() const {
+      return ops_;
+    }
+
+    void parse(Reader &reader, uint8_t *address) const {
+      parseBatch(reader, address, 0, 1);
+    }
+
+    /* Parses n consecutive objects, the first at address and each following one stride bytes after the previous one.*/
+    void parseBatch(Reader &reader, uint8_t *address, size_t stride, size_t n) const;
+
+  private:
+
+    static void parseOps(Reader &reader, uint8_t *address, const Op *begin, const Op *end);
+
+    std::vector<Op> ops_;
+  };
+
   Resolver *constructResolver(
     const ValidSchema &rwriterSchema,
     const ValidSchema &readerSchema,
@@ -30,7 +30,10 @@ namespace avro {
   class ValidSchema;
   class Layout;
   class Resolver;
+  class ResolverProgram;
 
+  /* Resolves data written with one schema into objects laid out for another.  The resolution is worked out once, into a flat
+     ResolverProgram, which parse() then runs for every object.*/
   class ResolverSchema {
   public:
 
@@ -42,8 +45,13 @@ namespace avro {
 
     void parse(Reader &reader, uint8_t *address);
 
+    void parseBatch(Reader &reader, uint8_t *address, size_t stride, size_t n);
+
     std::shared_ptr<Resolver> resolver_;
 
+    // compiled from resolver_
+    std::shared_ptr<const ResolverProgram> program_;
+
   };
 
 }
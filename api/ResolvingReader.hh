@@ -40,6 +40,12 @@ namespace avro {
       schema_.parse(reader_, reinterpret_cast<uint8_t *> (&object));
     }
 
+    /* Parses the next n objects into consecutive elements of an array, in one pass of the resolution instructions per element.*/
+    template<typename T>
+    void parseBatch(T *out, size_t n) {
+      schema_.parseBatch(reader_, reinterpret_cast<uint8_t *> (out), sizeof (T), n);
+    }
+
   private:
 
     Reader reader_;
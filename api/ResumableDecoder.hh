@@ -0,0 +1,458 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef avro_ResumableDecoder_hh__
+#define avro_ResumableDecoder_hh__
+
+#include <map>
+#include <memory>
+#include <optional>
+#include <typeinfo>
+#include <vector>
+#include "CompiledSchema.hh"
+#include "RecordTraits.hh"
+#include "Specific.hh"
+
+/* Decoding of binary datums that arrive in pieces, as from a non-blocking socket.*/
+namespace avro {
+
+  /* Finds where the binary encoding of a datum ends, in data that may arrive in any number of pieces.  All the progress is kept in this
+     object, so scanning stops at the end of each piece and picks up again with the next one.*/
+  class DatumScanner {
+  public:
+
+    explicit DatumScanner(const ValidSchema& schema);
+
+    explicit DatumScanner(const CompiledSchema& program);
+
+    /* Scans the given bytes, up to the end of the datum.  Returns the number of bytes that belong to the datum.*/
+    size_t scan(const uint8_t* data, size_t len);
+
+    /* Whether the end of the datum has been reached.*/
+    bool complete() const {
+      return op_ == program_.ops().size() && blocks_.empty();
+    }
+
+    /* Starts looking for the next datum.*/
+    void reset() {
+      op_ = 0;
+      state_ = State::START;
+      blocks_.clear();
+    }
+
+  private:
+
+    enum class State {
+      START, VARINT, LENGTH, FIXED, COUNT, BLOCK_SIZE, SKIP_BLOCK
+    };
+
+    /* A block of an array or map whose items are being scanned.*/
+    struct Block {
+      size_t op; // the array or map op
+      uint64_t count; // items left, including the one being scanned
+    };
+
+    const CompiledSchema program_;
+    size_t op_; // the value being scanned
+    std::vector<Block> blocks_; // innermost last
+    State state_;
+    uint64_t varint_; // the part of a varint seen so far
+    int shift_;
+    uint64_t remaining_; // bytes left of a fixed size value, of a string or bytes payload or of a sized block
+  };
+
+  enum class DecodeStatus {
+    /* All the input has been taken, the datum continues in the data still to come.*/
+    NEED_MORE_DATA,
+
+    /* A complete datum has been decoded.*/
+    DATUM_READY
+  };
+
+  class GenericDatum;
+
+  namespace detail {
+
+    /* Where the values of one op of a CompiledSchema are decoded to.  A slot finds its value from the base of the innermost array or map
+       item being decoded, or from the datum itself outside of any: a generated record is laid out at fixed offsets from its base, a
+       GenericDatum is reached through the field indexes on the way to it.  Only the methods for the type of the op are called; those of
+       null values, and of map keys, which the map slot takes care of, do nothing.*/
+    class DecodeSlot {
+    public:
+
+      virtual ~DecodeSlot() { }
+
+      /* Stores a decoded bool, int32_t, int64_t, float or double, as the type of the op says.*/
+      virtual void set(void*, const void*) { }
+
+      /* Sizes a string or bytes value to len bytes and returns where they go.  Called again with a larger len while the bytes arrive, the
+         bytes already there being kept.*/
+      virtual uint8_t* resize(void*, size_t) {
+        return 0;
+      }
+
+      /* An array or map starts.*/
+      virtual void start(void*) { }
+
+      /* A block of count items follows the first used ones.*/
+      virtual void reserve(void*, size_t, size_t) { }
+
+      /* The key of the map entry at index starts.*/
+      virtual void startKey(void*, size_t) { }
+
+      /* Sizes the key being decoded to len bytes and returns where they go, like resize().*/
+      virtual uint8_t* key(void*, size_t, size_t) {
+        return 0;
+      }
+
+      /* Returns the base of the array item, or the map value, at index, adding it if there are only index items so far.*/
+      virtual void* item(void*, size_t) {
+        return 0;
+      }
+
+      /* The array or map ended after used items.*/
+      virtual void end(void*, size_t) { }
+    };
+
+    typedef std::vector<std::unique_ptr<DecodeSlot> > DecodeSlots;
+
+    /* Throws unless the next op to get a slot is of the given type.*/
+    void checkSlot(const DecodeSlots& slots, const CompiledSchema& program, Type type);
+
+    /* Throws unless the ops up to end, and no more, have got their slots.*/
+    void checkSlots(const DecodeSlots& slots, const CompiledSchema& program, size_t end);
+
+    template <typename T>
+    T& slotValue(void* base, size_t offset) {
+      return *reinterpret_cast<T*> (static_cast<char*> (base) + offset);
+    }
+
+    template <typename T>
+    class ValueSlot : public DecodeSlot {
+    public:
+
+      explicit ValueSlot(size_t offset) : offset_(offset) { }
+
+      void set(void* base, const void* value) {
+        slotValue<T>(base, offset_) = *static_cast<const T*> (value);
+      }
+
+    private:
+      const size_t offset_;
+    };
+
+    /* For strings and bytes, in std:: or std::pmr:: containers.*/
+    template <typename S>
+    class StringSlot : public DecodeSlot {
+    public:
+
+      explicit StringSlot(size_t offset) : offset_(offset) { }
+
+      uint8_t* resize(void* base, size_t len) {
+        S& s = slotValue<S>(base, offset_);
+        s.resize(len);
+        return reinterpret_cast<uint8_t*> (s.data());
+      }
+
+    private:
+      const size_t offset_;
+    };
+
+    /* The items left from an earlier decode are decoded into, as codec_traits does.*/
+    template <typename V>
+    class ArraySlot : public DecodeSlot {
+    public:
+
+      explicit ArraySlot(size_t offset) : offset_(offset) { }
+
+      void reserve(void* base, size_t used, size_t count) {
+        reserveItems(slotValue<V>(base, offset_), used, count);
+      }
+
+      void* item(void* base, size_t index) {
+        V& v = slotValue<V>(base, offset_);
+        if (index == v.size()) {
+          v.emplace_back();
+        }
+        return &v[index];
+      }
+
+      void end(void* base, size_t used) {
+        V& v = slotValue<V>(base, offset_);
+        v.erase(v.begin() + used, v.end());
+      }
+
+    private:
+      const size_t offset_;
+    };
+
+    /* The nodes already in the map are taken out and decoded into, as codec_traits does, so they keep their memory.*/
+    template <typename M>
+    class MapSlot : public DecodeSlot {
+    public:
+
+      explicit MapSlot(size_t offset) : offset_(offset) { }
+
+      void start(void* base) {
+        M& m = slotValue<M>(base, offset_);
+        old_.emplace(m.get_allocator());
+        old_->swap(m);
+      }
+
+      void startKey(void* base, size_t) {
+        if (old_->empty()) {
+          M& m = slotValue<M>(base, offset_);
+          key_.emplace(detail::makeWithAllocator<typename M::key_type>(m.get_allocator()));
+          k_ = &*key_;
+        } else {
+          node_ = old_->extract(old_->begin());
+          k_ = &node_.key();
+        }
+      }
+
+      uint8_t* key(void*, size_t, size_t len) {
+        k_->resize(len);
+        return reinterpret_cast<uint8_t*> (k_->data());
+      }
+
+      void* item(void* base, size_t) {
+        M& m = slotValue<M>(base, offset_);
+        if (!node_) {
+          return &m[std::move(*key_)];
+        }
+        // maps are usually written in key order, which makes the end the right place
+        typename M::iterator it = m.insert(m.end(), std::move(node_));
+        node_ = typename M::node_type();
+        return &it->second;
+      }
+
+      void end(void*, size_t) {
+        old_.reset();
+      }
+
+    private:
+      const size_t offset_;
+      std::optional<M> old_; // the entries not yet decoded into
+      typename M::node_type node_; // the entry whose key is being decoded, if it is an old one
+      std::optional<typename M::key_type> key_; // otherwise the key being decoded, on the memory of the map
+      typename M::key_type* k_; // the one of the two
+    };
+
+    /* Adds the slots of the ops of a T at offset from the base, checking that they agree with the schema.  Specialized for the types
+       generated code uses; generated records go through their record_traits.*/
+    template <typename T, typename = void>
+    struct slot_traits;
+
+    template <typename T, Type type>
+    struct value_slot_traits {
+
+      static void add(DecodeSlots& slots, const CompiledSchema& program, size_t offset) {
+        checkSlot(slots, program, type);
+        slots.emplace_back(new ValueSlot<T>(offset));
+      }
+    };
+
+    template <>
+    struct slot_traits<avro::null> {
+
+      static void add(DecodeSlots& slots, const CompiledSchema& program, size_t) {
+        checkSlot(slots, program, Type::AVRO_NULL);
+        slots.emplace_back(new DecodeSlot());
+      }
+    };
+
+    template <>
+    struct slot_traits<bool> : value_slot_traits<bool, Type::AVRO_BOOL> {
+    };
+
+    template <>
+    struct slot_traits<int32_t> : value_slot_traits<int32_t, Type::AVRO_INT> {
+    };
+
+    template <>
+    struct slot_traits<int64_t> : value_slot_traits<int64_t, Type::AVRO_LONG> {
+    };
+
+    template <>
+    struct slot_traits<float> : value_slot_traits<float, Type::AVRO_FLOAT> {
+    };
+
+    template <>
+    struct slot_traits<double> : value_slot_traits<double, Type::AVRO_DOUBLE> {
+    };
+
+    template <typename C, typename A>
+    struct slot_traits<std::basic_string<char, C, A> > {
+
+      static void add(DecodeSlots& slots, const CompiledSchema& program, size_t offset) {
+        checkSlot(slots, program, Type::AVRO_STRING);
+        slots.emplace_back(new StringSlot<std::basic_string<char, C, A> >(offset));
+      }
+    };
+
+    template <typename A>
+    struct slot_traits<std::vector<uint8_t, A> > {
+
+      static void add(DecodeSlots& slots, const CompiledSchema& program, size_t offset) {
+        checkSlot(slots, program, Type::AVRO_BYTES);
+        slots.emplace_back(new StringSlot<std::vector<uint8_t, A> >(offset));
+      }
+    };
+
+    template <typename T, typename A>
+    struct slot_traits<std::vector<T, A> > {
+
+      static void add(DecodeSlots& slots, const CompiledSchema& program, size_t offset) {
+        static_assert(!std::is_same<T, bool>::value, "std::vector<bool> has no items to decode into");
+        size_t op = slots.size();
+        checkSlot(slots, program, Type::AVRO_ARRAY);
+        slots.emplace_back(new ArraySlot<std::vector<T, A> >(offset));
+        slot_traits<T>::add(slots, program, 0);
+        checkSlots(slots, program, program.ops()[op].end);
+      }
+    };
+
+    template <typename K, typename T, typename C, typename A>
+    struct slot_traits<std::map<K, T, C, A> > {
+
+      static void add(DecodeSlots& slots, const CompiledSchema& program, size_t offset) {
+        size_t op = slots.size();
+        checkSlot(slots, program, Type::AVRO_MAP);
+        slots.emplace_back(new MapSlot<std::map<K, T, C, A> >(offset));
+        checkSlot(slots, program, Type::AVRO_STRING);
+        slots.emplace_back(new DecodeSlot());
+        slot_traits<T>::add(slots, program, 0);
+        checkSlots(slots, program, program.ops()[op].end);
+      }
+    };
+
+    /* A record's fields follow one another, at their offsets within a default constructed record.*/
+    template <typename R>
+    struct slot_traits<R, typename std::enable_if<is_record<R>::value>::type> {
+
+      static void add(DecodeSlots& slots, const CompiledSchema& program, size_t offset) {
+        R sample;
+        visit_field_descriptors<R>([&](const auto& field) {
+          typedef typename std::decay<decltype(field)>::type::value_type M;
+          size_t fieldOffset = reinterpret_cast<char*> (&field.get(sample)) - reinterpret_cast<char*> (&sample);
+          slot_traits<M>::add(slots, program, offset + fieldOffset);
+        });
+      }
+    };
+
+  }
+
+  /* Decodes a sequence of binary datums from input that is handed over in pieces, for example whatever a socket had to offer.  The values
+     are decoded as their bytes arrive, straight into the datum: all the progress within a datum, down to a varint cut in two, is kept in
+     this object, and a string or bytes value is copied from each piece to its place in the datum.  So nothing is held back between pieces
+     but a few bytes of a float or double, and a large datum costs no more memory than the datum itself.
+
+     Works with generated types, with their records, arrays, maps and primitives in std:: or std::pmr:: containers, and with GenericDatum
+     constructed with its schema.  Arrays, maps, strings and bytes of the datum are decoded into in place, as codec_traits does, so a datum
+     that is decoded into again reuses their memory.  Schemas with unions, enums or fixed values cannot be decoded.*/
+  class ResumableDecoder {
+  public:
+
+    explicit ResumableDecoder(const ValidSchema& schema);
+
+    /* Takes bytes from data until the end of the current datum.  Sets consumed to the number of bytes taken; the bytes after them belong
+       to the next datum.  Returns DATUM_READY once the datum has been decoded into value, or NEED_MORE_DATA if all the input was taken and
+       the datum is still incomplete, in which case the same value must be passed on with the rest of it.  Throws if the type of value
+       does not agree with the schema.*/
+    template <typename T>
+    DecodeStatus decode(const uint8_t* data, size_t len, size_t& consumed, T& value) {
+      if (slotsType_ != &typeid (T)) {
+        startSlots();
+        detail::slot_traits<T>::add(slots_, program_, 0);
+        detail::checkSlots(slots_, program_, program_.ops().size());
+        slotsType_ = &typeid (T);
+      }
+      return resume(data, len, consumed, &value);
+    }
+
+    /* The value must have been constructed with the schema of this decoder.*/
+    DecodeStatus decode(const uint8_t* data, size_t len, size_t& consumed, GenericDatum& value);
+
+    /* The number of bytes of the current datum taken so far, 0 between datums.*/
+    size_t partialBytes() const {
+      return partialBytes_;
+    }
+
+    /* Drops the datum being decoded, if any, so that the next bytes are taken as the start of a datum.*/
+    void reset();
+
+  private:
+
+    enum class State {
+      START, VARINT, FIXED, LENGTH, PAYLOAD, COUNT, BLOCK_SIZE
+    };
+
+    /* An array or map being decoded.*/
+    struct Frame {
+      size_t op; // the array or map op
+      void* base; // the base the array or map is found from
+      void* item; // the base of the item being decoded
+      size_t used; // the items done
+      uint64_t count; // the items left in the block, including the one being decoded
+    };
+
+    /* Whether a datum has been started and is not complete yet.*/
+    bool inDatum() const {
+      return partialBytes_ != 0 || op_ != 0 || state_ != State::START;
+    }
+
+    void startSlots();
+    DecodeStatus resume(const uint8_t* data, size_t len, size_t& consumed, void* root);
+
+    /* Decodes from data[i] on, returns whether the datum is complete.*/
+    bool run(const uint8_t* data, size_t len, size_t& i);
+    void startItems(uint64_t count);
+
+    /* Whether the value being decoded is the key of a map entry.*/
+    bool isKey() const;
+
+    /* Makes room for size bytes of the string or bytes value, or map key, being decoded.*/
+    void sizePayload(size_t size);
+
+    void* base() const {
+      return frames_.empty() ? root_ : frames_.back().item;
+    }
+
+    const ValidSchema schema_;
+    const CompiledSchema program_;
+    detail::DecodeSlots slots_; // one per op
+    const std::type_info* slotsType_; // the type slots_ are for
+    void* root_; // the datum being decoded
+    size_t partialBytes_;
+    size_t op_; // the value being decoded
+    std::vector<Frame> frames_; // innermost last
+    State state_;
+    uint64_t varint_; // the part of a varint seen so far
+    int shift_;
+    uint64_t remaining_; // bytes left of a bool, float or double, or of a string or bytes payload
+    uint64_t blockCount_; // the items of a block whose size is being read
+    uint64_t length_; // the length of a string or bytes payload
+    size_t sized_; // how many bytes of it the value has room for
+    uint8_t* payload_; // where they go
+    uint8_t fixed_[8]; // the bytes of a bool, float or double seen so far
+    size_t filled_; // how many of them
+  };
+
+} // namespace avro
+
+#endif
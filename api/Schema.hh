@@ -106,6 +106,17 @@ namespace avro {
   public:
     RecordSchema(const std::string &name);
     void addField(const std::string &name, const Schema &fieldSchema);
+    void addField(const std::string &name, const Schema &fieldSchema, FieldOrder order);
+  };
+
+  class ArraySchema : public Schema {
+  public:
+    ArraySchema(const Schema &itemsSchema);
+  };
+
+  class MapSchema : public Schema {
+  public:
+    MapSchema(const Schema &valuesSchema);
   };
 
   class SymbolicSchema : public Schema {
@@ -0,0 +1,110 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef avro_ShmRing_hh__
+#define avro_ShmRing_hh__
+
+#include <string>
+#include "Stream.hh"
+
+/* A ring buffer in POSIX shared memory carrying length-prefixed records from one producer process to one consumer process.
+
+   Records are written and read in place in the shared mapping, so a record crosses from the encoder of one process to the decoder of the
+   other without going through the kernel.  The producer and consumer positions are lock-free counters in the shared header; a side that
+   has to wait for the other sleeps on a futex, which is only woken when somebody actually sleeps on it.
+
+   Each record is stored contiguously as a 4-byte length followed by its bytes, so a record is at most half the ring capacity.*/
+namespace avro {
+
+  struct ShmRingHeader;
+
+  /* The producer end of a shared memory ring.  It creates the shared memory object, which must not exist yet, and removes its name again
+     when destroyed; a consumer that already opened the ring keeps reading it.
+
+     Each flush() publishes the bytes written since the previous flush() as one record, so flush a binaryEncoder() after every datum.  A
+     flush() with nothing written publishes nothing.*/
+  class ShmOutputStream : public OutputStream {
+  public:
+
+    ShmOutputStream(const char* name, size_t capacity = 1024 * 1024);
+    ~ShmOutputStream();
+
+    ShmOutputStream(const ShmOutputStream&) = delete;
+    const ShmOutputStream& operator=(const ShmOutputStream&) = delete;
+
+    bool next(uint8_t** data, size_t* len) override;
+    void backup(size_t len) override;
+    uint64_t byteCount() const override;
+    void flush() override;
+
+    /* Publishes any pending record and tells the consumer that no more records will follow.*/
+    void close();
+
+  private:
+
+    void startRecord(uint64_t pos);
+    void relocateRecord();
+    void waitForSpace();
+
+    const std::string name_;
+    ShmRingHeader* header_;
+    uint8_t* data_;
+    uint64_t capacity_;
+    uint64_t recordStart_; // position of the length of the record being written
+    uint64_t lapEnd_; // the record being written must end before this position
+    uint64_t next_; // position of the next byte of the record
+    uint64_t byteCount_;
+    bool closed_;
+  };
+
+  /* The consumer end of a shared memory ring, which must have been created by a ShmOutputStream.  nextRecord() moves to the next record,
+     whose bytes are then read through the InputStream interface, as a single chunk.  Decode the whole record before moving on, the space
+     it occupies is handed back to the producer by the following nextRecord().*/
+  class ShmInputStream : public InputStream {
+  public:
+
+    ShmInputStream(const char* name);
+    ~ShmInputStream();
+
+    ShmInputStream(const ShmInputStream&) = delete;
+    const ShmInputStream& operator=(const ShmInputStream&) = delete;
+
+    /* Waits for the next record.  Returns false when the producer has closed the ring and all the records have been read.*/
+    bool nextRecord();
+
+    bool next(const uint8_t** data, size_t* len) override;
+    void backup(size_t len) override;
+    void skip(size_t len) override;
+    size_t byteCount() const override;
+
+  private:
+
+    ShmRingHeader* header_;
+    uint8_t* data_;
+    uint64_t capacity_;
+    uint64_t tail_; // position of the current record
+    uint64_t recordEnd_; // position of the record after the current one
+    const uint8_t* record_;
+    size_t recordSize_;
+    size_t offset_; // bytes of the current record handed out
+    size_t byteCount_;
+  };
+
+} // namespace avro
+
+#endif
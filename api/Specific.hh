@@ -23,6 +23,8 @@
 #include <vector>
 #include <map>
 #include <algorithm>
+#include <memory_resource>
+#include <type_traits>
 
 #include "boost/array.hpp"
 #include "boost/blank.hpp"
@@ -30,14 +32,19 @@
 #include "AvroTraits.hh"
 #include "Encoder.hh"
 #include "Decoder.hh"
+#include "Zigzag.hh"
 
 /* A bunch of templates and specializations for encoding and decoding specific types.
  
    Primitive AVRO types BOOLEAN, INT, LONG, FLOAT, DOUBLE, STRING and BYTES get decoded to and encoded from C++ types bool, int32_t, 
-   int64_t, float, double, std::string and std::vector<uint8_t> respectively. In addition, std::vector<T> for arbitrary type T gets encoded 
+   int64_t, float, double, std::string and std::vector<uint8_t> respectively.  STRING and BYTES also map to std::pmr::string and 
+   std::pmr::vector<uint8_t>, which are decoded using the allocator they already hold. In addition, std::vector<T> for arbitrary type T gets encoded 
    as an Avro array of T. Similarly, std::map<std::string, T> for arbitrary type T gets encoded as an Avro map with value type T.
   
-   Users can have their custom types encoded/decoded by specializing avro::codec_traits class for their types.*/
+   Users can have their custom types encoded/decoded by specializing avro::codec_traits class for their types.
+
+   The specializations also tell the exact number of bytes the binary encoding of a value takes, so that a buffer of the right size can be
+   reserved, or a length prefix written, before encoding.*/
 namespace avro {
 
   typedef boost::blank null;
@@ -48,9 +55,14 @@ namespace avro {
   template <typename T>
   void decode(Decoder& d, T& t);
 
+  template <typename T>
+  size_t encodedSize(const T& t);
+
   /* Codec_traits tells avro how to encode and decode an object of given type. The class is expected to have two static methods:
       static void encode(Encoder& e, const T& value);
       static void decode(Decoder& e, T& value);
+     and, for encodedSize() to work on the type, a third one:
+      static size_t encodedSize(const T& value);
      The default is empty.*/
   template <typename T>
   struct codec_traits;
@@ -68,6 +80,11 @@ namespace avro {
     static void decode(Decoder& d, bool& b) {
       b = d.decodeBool();
     }
+
+    /* The size of the binary encoding of a given value.*/
+    static size_t encodedSize(bool) {
+      return 1;
+    }
   };
 
   /* codec_traits for Avro int.*/
@@ -83,6 +100,11 @@ namespace avro {
     static void decode(Decoder& d, int32_t& i) {
       i = d.decodeInt();
     }
+
+    /* The size of the binary encoding of a given value.*/
+    static size_t encodedSize(int32_t i) {
+      return encodedInt32Size(i);
+    }
   };
 
   /* codec_traits for Avro long.*/
@@ -98,6 +120,11 @@ namespace avro {
     static void decode(Decoder& d, int64_t& l) {
       l = d.decodeLong();
     }
+
+    /* The size of the binary encoding of a given value.*/
+    static size_t encodedSize(int64_t l) {
+      return encodedInt64Size(l);
+    }
   };
 
   /* codec_traits for Avro float.*/
@@ -113,6 +140,11 @@ namespace avro {
     static void decode(Decoder& d, float& f) {
       f = d.decodeFloat();
     }
+
+    /* The size of the binary encoding of a given value.*/
+    static size_t encodedSize(float) {
+      return 4;
+    }
   };
 
   /* codec_traits for Avro double.*/
@@ -128,6 +160,11 @@ namespace avro {
     static void decode(Decoder& d, double& dbl) {
       dbl = d.decodeDouble();
     }
+
+    /* The size of the binary encoding of a given value.*/
+    static size_t encodedSize(double) {
+      return 8;
+    }
   };
 
   /* codec_traits for Avro string.*/
@@ -143,6 +180,11 @@ namespace avro {
     static void decode(Decoder& d, std::string& s) {
       s = d.decodeString();
     }
+
+    /* The size of the binary encoding of a given value.*/
+    static size_t encodedSize(const std::string& s) {
+      return encodedInt64Size(s.size()) + s.size();
+    }
   };
 
   /* codec_traits for Avro bytes.*/
@@ -158,8 +200,54 @@ namespace avro {
     static void decode(Decoder& d, std::vector<uint8_t>& s) {
       d.decodeBytes(s);
     }
+
+    /* The size of the binary encoding of a given value.*/
+    static size_t encodedSize(const std::vector<uint8_t>& b) {
+      return encodedInt64Size(b.size()) + b.size();
+    }
+  };
+
+
+  /* codec_traits for Avro string held with a polymorphic allocator.*/
+  template <>
+  struct codec_traits<std::pmr::string> {
+
+    /* Encodes a given value.*/
+    static void encode(Encoder& e, const std::pmr::string& s) {
+      e.encodeString(s.data(), s.size());
+    }
+
+    /* Decodes into a given value, allocating from its memory resource.*/
+    static void decode(Decoder& d, std::pmr::string& s) {
+      d.decodeString(s);
+    }
+
+    /* The size of the binary encoding of a given value.*/
+    static size_t encodedSize(const std::pmr::string& s) {
+      return encodedInt64Size(s.size()) + s.size();
+    }
   };
 
+  /* codec_traits for Avro bytes held with a polymorphic allocator.*/
+  template <>
+  struct codec_traits<std::pmr::vector<uint8_t> > {
+
+    /* Encodes a given value.*/
+    static void encode(Encoder& e, const std::pmr::vector<uint8_t>& b) {
+      uint8_t empty = 0;
+      e.encodeBytes(b.empty() ? &empty : &b[0], b.size());
+    }
+
+    /* Decodes into a given value, allocating from its memory resource.*/
+    static void decode(Decoder& d, std::pmr::vector<uint8_t>& b) {
+      d.decodeBytes(b);
+    }
+
+    /* The size of the binary encoding of a given value.*/
+    static size_t encodedSize(const std::pmr::vector<uint8_t>& b) {
+      return encodedInt64Size(b.size()) + b.size();
+    }
+  };
 
   /* codec_traits for Avro null.*/
   template <>
@@ -174,6 +262,176 @@ namespace avro {
     static void decode(Decoder& d, avro::null&) {
       d.decodeNull();
     }
+
+    /* The size of the binary encoding of a given value.*/
+    static size_t encodedSize(const avro::null&) {
+      return 0;
+    }
+  };
+
+  namespace detail {
+
+    /* The most memory reserved for the items of an array ahead of decoding them.  An item count is only a claim of the input, which may be
+       corrupt, so beyond this the items are made room for as they arrive.*/
+    const size_t kMaxPresizeBytes = 1 << 20;
+
+    /* Makes room for n more items after the first used ones of v.  The capacity at least doubles when it grows, so arrays sent in many
+       small blocks are not reallocated for each of them.*/
+    template <typename V>
+    void reserveItems(V& v, size_t used, size_t n) {
+      size_t limit = std::max<size_t>(kMaxPresizeBytes / sizeof (typename V::value_type), 1);
+      size_t wanted = used + std::min(n, limit);
+      if (wanted > v.capacity()) {
+        v.reserve(std::max(wanted, 2 * v.capacity()));
+      }
+    }
+
+    /* Makes an empty T on the memory of the given container allocator when T is allocator-aware, as the container would construct it, so
+       that moving it into the container later does not copy it.*/
+    template <typename T, typename A>
+    T makeWithAllocator(const A& alloc) {
+      if constexpr (std::uses_allocator<T, A>::value && std::is_constructible<T, const A&>::value) {
+        return T(alloc);
+      } else {
+        return T();
+      }
+    }
+
+  }
+
+  /* codec_traits for Avro array.*/
+  template <typename T, typename A>
+  struct codec_traits<std::vector<T, A> > {
+
+    /* Encodes a given value.*/
+    static void encode(Encoder& e, const std::vector<T, A>& b) {
+      e.arrayStart();
+      if (!b.empty()) {
+        e.setItemCount(b.size());
+        for (typename std::vector<T, A>::const_iterator it = b.begin(); it != b.end(); ++it) {
+          e.startItem();
+          avro::encode(e, *it);
+        }
+      }
+      e.arrayEnd();
+    }
+
+    /* Decodes into a given value.  The items already in the vector are decoded into, so that they keep their memory, and it only grows
+       for the items beyond them.  New items are constructed in place, so they share the allocator of the vector.*/
+    static void decode(Decoder& d, std::vector<T, A>& s) {
+      size_t used = 0;
+      for (size_t n = d.arrayStart(); n != 0; n = d.arrayNext()) {
+        detail::reserveItems(s, used, n);
+        for (size_t i = 0; i < n; ++i, ++used) {
+          if (used == s.size()) {
+            s.emplace_back();
+          }
+          avro::decode(d, s[used]);
+        }
+      }
+      s.erase(s.begin() + used, s.end());
+    }
+
+    /* The size of the binary encoding of a given value, written as a single block.*/
+    static size_t encodedSize(const std::vector<T, A>& b) {
+      if (b.empty()) {
+        return 1;
+      }
+      size_t size = encodedInt64Size(b.size()) + 1;
+      for (typename std::vector<T, A>::const_iterator it = b.begin(); it != b.end(); ++it) {
+        size += avro::encodedSize(*it);
+      }
+      return size;
+    }
+  };
+
+  /* codec_traits for Avro array of booleans, whose items are not addressable.*/
+  template <typename A>
+  struct codec_traits<std::vector<bool, A> > {
+
+    /* Encodes a given value.*/
+    static void encode(Encoder& e, const std::vector<bool, A>& b) {
+      e.arrayStart();
+      if (!b.empty()) {
+        e.setItemCount(b.size());
+        for (typename std::vector<bool, A>::const_iterator it = b.begin(); it != b.end(); ++it) {
+          e.startItem();
+          e.encodeBool(*it);
+        }
+      }
+      e.arrayEnd();
+    }
+
+    /* Decodes into a given value.*/
+    static void decode(Decoder& d, std::vector<bool, A>& s) {
+      s.clear();
+      for (size_t n = d.arrayStart(); n != 0; n = d.arrayNext()) {
+        for (size_t i = 0; i < n; ++i) {
+          s.push_back(d.decodeBool());
+        }
+      }
+    }
+
+    /* The size of the binary encoding of a given value, written as a single block.*/
+    static size_t encodedSize(const std::vector<bool, A>& b) {
+      return b.empty() ? 1 : encodedInt64Size(b.size()) + b.size() + 1;
+    }
+  };
+
+  /* codec_traits for Avro map.  The keys are encoded with the codec_traits of K, which must be a string.*/
+  template <typename K, typename T, typename C, typename A>
+  struct codec_traits<std::map<K, T, C, A> > {
+
+    /* Encodes a given value.*/
+    static void encode(Encoder& e, const std::map<K, T, C, A>& b) {
+      e.mapStart();
+      if (!b.empty()) {
+        e.setItemCount(b.size());
+        for (typename std::map<K, T, C, A>::const_iterator it = b.begin(); it != b.end(); ++it) {
+          e.startItem();
+          avro::encode(e, it->first);
+          avro::encode(e, it->second);
+        }
+      }
+      e.mapEnd();
+    }
+
+    /* Decodes into a given value.  The nodes already in the map are taken out and decoded into, so that they keep their memory, and new
+       ones are only allocated for the entries beyond them.*/
+    static void decode(Decoder& d, std::map<K, T, C, A>& s) {
+      std::map<K, T, C, A> old(s.get_allocator());
+      old.swap(s);
+      for (size_t n = d.mapStart(); n != 0; n = d.mapNext()) {
+        for (size_t i = 0; i < n; ++i) {
+          if (old.empty()) {
+            K k = detail::makeWithAllocator<K>(s.get_allocator());
+            avro::decode(d, k);
+            avro::decode(d, s[std::move(k)]);
+          } else {
+            typename std::map<K, T, C, A>::node_type node = old.extract(old.begin());
+            avro::decode(d, node.key());
+            avro::decode(d, node.mapped());
+            // maps are usually written in key order, which makes the end the right place
+            typename std::map<K, T, C, A>::iterator it = s.insert(s.end(), std::move(node));
+            if (node) {
+              it->second = std::move(node.mapped());
+            }
+          }
+        }
+      }
+    }
+
+    /* The size of the binary encoding of a given value, written as a single block.*/
+    static size_t encodedSize(const std::map<K, T, C, A>& b) {
+      if (b.empty()) {
+        return 1;
+      }
+      size_t size = encodedInt64Size(b.size()) + 1;
+      for (typename std::map<K, T, C, A>::const_iterator it = b.begin(); it != b.end(); ++it) {
+        size += avro::encodedSize(it->first) + avro::encodedSize(it->second);
+      }
+      return size;
+    }
   };
 
   /* Generic encoder function that makes use of the codec_traits.*/
@@ -188,6 +446,12 @@ namespace avro {
     codec_traits<T>::decode(d, t);
   }
 
+  /* Returns the number of bytes the binary encoding of the given value takes, without encoding it.*/
+  template <typename T>
+  size_t encodedSize(const T& t) {
+    return codec_traits<T>::encodedSize(t);
+  }
+
 }
 
 #endif // avro_Codec_hh__
@@ -20,8 +20,10 @@
 #define avro_Stream_hh__
 
 #include <memory>
+#include <algorithm>
 #include <cstring>
 #include <cstdint>
+#include <vector>
 #include "Exception.hh"
 
 namespace avro {
@@ -87,6 +89,9 @@ namespace avro {
   /* Returns a new OutputStream, which grows in memory chunks of specified size.*/
   std::shared_ptr<OutputStream> memoryOutputStream(size_t chunkSize = 4 * 1024);
 
+  /* Returns a new OutputStream, which grows in memory chunks starting at chunkSize and doubling with every new chunk up to maxChunkSize.*/
+  std::shared_ptr<OutputStream> memoryOutputStream(size_t chunkSize, size_t maxChunkSize);
+
   /* Returns a new InputStream, with the data from the given byte array. It does not copy the data, the byte array should remain valid until 
      the InputStream is used.*/
   std::shared_ptr<InputStream> memoryInputStream(const uint8_t* data, size_t len);
@@ -100,6 +105,113 @@ namespace avro {
      by a pervious call to memoryOutputStream().*/
   std::shared_ptr<std::vector<uint8_t> > snapshot(const OutputStream& source);
 
+  /* Makes sure that the next size bytes written into the memory output stream land in a single chunk, allocating it now if needed. Use it
+     with the expected size of a message to keep the message in one allocation.*/
+  void reserve(OutputStream& source, size_t size);
+
+  /* Takes the contents written so far out of the memory output stream as a single array and stores their size in len.  The chunk is handed
+     over without copying when all the data is in one chunk.  The stream is left empty and may be written to again.*/
+  std::unique_ptr<uint8_t[]> releaseContiguous(OutputStream& source, size_t* len);
+
+  /* An output stream that grows in memory, the class behind memoryOutputStream().  It can live on the stack and be reset() for every
+     message: the chunks it allocated are kept and written again, so a long-lived stream stops allocating once it has grown to the size of
+     the largest message.*/
+  class MemoryOutputStream : public OutputStream {
+  public:
+
+    /* Constructs an empty stream whose chunks start at chunkSize bytes and double up to maxChunkSize. Chunks have a fixed size if 
+       maxChunkSize is not larger than chunkSize.*/
+    explicit MemoryOutputStream(size_t chunkSize = 4 * 1024, size_t maxChunkSize = 0);
+    ~MemoryOutputStream();
+
+    MemoryOutputStream(const MemoryOutputStream&) = delete;
+    const MemoryOutputStream& operator=(const MemoryOutputStream&) = delete;
+
+    bool next(uint8_t** data, size_t* len) override;
+    void backup(size_t len) override;
+    uint64_t byteCount() const override;
+    void flush() override;
+
+    /* Discards the contents but keeps the chunks for the data written next.  Input streams and snapshots taken earlier become invalid.  An 
+       encoder writing into this stream must be flushed before the reset, because it may still hold space handed out by next().*/
+    void reset();
+
+    /* See avro::reserve().*/
+    void reserve(size_t size);
+
+    /* See avro::releaseContiguous().  The released chunk is no longer kept for reuse.*/
+    std::unique_ptr<uint8_t[]> releaseContiguous(size_t* len);
+
+  private:
+
+    friend class MemoryChunkInputStream;
+    friend std::shared_ptr<InputStream> memoryInputStream(const OutputStream& source);
+    friend std::shared_ptr<std::vector<uint8_t> > snapshot(const OutputStream& source);
+
+    struct Chunk {
+      uint8_t* data;
+      size_t capacity;
+      size_t used; // final once the next chunk is started
+    };
+
+    void nextChunk(size_t minSize);
+    size_t lastChunkLen() const;
+    void copyTo(uint8_t* dest) const;
+
+    const size_t m_chunk_size;
+    const size_t m_max_chunk_size;
+    size_t m_next_chunk_size;
+    std::vector<Chunk> m_data; // all the chunks owned, including the ones kept for reuse
+    size_t m_count; // the number of chunks holding the contents
+    size_t m_available;
+    size_t m_byte_count;
+  };
+
+  /* An input stream over a byte array, the class behind memoryInputStream(const uint8_t*, size_t).  It can live on the stack and be 
+     reset() to a new array for every message.  The data is not copied.*/
+  class MemoryInputStream : public InputStream {
+  public:
+
+    MemoryInputStream(const uint8_t* data = 0, size_t len = 0) : m_data(data), m_size(len), m_cur_len(0) { }
+
+    /* Starts reading the given array from the beginning.*/
+    void reset(const uint8_t* data, size_t len) {
+      m_data = data;
+      m_size = len;
+      m_cur_len = 0;
+    }
+
+    bool next(const uint8_t** data, size_t* len) override {
+      if (m_cur_len == m_size) {
+        return false;
+      }
+      *data = &m_data[m_cur_len];
+      *len = m_size - m_cur_len;
+      m_cur_len = m_size;
+      return true;
+    }
+
+    void backup(size_t len) override {
+      m_cur_len -= std::min(len, m_cur_len);
+    }
+
+    void skip(size_t len) override {
+      if (len > (m_size - m_cur_len)) {
+        len = m_size - m_cur_len;
+      }
+      m_cur_len += len;
+    }
+
+    size_t byteCount() const override {
+      return m_cur_len;
+    }
+
+  private:
+    const uint8_t* m_data;
+    size_t m_size;
+    size_t m_cur_len;
+  };
+
   /* Returns a new OutputStream whose contents would be stored in a file. Data is written in chunks of given buffer size. If there is a file 
      with the given name, it is truncated and overwritten. If there is no file with the given name, it is created.*/
   std::shared_ptr<OutputStream> fileOutputStream(const char* filename, size_t bufferSize = 8 * 1024);
@@ -36,6 +36,8 @@ namespace avro {
     AVRO_NULL, /* Null */
 
     AVRO_RECORD, /* Record, a sequence of fields */
+    AVRO_ARRAY, /* Homogeneous array of some specific type */
+    AVRO_MAP, /* Homogeneous map from string to some specific type */
 
     AVRO_NUM_TYPES, /* Marker */
 
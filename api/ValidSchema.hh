@@ -19,6 +19,9 @@
 #ifndef avro_ValidSchema_hh__ 
 #define avro_ValidSchema_hh__ 
 
+#include <cstdint>
+#include <string>
+
 #include "Node.hh"
 
 namespace avro {
@@ -45,6 +48,13 @@ namespace avro {
     void toJson(std::ostream &os) const;
     void toFlatList(std::ostream &os) const;
 
+    /* Returns the schema in Avro's Parsing Canonical Form: compact JSON holding only the attributes that matter for reading data, with
+       full names.  Schemas that read data the same way have the same canonical form.*/
+    std::string toCanonicalJson() const;
+
+    /* Returns the 64-bit Rabin (CRC-64-AVRO) fingerprint of the canonical form, as used in Avro single-object encoding.*/
+    uint64_t fingerprint() const;
+
   protected:
     NodePtr root_;
   };
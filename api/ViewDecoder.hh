@@ -0,0 +1,333 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef avro_ViewDecoder_hh__
+#define avro_ViewDecoder_hh__
+
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <string_view>
+#include <vector>
+
+#include "Exception.hh"
+#include "Zigzag.hh"
+#include "Specific.hh"
+
+/* Decoding of Avro binary data held in contiguous memory into views that point into that memory.
+
+   Strings and bytes are not copied: they decode to a std::string_view or a BytesView over the input.  Views are therefore only valid for
+   as long as the decoded memory is, and must not outlive it.  This suits consumers that look at a record and drop it before the buffer is
+   released or reused, avrogencpp --views generates view structs for records.*/
+namespace avro {
+
+  /* A read-only view of a sequence of bytes, that does not own them.*/
+  class BytesView {
+    const uint8_t* data_;
+    size_t size_;
+  public:
+
+    BytesView() : data_(0), size_(0) {
+    }
+
+    BytesView(const uint8_t* data, size_t size) : data_(data), size_(size) {
+    }
+
+    const uint8_t* data() const {
+      return data_;
+    }
+
+    size_t size() const {
+      return size_;
+    }
+
+    bool empty() const {
+      return size_ == 0;
+    }
+
+    const uint8_t* begin() const {
+      return data_;
+    }
+
+    const uint8_t* end() const {
+      return data_ + size_;
+    }
+
+    uint8_t operator[](size_t i) const {
+      return data_[i];
+    }
+  };
+
+  /* Decodes Avro binary data from contiguous memory, which must stay valid while anything decoded from it is in use.  Unlike a Decoder it
+     is not polymorphic, so the calls can be inlined into the generated code.*/
+  class ViewDecoder {
+    const uint8_t* next_;
+    const uint8_t* end_;
+
+    void need(size_t n) const {
+      if (static_cast<size_t> (end_ - next_) < n) {
+        throw Exception("Truncated Avro data");
+      }
+    }
+
+    size_t decodeLength() {
+      int64_t len = decodeLong();
+      if (len < 0) {
+        throw Exception(boost::format("Invalid length: %1%") % len);
+      }
+      need(len);
+      return static_cast<size_t> (len);
+    }
+
+  public:
+
+    ViewDecoder(const uint8_t* data, size_t len) : next_(data), end_(data + len) {
+    }
+
+    /* The position of the next byte to decode.*/
+    const uint8_t* position() const {
+      return next_;
+    }
+
+    /* The number of bytes not yet decoded.*/
+    size_t remaining() const {
+      return end_ - next_;
+    }
+
+    void decodeNull() {
+    }
+
+    bool decodeBool() {
+      need(1);
+      uint8_t v = *next_++;
+      if (v > 1) {
+        throw Exception("Invalid value for bool");
+      }
+      return v == 1;
+    }
+
+    int32_t decodeInt() {
+      int64_t val = decodeLong();
+      if (val < INT32_MIN || val > INT32_MAX) {
+        throw Exception(boost::format("Value out of range for Avro int: %1%") % val);
+      }
+      return static_cast<int32_t> (val);
+    }
+
+    int64_t decodeLong() {
+      uint64_t encoded = 0;
+      for (int shift = 0; shift < 64; shift += 7) {
+        need(1);
+        uint8_t u = *next_++;
+        encoded |= static_cast<uint64_t> (u & 0x7f) << shift;
+        if (!(u & 0x80)) {
+          return decodeZigzag64(encoded);
+        }
+      }
+      throw Exception("Invalid Avro varint");
+    }
+
+    float decodeFloat() {
+      float result;
+      need(sizeof (result));
+      std::memcpy(&result, next_, sizeof (result));
+      next_ += sizeof (result);
+      return result;
+    }
+
+    double decodeDouble() {
+      double result;
+      need(sizeof (result));
+      std::memcpy(&result, next_, sizeof (result));
+      next_ += sizeof (result);
+      return result;
+    }
+
+    std::string_view decodeString() {
+      size_t len = decodeLength();
+      std::string_view result(reinterpret_cast<const char*> (next_), len);
+      next_ += len;
+      return result;
+    }
+
+    BytesView decodeBytes() {
+      size_t len = decodeLength();
+      BytesView result(next_, len);
+      next_ += len;
+      return result;
+    }
+
+    /* Skips the given number of bytes.*/
+    void skip(size_t n) {
+      need(n);
+      next_ += n;
+    }
+
+    /* Decodes the item count of the next block of an array or map, 0 at the end.  The byte size of a block written with one is not needed
+       and is skipped.*/
+    size_t decodeItemCount() {
+      int64_t count = decodeLong();
+      if (count < 0) {
+        decodeLong();
+        return static_cast<size_t> (-count);
+      }
+      return static_cast<size_t> (count);
+    }
+  };
+
+  /* view_traits tells avro how to decode a view of a given type, it is expected to have a static method:
+      static void decode(ViewDecoder& d, T& value);*/
+  template <typename T>
+  struct view_traits;
+
+  template <>
+  struct view_traits<bool> {
+
+    static void decode(ViewDecoder& d, bool& b) {
+      b = d.decodeBool();
+    }
+  };
+
+  template <>
+  struct view_traits<int32_t> {
+
+    static void decode(ViewDecoder& d, int32_t& i) {
+      i = d.decodeInt();
+    }
+  };
+
+  template <>
+  struct view_traits<int64_t> {
+
+    static void decode(ViewDecoder& d, int64_t& l) {
+      l = d.decodeLong();
+    }
+  };
+
+  template <>
+  struct view_traits<float> {
+
+    static void decode(ViewDecoder& d, float& f) {
+      f = d.decodeFloat();
+    }
+  };
+
+  template <>
+  struct view_traits<double> {
+
+    static void decode(ViewDecoder& d, double& dbl) {
+      dbl = d.decodeDouble();
+    }
+  };
+
+  template <>
+  struct view_traits<std::string_view> {
+
+    static void decode(ViewDecoder& d, std::string_view& s) {
+      s = d.decodeString();
+    }
+  };
+
+  template <>
+  struct view_traits<BytesView> {
+
+    static void decode(ViewDecoder& d, BytesView& b) {
+      b = d.decodeBytes();
+    }
+  };
+
+  template <>
+  struct view_traits<avro::null> {
+
+    static void decode(ViewDecoder& d, avro::null&) {
+      d.decodeNull();
+    }
+  };
+
+  template <typename T>
+  struct view_traits<std::vector<T> > {
+
+    static void decode(ViewDecoder& d, std::vector<T>& v) {
+      size_t used = 0;
+      for (size_t n = d.decodeItemCount(); n != 0; n = d.decodeItemCount()) {
+        detail::reserveItems(v, used, n);
+        for (size_t i = 0; i < n; ++i, ++used) {
+          if (used == v.size()) {
+            v.emplace_back();
+          }
+          view_traits<T>::decode(d, v[used]);
+        }
+      }
+      v.erase(v.begin() + used, v.end());
+    }
+  };
+
+  template <typename T>
+  struct view_traits<std::map<std::string_view, T> > {
+
+    static void decode(ViewDecoder& d, std::map<std::string_view, T>& m) {
+      std::map<std::string_view, T> old;
+      old.swap(m);
+      for (size_t n = d.decodeItemCount(); n != 0; n = d.decodeItemCount()) {
+        for (size_t i = 0; i < n; ++i) {
+          if (old.empty()) {
+            std::string_view k = d.decodeString();
+            view_traits<T>::decode(d, m[k]);
+          } else {
+            typename std::map<std::string_view, T>::node_type node = old.extract(old.begin());
+            node.key() = d.decodeString();
+            view_traits<T>::decode(d, node.mapped());
+            typename std::map<std::string_view, T>::iterator it = m.insert(m.end(), std::move(node));
+            if (node) {
+              it->second = std::move(node.mapped());
+            }
+          }
+        }
+      }
+    }
+  };
+
+  template <>
+  struct view_traits<std::vector<bool> > {
+
+    static void decode(ViewDecoder& d, std::vector<bool>& v) {
+      v.clear();
+      for (size_t n = d.decodeItemCount(); n != 0; n = d.decodeItemCount()) {
+        for (size_t i = 0; i < n; ++i) {
+          v.push_back(d.decodeBool());
+        }
+      }
+    }
+  };
+
+  /* Decodes a view, making use of the view_traits.*/
+  template <typename T>
+  void decodeView(ViewDecoder& d, T& t) {
+    view_traits<T>::decode(d, t);
+  }
+
+  /* Decodes a view of the datum at the start of the given memory.*/
+  template <typename T>
+  void decodeView(const uint8_t* data, size_t len, T& t) {
+    ViewDecoder d(data, len);
+    view_traits<T>::decode(d, t);
+  }
+
+}
+
+#endif
@@ -34,6 +34,21 @@ namespace avro {
   size_t encodeInt32(int32_t input, boost::array<uint8_t, 5> &output);
   size_t encodeInt64(int64_t input, boost::array<uint8_t, 10> &output);
 
+  /* The number of bytes the variable length encoding of the given unsigned value takes, 7 bits per byte.*/
+  inline size_t varIntSize(uint64_t value) {
+    return (64 - __builtin_clzll(value | 1) + 6) / 7;
+  }
+
+  /* The number of bytes encodeInt32() produces for the given value.*/
+  inline size_t encodedInt32Size(int32_t input) {
+    return varIntSize((static_cast<uint32_t> (input) << 1) ^ static_cast<uint32_t> (input >> 31));
+  }
+
+  /* The number of bytes encodeInt64() produces for the given value.*/
+  inline size_t encodedInt64Size(int64_t input) {
+    return varIntSize((static_cast<uint64_t> (input) << 1) ^ (input >> 63));
+  }
+
 }
 
 #endif
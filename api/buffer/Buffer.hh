@@ -70,6 +70,11 @@ namespace avro {
      * Default constructor.  Will pre-allocate at least the requested size, but
      * can grow larger on demand.
      *
+     * New chunks are taken from the supplied allocator.  Without one, they
+     * come from a pool owned by the allocating thread, which recycles the
+     * blocks of chunks that are no longer referenced by any buffer.  Pass
+     * a detail::HeapChunkAllocator to bypass the pool.
+     *
      * Destructor uses the default, which resets a shared pointer, deleting the
      * underlying data if no other copies of exist.
      *
@@ -83,8 +88,8 @@ namespace avro {
      *
      **/
 
-    OutputBuffer(size_type reserveSize = 0) :
-    pimpl_(new detail::BufferImpl) {
+    OutputBuffer(size_type reserveSize = 0, const detail::ChunkAllocatorPtr &allocator = detail::ChunkAllocatorPtr()) :
+    pimpl_(new detail::BufferImpl(allocator)) {
       if (reserveSize) {
         reserve(reserveSize);
       }
@@ -90,6 +90,11 @@ namespace avro {
       if (size > bytesRemaining_) {
         size = bytesRemaining_;
       }
+      if (size && size <= chunkRemaining()) {
+        memcpy(data, addr(), size);
+        incrementChunk(size);
+        return size;
+      }
       size_type sizeToRead = size;
 
       while (sizeToRead) {
@@ -125,6 +130,32 @@ namespace avro {
       return read(val, boost::is_fundamental<T>());
     }
 
+    /* Read a variable-length (base 128) unsigned integer, as written by the Avro binary encoding.  Returns false, with the reader past the 
+       bytes examined, if the buffer ends in the middle of the value or the value is longer than 10 bytes.*/
+    bool readVarInt(uint64_t &val) {
+      if (bytesRemaining_ == 0) {
+        return false;
+      }
+      const size_type n = std::min<size_type>(chunkRemaining(), kMaxVarIntSize);
+      const uint8_t *p = reinterpret_cast<const uint8_t *> (addr());
+      uint64_t encoded = 0;
+      for (size_type i = 0; i < n; ++i) {
+        encoded |= static_cast<uint64_t> (p[i] & 0x7f) << (7 * i);
+        if (!(p[i] & 0x80)) {
+          val = encoded;
+          incrementChunk(i + 1);
+          return true;
+        }
+      }
+      return slowReadVarInt(val);
+    }
+
+    /* Returns the address of the next size bytes if they are all within the current chunk, otherwise null.  The reader does not move, use 
+       skip() to consume the bytes.*/
+    const data_type *peekContiguous(size_type size) const {
+      return (size <= bytesRemaining_ && bytesRemaining_ && size <= chunkRemaining()) ? addr() : 0;
+    }
+
     /*Skips a block of data from the buffer.*/
     bool skip(size_type bytes) {
       bool skipped = false;
@@ -183,6 +214,25 @@ namespace avro {
 
   private:
 
+    static constexpr size_type kMaxVarIntSize = 10;
+
+    /* Reads a varint that crosses a chunk boundary, one byte at a time.*/
+    bool slowReadVarInt(uint64_t &val) {
+      uint64_t encoded = 0;
+      uint8_t byte = 0;
+      for (size_type i = 0; i < kMaxVarIntSize; ++i) {
+        if (!read(byte)) {
+          return false;
+        }
+        encoded |= static_cast<uint64_t> (byte & 0x7f) << (7 * i);
+        if (!(byte & 0x80)) {
+          val = encoded;
+          return true;
+        }
+      }
+      return false;
+    }
+
     void doSkip(size_type sizeToSkip) {
 
       while (sizeToSkip) {
@@ -20,6 +20,7 @@
 #define avro_BufferDetail_hh__
 
 #include <memory>
+#include <atomic>
 #include <boost/shared_array.hpp>
 #include <boost/function.hpp>
 #include <boost/utility.hpp>
@@ -55,6 +56,190 @@ namespace avro::detail {
     free_func func_;
   };
 
+  /* Interface for the source of the blocks backing buffer chunks. A block is handed out as a shared array whose deleter gives the memory
+     back to wherever it came from, so chunks sharing the block never need to know which allocator produced it.*/
+  class ChunkAllocator {
+  public:
+
+    virtual ~ChunkAllocator() { }
+
+    /* Returns a block of at least size bytes.*/
+    virtual boost::shared_array<data_type> allocate(size_type size) = 0;
+  };
+
+  typedef std::shared_ptr<ChunkAllocator> ChunkAllocatorPtr;
+
+  /* A per-thread pool of recycled blocks.
+  
+     Blocks are grouped in power-of-two size classes from kMinBlockSize to kMaxBlockSize.  For each class the owning thread keeps a bounded
+     free list that no other thread touches.  A block released on another thread is pushed onto a lock-free stack instead, and the owner
+     takes that whole stack over with a single exchange once its own list runs dry, so neither side ever waits on a lock.  Blocks hold a
+     reference to their pool, which therefore outlives its thread for as long as any of its blocks are still in use.*/
+  class ChunkPool : public std::enable_shared_from_this<ChunkPool> {
+
+    /* A free block is reused to link the free lists.*/
+    struct FreeBlock {
+      FreeBlock *next;
+    };
+
+    /* Deleter attached to pooled blocks, returns the block to the pool it was taken from.*/
+    struct Recycle {
+      std::shared_ptr<ChunkPool> pool_;
+      size_t sizeClass_;
+
+      Recycle(const std::shared_ptr<ChunkPool> &pool, size_t sizeClass) : pool_(pool), sizeClass_(sizeClass) { }
+
+      void operator()(data_type *block) const {
+        pool_->release(block, sizeClass_);
+      }
+    };
+
+    static const size_t kNumSizeClasses = 3;
+    static const size_t kMaxFreeBlocks = 64;
+
+    FreeBlock *freeList_[kNumSizeClasses];
+    size_t freeCount_[kNumSizeClasses];
+    std::atomic<FreeBlock *> returned_[kNumSizeClasses];
+
+    ChunkPool() {
+      for (size_t i = 0; i < kNumSizeClasses; ++i) {
+        freeList_[i] = 0;
+        freeCount_[i] = 0;
+        returned_[i] = 0;
+      }
+    }
+
+    /* The pool owned by the calling thread, null until the thread first allocates.*/
+    static ChunkPool *&owned() {
+      static thread_local ChunkPool *pool = 0;
+      return pool;
+    }
+
+    /* Keeps the pool of a thread alive until the thread exits.*/
+    struct Owner {
+      std::shared_ptr<ChunkPool> pool_;
+
+      Owner() : pool_(new ChunkPool) {
+        owned() = pool_.get();
+      }
+
+      ~Owner() {
+        owned() = 0;
+      }
+    };
+
+    static size_t sizeClass(size_type size) {
+      size_t sizeClass = 0;
+      for (size_type classSize = kMinBlockSize; classSize < size; classSize <<= 1) {
+        ++sizeClass;
+      }
+      return sizeClass;
+    }
+
+    static void deleteList(FreeBlock *block) {
+      while (block) {
+        FreeBlock *next = block->next;
+        delete[] reinterpret_cast<data_type *> (block);
+        block = next;
+      }
+    }
+
+    /* Takes a block from the free list of the size class, refilling the list from the blocks other threads returned if it is empty.*/
+    data_type *take(size_t sizeClass) {
+      if (!freeList_[sizeClass]) {
+        FreeBlock *block = returned_[sizeClass].exchange(0, std::memory_order_acquire);
+        while (block && freeCount_[sizeClass] < kMaxFreeBlocks) {
+          FreeBlock *next = block->next;
+          block->next = freeList_[sizeClass];
+          freeList_[sizeClass] = block;
+          ++freeCount_[sizeClass];
+          block = next;
+        }
+        deleteList(block);
+      }
+
+      FreeBlock *block = freeList_[sizeClass];
+      if (block) {
+        freeList_[sizeClass] = block->next;
+        --freeCount_[sizeClass];
+      }
+      return reinterpret_cast<data_type *> (block);
+    }
+
+    void release(data_type *data, size_t sizeClass) {
+      FreeBlock *block = reinterpret_cast<FreeBlock *> (data);
+      if (owned() == this) {
+        if (freeCount_[sizeClass] < kMaxFreeBlocks) {
+          block->next = freeList_[sizeClass];
+          freeList_[sizeClass] = block;
+          ++freeCount_[sizeClass];
+        } else {
+          delete[] data;
+        }
+      } else {
+        block->next = returned_[sizeClass].load(std::memory_order_relaxed);
+        while (!returned_[sizeClass].compare_exchange_weak(block->next, block,
+          std::memory_order_release, std::memory_order_relaxed)) {
+        }
+      }
+    }
+
+  public:
+
+    ChunkPool(const ChunkPool&) = delete;
+    const ChunkPool& operator=(const ChunkPool&) = delete;
+
+    ~ChunkPool() {
+      for (size_t i = 0; i < kNumSizeClasses; ++i) {
+        deleteList(freeList_[i]);
+        deleteList(returned_[i].load(std::memory_order_acquire));
+      }
+    }
+
+    /* The pool of the calling thread.*/
+    static ChunkPool &local() {
+      static thread_local Owner owner;
+      return *owner.pool_;
+    }
+
+    /* Returns a block of at least size bytes.  Blocks larger than kMaxBlockSize are not pooled.*/
+    boost::shared_array<data_type> allocate(size_type size) {
+      size_t cls = sizeClass(size);
+      if (cls >= kNumSizeClasses) {
+        return boost::shared_array<data_type>(new data_type[size]);
+      }
+      data_type *block = take(cls);
+      if (!block) {
+        block = new data_type[kMinBlockSize << cls];
+      }
+      return boost::shared_array<data_type>(block, Recycle(shared_from_this(), cls));
+    }
+
+    /* The number of blocks of the size class cached by this pool, used for debugging and testing.*/
+    size_t freeBlocks(size_type size) const {
+      size_t cls = sizeClass(size);
+      return (cls < kNumSizeClasses) ? freeCount_[cls] : 0;
+    }
+  };
+
+  /* Allocator drawing blocks from the pool of the allocating thread.  This is what buffers use unless told otherwise.*/
+  class PooledChunkAllocator : public ChunkAllocator {
+  public:
+
+    boost::shared_array<data_type> allocate(size_type size) {
+      return ChunkPool::local().allocate(size);
+    }
+  };
+
+  /* Allocator that gets every block straight from the heap.*/
+  class HeapChunkAllocator : public ChunkAllocator {
+  public:
+
+    boost::shared_array<data_type> allocate(size_type size) {
+      return boost::shared_array<data_type>(new data_type[size]);
+    }
+  };
+
   /* A chunk is the building block for buffers.
    *
    * A chunk is backed by a memory block, and internally it maintains information
@@ -73,9 +258,16 @@ namespace avro::detail {
 
     typedef std::shared_ptr<Chunk> SharedPtr;
 
-    /* Default constructor, allocates a new underlying block for this chunk.*/
+    /* Default constructor, takes a new underlying block for this chunk from the pool of the calling thread.*/
     Chunk(size_type size) :
-    underlyingBlock_(new data_type[size]),
+    underlyingBlock_(ChunkPool::local().allocate(size)),
+    readPos_(underlyingBlock_.get()),
+    writePos_(readPos_),
+    endPos_(readPos_ + size) { }
+
+    /* Uses the supplied block, which must hold at least size bytes, as the underlying block for this chunk.*/
+    Chunk(const boost::shared_array<data_type> &block, size_type size) :
+    underlyingBlock_(block),
     readPos_(underlyingBlock_.get()),
     writePos_(readPos_),
     endPos_(readPos_ + size) { }
@@ -167,7 +359,11 @@ namespace avro::detail {
 
     /* Add a new chunk to the list of chunks for this buffer, growing the  buffer by the default block size.*/
     void allocChunkChecked(size_type size = kDefaultBlockSize) {
-      writeChunks_.push_back(Chunk(size));
+      if (allocator_) {
+        writeChunks_.push_back(Chunk(allocator_->allocate(size), size));
+      } else {
+        writeChunks_.push_back(Chunk(size));
+      }
       freeSpace_ += writeChunks_.back().freeSize();
     }
 
@@ -240,14 +436,17 @@ namespace avro::detail {
     typedef std::shared_ptr<BufferImpl> SharedPtr;
     typedef std::shared_ptr<const BufferImpl> ConstSharedPtr;
 
-    /* Default constructor, creates a buffer without any chunks*/
-    BufferImpl() :
+    /* Default constructor, creates a buffer without any chunks.  Blocks come from the supplied allocator, or from the pool of the
+       allocating thread if there is none.*/
+    explicit BufferImpl(const ChunkAllocatorPtr &allocator = ChunkAllocatorPtr()) :
+    allocator_(allocator),
     freeSpace_(0),
     size_(0) { }
 
     /* Copy constructor, gets a copy of all the chunks with data.*/
     explicit BufferImpl(const BufferImpl &src) :
     readChunks_(src.readChunks_),
+    allocator_(src.allocator_),
     freeSpace_(0),
     size_(src.size_) { }
 
@@ -462,6 +661,7 @@ namespace avro::detail {
 
     ChunkList readChunks_; //chunks of this buffer containing data
     ChunkList writeChunks_; //chunks of this buffer containing free space
+    ChunkAllocatorPtr allocator_; //source of new blocks, null for the thread's pool
 
     size_type freeSpace_; //capacity of buffer before allocation required
     size_type size_; //amount of data in buffer
@@ -0,0 +1,227 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstring>
+#include "AsyncStream.hh"
+#include "unistd.h"
+#include "errno.h"
+#include "sys/epoll.h"
+
+namespace avro {
+
+  namespace {
+
+    const int kMaxEvents = 256;
+
+  }
+
+  EpollReactor::EpollReactor() : epfd_(::epoll_create1(EPOLL_CLOEXEC)), stopped_(false) {
+    if (epfd_ < 0) {
+      throw Exception(boost::format("Cannot create epoll instance: %1%") % ::strerror(errno));
+    }
+  }
+
+  EpollReactor::~EpollReactor() {
+    ::close(epfd_);
+  }
+
+  void EpollReactor::add(int fd, uint32_t events, const Handler& handler) {
+    epoll_event ev;
+    ev.events = events;
+    ev.data.fd = fd;
+    if (::epoll_ctl(epfd_, EPOLL_CTL_ADD, fd, &ev) < 0) {
+      throw Exception(boost::format("Cannot watch file descriptor %1%: %2%") % fd % ::strerror(errno));
+    }
+    handlers_[fd] = std::make_shared<Handler>(handler);
+  }
+
+  void EpollReactor::modify(int fd, uint32_t events) {
+    epoll_event ev;
+    ev.events = events;
+    ev.data.fd = fd;
+    if (::epoll_ctl(epfd_, EPOLL_CTL_MOD, fd, &ev) < 0) {
+      throw Exception(boost::format("Cannot change events of file descriptor %1%: %2%") % fd % ::strerror(errno));
+    }
+  }
+
+  void EpollReactor::remove(int fd) {
+    if (handlers_.erase(fd)) {
+      ::epoll_ctl(epfd_, EPOLL_CTL_DEL, fd, 0);
+    }
+  }
+
+  size_t EpollReactor::poll(int timeoutMs) {
+    epoll_event events[kMaxEvents];
+    int n = ::epoll_wait(epfd_, events, kMaxEvents, timeoutMs);
+    if (n < 0) {
+      if (errno == EINTR) {
+        return 0;
+      }
+      throw Exception(boost::format("epoll_wait failed: %1%") % ::strerror(errno));
+    }
+    size_t called = 0;
+    for (int i = 0; i < n; ++i) {
+      std::map<int, std::shared_ptr<Handler> >::const_iterator it = handlers_.find(events[i].data.fd);
+      if (it != handlers_.end()) {
+        // the handler may remove itself
+        std::shared_ptr<Handler> handler = it->second;
+        (*handler)(events[i].events);
+        ++called;
+      }
+    }
+    return called;
+  }
+
+  void EpollReactor::run() {
+    stopped_ = false;
+    while (!stopped_ && !handlers_.empty()) {
+      poll();
+    }
+  }
+
+  AsyncInputStream::AsyncInputStream(EpollReactor& reactor, int fd, size_t chunkSize) :
+  reactor_(reactor), fd_(fd), buffer_(chunkSize), eof_(false), byteCount_(0) {
+  }
+
+  AsyncInputStream::~AsyncInputStream() {
+    reactor_.remove(fd_);
+  }
+
+  bool AsyncInputStream::tryNext(const uint8_t** data, size_t* len) {
+    if (eof_) {
+      *len = 0;
+      return true;
+    }
+    for (;;) {
+      ssize_t n = ::read(fd_, &buffer_[0], buffer_.size());
+      if (n > 0) {
+        *data = &buffer_[0];
+        *len = n;
+        byteCount_ += n;
+        return true;
+      } else if (n == 0) {
+        eof_ = true;
+        *len = 0;
+        return true;
+      } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        return false;
+      } else if (errno != EINTR) {
+        throw Exception(boost::format("Cannot read from file descriptor %1%: %2%") % fd_ % ::strerror(errno));
+      }
+    }
+  }
+
+  void AsyncInputStream::next(const ChunkHandler& handler) {
+    pending_ = handler;
+    if (!reactor_.contains(fd_)) {
+      reactor_.add(fd_, EPOLLIN, [this](uint32_t) {
+        onReady();
+      });
+    }
+  }
+
+  /* The descriptor stays registered after a chunk is handed out, as the next one is usually asked for right away; it is only removed once
+     it turns out that nobody is waiting.  The handler may destroy this stream, so nothing is touched after it returns.*/
+  void AsyncInputStream::onReady() {
+    if (!pending_) {
+      reactor_.remove(fd_);
+      return;
+    }
+    const uint8_t* data = 0;
+    size_t len;
+    if (tryNext(&data, &len)) {
+      ChunkHandler handler;
+      handler.swap(pending_);
+      handler(data, len);
+    }
+  }
+
+  AsyncOutputStream::AsyncOutputStream(EpollReactor& reactor, int fd, size_t chunkSize) :
+  reactor_(reactor), fd_(fd), chunkSize_(chunkSize), head_(0), flushed_(0), used_(0), byteCount_(0) {
+  }
+
+  AsyncOutputStream::~AsyncOutputStream() {
+    reactor_.remove(fd_);
+  }
+
+  bool AsyncOutputStream::next(uint8_t** data, size_t* len) {
+    if (used_ == buffer_.size()) {
+      if (head_ > 0) {
+        // move the bytes still needed to the front, the written ones are done with
+        std::memmove(&buffer_[0], &buffer_[head_], used_ - head_);
+        flushed_ -= head_;
+        used_ -= head_;
+        head_ = 0;
+      }
+      if (used_ == buffer_.size()) {
+        buffer_.resize(std::max(chunkSize_, 2 * buffer_.size()));
+      }
+    }
+    *data = &buffer_[used_];
+    *len = buffer_.size() - used_;
+    byteCount_ += *len;
+    used_ = buffer_.size();
+    return true;
+  }
+
+  void AsyncOutputStream::backup(size_t len) {
+    used_ -= len;
+    byteCount_ -= len;
+  }
+
+  uint64_t AsyncOutputStream::byteCount() const {
+    return byteCount_;
+  }
+
+  void AsyncOutputStream::flush() {
+    flushed_ = used_;
+    // if the descriptor is being waited for, the reactor writes the new bytes along with the old ones
+    if (!reactor_.contains(fd_) && !writePending()) {
+      reactor_.add(fd_, EPOLLOUT, [this](uint32_t events) {
+        onReady(events);
+      });
+    }
+  }
+
+  bool AsyncOutputStream::writePending() {
+    while (head_ < flushed_) {
+      ssize_t n = ::write(fd_, &buffer_[head_], flushed_ - head_);
+      if (n >= 0) {
+        head_ += n;
+      } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        return false;
+      } else if (errno != EINTR) {
+        throw Exception(boost::format("Cannot write to file descriptor %1%: %2%") % fd_ % ::strerror(errno));
+      }
+    }
+    if (used_ == flushed_) {
+      head_ = flushed_ = used_ = 0;
+    }
+    return true;
+  }
+
+  void AsyncOutputStream::onReady(uint32_t) {
+    if (writePending()) {
+      reactor_.remove(fd_);
+      if (drained_) {
+        drained_();
+      }
+    }
+  }
+
+} // namespace avro
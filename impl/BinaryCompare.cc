@@ -0,0 +1,363 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cmath>
+#include <cstring>
+#include "BinaryCompare.hh"
+#include "ViewDecoder.hh"
+
+namespace avro {
+
+  namespace {
+
+    typedef std::vector<CompiledSchema::Op> Ops;
+
+    template <typename T>
+    int compareNumbers(T a, T b) {
+      return a < b ? -1 : (b < a ? 1 : 0);
+    }
+
+    /* NaN sorts after everything else, -0.0 before 0.0.*/
+    template <typename T>
+    int compareReals(T a, T b) {
+      int c = compareNumbers(a, b);
+      if (c != 0) {
+        return c;
+      }
+      bool an = std::isnan(a);
+      bool bn = std::isnan(b);
+      if (an || bn) {
+        return compareNumbers(an, bn);
+      }
+      return compareNumbers(std::signbit(b), std::signbit(a));
+    }
+
+    int compareBytes(const BytesView& a, const BytesView& b) {
+      size_t n = std::min(a.size(), b.size());
+      int c = n ? std::memcmp(a.data(), b.data(), n) : 0;
+      return c != 0 ? c : compareNumbers(a.size(), b.size());
+    }
+
+    int applyOrder(FieldOrder order, int c) {
+      return order == FieldOrder::DESCENDING ? -c : c;
+    }
+
+    /* Skips the value of the op at index i and returns the index of the op after it.*/
+    size_t skipValue(const Ops& ops, size_t i, ViewDecoder& d) {
+      const CompiledSchema::Op& op = ops[i];
+      switch (op.type) {
+        case Type::AVRO_INT:
+        case Type::AVRO_LONG:
+          d.decodeLong();
+          break;
+        case Type::AVRO_FLOAT:
+          d.skip(4);
+          break;
+        case Type::AVRO_DOUBLE:
+          d.skip(8);
+          break;
+        case Type::AVRO_BOOL:
+          d.skip(1);
+          break;
+        case Type::AVRO_STRING:
+        case Type::AVRO_BYTES:
+          d.decodeBytes();
+          break;
+        case Type::AVRO_ARRAY:
+        case Type::AVRO_MAP:
+          for (int64_t count = d.decodeLong(); count != 0; count = d.decodeLong()) {
+            if (count < 0) {
+              // a block written with its byte size is skipped whole
+              int64_t size = d.decodeLong();
+              if (size < 0) {
+                throw Exception(boost::format("Invalid block size: %1%") % size);
+              }
+              d.skip(static_cast<size_t> (size));
+            } else {
+              for (int64_t k = 0; k < count; ++k) {
+                for (size_t j = i + 1; j < op.end;) {
+                  j = skipValue(ops, j, d);
+                }
+              }
+            }
+          }
+          return op.end;
+        default:
+          break;
+      }
+      return i + 1;
+    }
+
+    /* Compares the values of the ops [begin, end) in both datums, up to the first difference.*/
+    int compareValues(const Ops& ops, size_t begin, size_t end, ViewDecoder& a, ViewDecoder& b);
+
+    int compareArrays(const Ops& ops, size_t i, ViewDecoder& a, ViewDecoder& b) {
+      const CompiledSchema::Op& op = ops[i];
+      size_t na = a.decodeItemCount();
+      size_t nb = b.decodeItemCount();
+      for (;;) {
+        if (na == 0 || nb == 0) {
+          return applyOrder(op.order, compareNumbers(na != 0, nb != 0));
+        }
+        int c = compareValues(ops, i + 1, op.end, a, b);
+        if (c != 0) {
+          return c;
+        }
+        if (--na == 0) {
+          na = a.decodeItemCount();
+        }
+        if (--nb == 0) {
+          nb = b.decodeItemCount();
+        }
+      }
+    }
+
+    int compareValues(const Ops& ops, size_t begin, size_t end, ViewDecoder& a, ViewDecoder& b) {
+      for (size_t i = begin; i < end;) {
+        const CompiledSchema::Op& op = ops[i];
+        if (op.order == FieldOrder::IGNORE) {
+          skipValue(ops, i, a);
+          i = skipValue(ops, i, b);
+          continue;
+        }
+        int c = 0;
+        switch (op.type) {
+          case Type::AVRO_INT:
+            c = compareNumbers(a.decodeInt(), b.decodeInt());
+            break;
+          case Type::AVRO_LONG:
+            c = compareNumbers(a.decodeLong(), b.decodeLong());
+            break;
+          case Type::AVRO_FLOAT:
+            c = compareReals(a.decodeFloat(), b.decodeFloat());
+            break;
+          case Type::AVRO_DOUBLE:
+            c = compareReals(a.decodeDouble(), b.decodeDouble());
+            break;
+          case Type::AVRO_BOOL:
+            c = compareNumbers(a.decodeBool(), b.decodeBool());
+            break;
+          case Type::AVRO_STRING:
+          case Type::AVRO_BYTES:
+            c = compareBytes(a.decodeBytes(), b.decodeBytes());
+            break;
+          case Type::AVRO_ARRAY:
+          {
+            // the items carry their own order
+            int result = compareArrays(ops, i, a, b);
+            if (result != 0) {
+              return result;
+            }
+            i = op.end;
+            continue;
+          }
+          case Type::AVRO_MAP:
+            throw Exception("Maps cannot be compared");
+          default:
+            break;
+        }
+        if (c != 0) {
+          return applyOrder(op.order, c);
+        }
+        ++i;
+      }
+      return 0;
+    }
+
+    // the constants of wyhash
+    const uint64_t kSecret0 = 0xa0761d6478bd642fULL;
+    const uint64_t kSecret1 = 0xe7037ed1a0b428dbULL;
+    const uint64_t kSecret2 = 0x8ebc6af09c88c6e3ULL;
+    const uint64_t kSecret3 = 0x589965cc75374cc3ULL;
+
+    /* Multiplies to 128 bits and folds the product back to 64.*/
+    uint64_t mum(uint64_t a, uint64_t b) {
+#ifdef __SIZEOF_INT128__
+      unsigned __int128 r = static_cast<unsigned __int128> (a) * b;
+      return static_cast<uint64_t> (r) ^ static_cast<uint64_t> (r >> 64);
+#else
+      uint64_t ha = a >> 32;
+      uint64_t hb = b >> 32;
+      uint64_t la = static_cast<uint32_t> (a);
+      uint64_t lb = static_cast<uint32_t> (b);
+      uint64_t rh = ha * hb;
+      uint64_t rm0 = ha * lb;
+      uint64_t rm1 = hb * la;
+      uint64_t rl = la * lb;
+      uint64_t t = rl + (rm0 << 32);
+      uint64_t c = t < rl;
+      uint64_t lo = t + (rm1 << 32);
+      c += lo < t;
+      uint64_t hi = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+      return lo ^ hi;
+#endif
+    }
+
+    /* Reads 8 bytes as a little-endian number, whatever the byte order of the machine.*/
+    uint64_t read64(const uint8_t* p) {
+      uint64_t v;
+      std::memcpy(&v, p, sizeof (v));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+      v = __builtin_bswap64(v);
+#endif
+      return v;
+    }
+
+    /* The bits of a real, with every NaN the same.*/
+    uint64_t realBits(double v) {
+      if (std::isnan(v)) {
+        return 0x7ff8000000000000ULL;
+      }
+      uint64_t bits;
+      std::memcpy(&bits, &v, sizeof (bits));
+      return bits;
+    }
+
+    uint64_t realBits(float v) {
+      if (std::isnan(v)) {
+        return 0x7fc00000;
+      }
+      uint32_t bits;
+      std::memcpy(&bits, &v, sizeof (bits));
+      return bits;
+    }
+
+    /* Mixes values into a 64-bit hash, each step a 64 by 64 bit multiplication as in wyhash.*/
+    class Hasher {
+      const uint64_t seed_;
+      uint64_t h_;
+    public:
+
+      explicit Hasher(uint64_t seed) : seed_(seed), h_(seed ^ kSecret0) {
+      }
+
+      uint64_t seed() const {
+        return seed_;
+      }
+
+      void mix(uint64_t v) {
+        h_ = mum(h_ ^ kSecret1, v ^ kSecret2);
+      }
+
+      void mixBytes(const uint8_t* p, size_t n) {
+        mix(n);
+        for (; n >= 16; p += 16, n -= 16) {
+          h_ = mum(read64(p) ^ kSecret1, read64(p + 8) ^ h_);
+        }
+        if (n > 0) {
+          uint8_t tail[16] = {0};
+          std::memcpy(tail, p, n);
+          h_ = mum(read64(tail) ^ kSecret1, read64(tail + 8) ^ h_);
+        }
+      }
+
+      uint64_t finish() const {
+        return mum(h_ ^ kSecret3, seed_ ^ kSecret1);
+      }
+    };
+
+    /* Mixes the values of the ops [begin, end) into the hasher.*/
+    void hashValues(const Ops& ops, size_t begin, size_t end, ViewDecoder& d, Hasher& h) {
+      for (size_t i = begin; i < end;) {
+        const CompiledSchema::Op& op = ops[i];
+        if (op.order == FieldOrder::IGNORE) {
+          i = skipValue(ops, i, d);
+          continue;
+        }
+        switch (op.type) {
+          case Type::AVRO_INT:
+          case Type::AVRO_LONG:
+            h.mix(static_cast<uint64_t> (d.decodeLong()));
+            break;
+          case Type::AVRO_FLOAT:
+            h.mix(realBits(d.decodeFloat()));
+            break;
+          case Type::AVRO_DOUBLE:
+            h.mix(realBits(d.decodeDouble()));
+            break;
+          case Type::AVRO_BOOL:
+            h.mix(d.decodeBool());
+            break;
+          case Type::AVRO_STRING:
+          case Type::AVRO_BYTES:
+          {
+            BytesView v = d.decodeBytes();
+            h.mixBytes(v.data(), v.size());
+            break;
+          }
+          case Type::AVRO_ARRAY:
+          {
+            // the items in turn and then their number, whatever the blocks
+            uint64_t count = 0;
+            for (size_t n = d.decodeItemCount(); n != 0; n = d.decodeItemCount()) {
+              for (size_t k = 0; k < n; ++k, ++count) {
+                hashValues(ops, i + 1, op.end, d, h);
+              }
+            }
+            h.mix(count);
+            i = op.end;
+            continue;
+          }
+          case Type::AVRO_MAP:
+          {
+            // entries are hashed apart and summed, so that their order does not matter
+            uint64_t sum = 0;
+            uint64_t count = 0;
+            for (size_t n = d.decodeItemCount(); n != 0; n = d.decodeItemCount()) {
+              for (size_t k = 0; k < n; ++k, ++count) {
+                Hasher entry(h.seed());
+                hashValues(ops, i + 1, op.end, d, entry);
+                sum += entry.finish();
+              }
+            }
+            h.mix(sum);
+            h.mix(count);
+            i = op.end;
+            continue;
+          }
+          default:
+            break;
+        }
+        ++i;
+      }
+    }
+
+  }
+
+  int compareBinary(const CompiledSchema& schema, const uint8_t* a, size_t alen, const uint8_t* b, size_t blen) {
+    ViewDecoder da(a, alen);
+    ViewDecoder db(b, blen);
+    return compareValues(schema.ops(), 0, schema.ops().size(), da, db);
+  }
+
+  int compareBinary(const ValidSchema& schema, const uint8_t* a, size_t alen, const uint8_t* b, size_t blen) {
+    return compareBinary(CompiledSchema(schema), a, alen, b, blen);
+  }
+
+  uint64_t hashBinary(const CompiledSchema& schema, const uint8_t* data, size_t len, uint64_t seed) {
+    ViewDecoder d(data, len);
+    Hasher h(seed);
+    hashValues(schema.ops(), 0, schema.ops().size(), d, h);
+    return h.finish();
+  }
+
+  uint64_t hashBinary(const ValidSchema& schema, const uint8_t* data, size_t len, uint64_t seed) {
+    return hashBinary(CompiledSchema(schema), data, len, seed);
+  }
+
+} // namespace avro
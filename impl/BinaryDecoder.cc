@@ -39,9 +39,17 @@ namespace avro {
     float decodeFloat();
     double decodeDouble();
     void decodeString(std::string& value);
+    void decodeString(std::pmr::string& value);
     void skipString();
     void decodeBytes(std::vector<uint8_t>& value);
+    void decodeBytes(std::pmr::vector<uint8_t>& value);
     void skipBytes();
+    size_t arrayStart();
+    size_t arrayNext();
+    size_t skipArray();
+    size_t mapStart();
+    size_t mapNext();
+    size_t skipMap();
 
     int64_t doDecodeLong();
     size_t doDecodeItemCount();
@@ -102,6 +110,14 @@ namespace avro {
     }
   }
 
+  void BinaryDecoder::decodeString(std::pmr::string& value) {
+    size_t len = decodeInt();
+    value.resize(len);
+    if (len > 0) {
+      in_.readBytes(reinterpret_cast<uint8_t*> (&value[0]), len);
+    }
+  }
+
   void BinaryDecoder::skipString() {
     size_t len = decodeInt();
     in_.skipBytes(len);
@@ -115,11 +131,56 @@ namespace avro {
     }
   }
 
+  void BinaryDecoder::decodeBytes(std::pmr::vector<uint8_t>& value) {
+    size_t len = decodeInt();
+    value.resize(len);
+    if (len > 0) {
+      in_.readBytes(&value[0], len);
+    }
+  }
+
   void BinaryDecoder::skipBytes() {
     size_t len = decodeInt();
     in_.skipBytes(len);
   }  
 
+  size_t BinaryDecoder::arrayStart() {
+    return doDecodeItemCount();
+  }
+
+  size_t BinaryDecoder::arrayNext() {
+    return doDecodeItemCount();
+  }
+
+  /* Skips every block that was written with its size in bytes and returns the item count of the first block that was not, or 0 at the end
+     of the array.*/
+  size_t BinaryDecoder::skipArray() {
+    for (;;) {
+      int64_t r = doDecodeLong();
+      if (r < 0) {
+        int64_t n = doDecodeLong();
+        if (n < 0) {
+          throw Exception(boost::format("Invalid block size: %1%") % n);
+        }
+        in_.skipBytes(n);
+      } else {
+        return static_cast<size_t> (r);
+      }
+    }
+  }
+
+  size_t BinaryDecoder::mapStart() {
+    return doDecodeItemCount();
+  }
+
+  size_t BinaryDecoder::mapNext() {
+    return doDecodeItemCount();
+  }
+
+  size_t BinaryDecoder::skipMap() {
+    return skipArray();
+  }
+
   size_t BinaryDecoder::doDecodeItemCount() {
     int64_t result = doDecodeLong();
     if (result < 0) {
@@ -128,7 +189,6 @@ namespace avro {
     }
     return static_cast<size_t> (result);
   }
-  
 
   int64_t BinaryDecoder::doDecodeLong() {
     uint64_t encoded = 0;
@@ -16,14 +16,86 @@
  * limitations under the License.
  */
 
+#include <algorithm>
+#include <memory>
+#include <vector>
 #include "Encoder.hh"
 #include "Zigzag.hh"
+#include "BufferStreamAdapter.hh"
 #include <boost/array.hpp>
 
 namespace avro {
 
+  namespace {
+
+    const size_t kMinBlockBuffer = 256;
+
+    /* Collects the bytes of one block of an array or map, so that its size is known before it is written. The memory is kept for the next
+       block.*/
+    class BlockBuffer : public OutputStream {
+      std::vector<uint8_t> data_;
+      size_t len_; // bytes of data_ holding data
+
+    public:
+
+      BlockBuffer() : len_(0) { }
+
+      bool next(uint8_t** data, size_t* len) {
+        if (len_ == data_.size()) {
+          data_.resize(std::max(kMinBlockBuffer, 2 * data_.size()));
+        }
+        *data = &data_[len_];
+        *len = data_.size() - len_;
+        len_ = data_.size();
+        return true;
+      }
+
+      void backup(size_t len) {
+        len_ -= len;
+      }
+
+      uint64_t byteCount() const {
+        return len_;
+      }
+
+      void flush() { }
+
+      const uint8_t* data() const {
+        return data_.empty() ? 0 : &data_[0];
+      }
+
+      void clear() {
+        len_ = 0;
+      }
+    };
+
+    /* An array or map being written by a blocking encoder.*/
+    struct BlockLevel {
+      BlockBuffer buffer;
+      size_t count; // items in the open block
+      bool open;
+
+      BlockLevel() : count(0), open(false) { }
+    };
+
+  }
+
   class BinaryEncoder : public Encoder {
     StreamWriter out_;
+    const size_t foreignThreshold_;
+    BufferOutputStream* buffer_; // set when foreign chunks can be linked into the output
+
+    // Only used when writing sized blocks
+    const bool sizedBlocks_;
+    OutputStream* os_;
+    std::vector<std::unique_ptr<BlockLevel> > levels_; // kept across arrays, so the buffers are reused
+    size_t depth_; // arrays and maps currently open
+
+    void startLevel();
+    void closeBlock();
+    void endLevel();
+
+    bool linkForeign(const uint8_t *bytes, size_t len);
 
     void init(OutputStream& os);
     void flush();
@@ -34,6 +106,7 @@ namespace avro {
     void encodeFloat(float f);
     void encodeDouble(double d);
     void encodeString(const std::string& s);
+    void encodeString(const char* s, size_t len);
     void encodeBytes(const uint8_t *bytes, size_t len);
     void encodeEnum(size_t e);
     void arrayStart();
@@ -45,14 +118,30 @@ namespace avro {
     void encodeUnionIndex(size_t e);
 
     void doEncodeLong(int64_t l);
+
+  public:
+
+    BinaryEncoder(size_t foreignThreshold = 0, bool sizedBlocks = false) :
+    foreignThreshold_(foreignThreshold), buffer_(0), sizedBlocks_(sizedBlocks), os_(0), depth_(0) { }
   };
 
   EncoderPtr binaryEncoder() {
     return std::make_shared<BinaryEncoder>();
   }
 
+  EncoderPtr bufferEncoder(size_t foreignThreshold) {
+    return std::make_shared<BinaryEncoder>(foreignThreshold);
+  }
+
+  EncoderPtr blockingBinaryEncoder() {
+    return std::make_shared<BinaryEncoder>(0, true);
+  }
+
   void BinaryEncoder::init(OutputStream& os) {
     out_.reset(os);
+    os_ = &os;
+    depth_ = 0;
+    buffer_ = foreignThreshold_ ? dynamic_cast<BufferOutputStream*> (&os) : 0;
   }
 
   void BinaryEncoder::flush() {
@@ -85,13 +174,32 @@ namespace avro {
   }
 
   void BinaryEncoder::encodeString(const std::string& s) {
-    doEncodeLong(s.size());
-    out_.writeBytes(reinterpret_cast<const uint8_t*> (s.c_str()), s.size());
+    encodeString(s.data(), s.size());
+  }
+
+  void BinaryEncoder::encodeString(const char* s, size_t len) {
+    doEncodeLong(len);
+    if (!linkForeign(reinterpret_cast<const uint8_t*> (s), len)) {
+      out_.writeBytes(reinterpret_cast<const uint8_t*> (s), len);
+    }
   }
 
   void BinaryEncoder::encodeBytes(const uint8_t *bytes, size_t len) {
     doEncodeLong(len);
-    out_.writeBytes(bytes, len);
+    if (!linkForeign(bytes, len)) {
+      out_.writeBytes(bytes, len);
+    }
+  }
+
+  /* Appends a large value to the underlying buffer as a foreign chunk, after committing whatever precedes it. The memory is borrowed, so
+     there is nothing to free when the chunk is released.*/
+  bool BinaryEncoder::linkForeign(const uint8_t *bytes, size_t len) {
+    if (buffer_ == 0 || depth_ > 0 || len < foreignThreshold_) {
+      return false;
+    }
+    out_.flush();
+    buffer_->appendForeignData(bytes, len, detail::free_func());
+    return true;
   }
 
   void BinaryEncoder::encodeEnum(size_t e) {
@@ -99,16 +207,28 @@ namespace avro {
   }
 
   void BinaryEncoder::arrayStart() {
+    if (sizedBlocks_) {
+      startLevel();
+    }
   }
 
   void BinaryEncoder::arrayEnd() {
+    if (sizedBlocks_) {
+      endLevel();
+    }
     doEncodeLong(0);
   }
 
   void BinaryEncoder::mapStart() {
+    if (sizedBlocks_) {
+      startLevel();
+    }
   }
 
   void BinaryEncoder::mapEnd() {
+    if (sizedBlocks_) {
+      endLevel();
+    }
     doEncodeLong(0);
   }
 
@@ -116,7 +236,52 @@ namespace avro {
     if (count == 0) {
       throw Exception("Count cannot be zero");
     }
-    doEncodeLong(count);
+    if (sizedBlocks_) {
+      if (depth_ == 0) {
+        throw Exception("setItemCount() outside of an array or map");
+      }
+      closeBlock();
+      BlockLevel& level = *levels_[depth_ - 1];
+      level.buffer.clear();
+      level.count = count;
+      level.open = true;
+      out_.reset(level.buffer);
+    } else {
+      doEncodeLong(count);
+    }
+  }
+
+  void BinaryEncoder::startLevel() {
+    if (levels_.size() == depth_) {
+      levels_.push_back(std::unique_ptr<BlockLevel>(new BlockLevel));
+    }
+    levels_[depth_]->open = false;
+    ++depth_;
+  }
+
+  /* Writes the open block of the innermost array or map, if any, into the enclosing block or the stream as its negated item count, its
+     size in bytes and its bytes.*/
+  void BinaryEncoder::closeBlock() {
+    BlockLevel& level = *levels_[depth_ - 1];
+    if (!level.open) {
+      return;
+    }
+    out_.reset(depth_ > 1 ? static_cast<OutputStream&> (levels_[depth_ - 2]->buffer) : *os_);
+    size_t size = level.buffer.byteCount();
+    doEncodeLong(-static_cast<int64_t> (level.count));
+    doEncodeLong(size);
+    if (size > 0) {
+      out_.writeBytes(level.buffer.data(), size);
+    }
+    level.open = false;
+  }
+
+  void BinaryEncoder::endLevel() {
+    if (depth_ == 0) {
+      throw Exception("End of an array or map that was not started");
+    }
+    closeBlock();
+    --depth_;
   }
 
   void BinaryEncoder::startItem() {
@@ -0,0 +1,241 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <thread>
+#include <algorithm>
+#include <cstring>
+#include "ChunkPipe.hh"
+#include <sys/uio.h>
+#include <limits.h>
+#include <errno.h>
+
+namespace avro {
+
+  namespace {
+
+    detail::Chunk emptyChunk() {
+      return detail::Chunk(boost::shared_array<detail::data_type>(), 0);
+    }
+
+  }
+
+  class ChunkPipe::Output : public OutputStream {
+    ChunkPipe& pipe_;
+    detail::Chunk current_; // data written but not yet published, followed by the free space
+    uint64_t byteCount_;
+
+  public:
+
+    Output(ChunkPipe& pipe) : pipe_(pipe), current_(emptyChunk()), byteCount_(0) {
+    }
+
+    bool next(uint8_t** data, size_t* len) override {
+      if (current_.freeSize() == 0) {
+        flush();
+        current_ = detail::Chunk(pipe_.chunkSize_);
+      }
+      *data = reinterpret_cast<uint8_t*> (current_.tellWritePos());
+      *len = current_.freeSize();
+      current_.incrementCursor(*len);
+      byteCount_ += *len;
+      return true;
+    }
+
+    void backup(size_t len) override {
+      current_.truncateBack(len);
+      byteCount_ -= len;
+    }
+
+    uint64_t byteCount() const override {
+      return byteCount_;
+    }
+
+    void flush() override {
+      if (current_.dataSize()) {
+        pipe_.publish(current_);
+        current_.truncateFront(current_.dataSize());
+      }
+    }
+  };
+
+  class ChunkPipe::Input : public InputStream {
+    ChunkPipe& pipe_;
+    size_t offset_; // bytes of the front slot already handed out
+    size_t byteCount_;
+    bool holding_; // whether the front slot has been handed out
+
+  public:
+
+    Input(ChunkPipe& pipe) : pipe_(pipe), offset_(0), byteCount_(0), holding_(false) {
+    }
+
+    bool next(const uint8_t** data, size_t* len) override {
+      if (holding_ && offset_ == pipe_.front().dataSize()) {
+        pipe_.pop(1);
+        holding_ = false;
+        offset_ = 0;
+      }
+      if (!holding_) {
+        if (pipe_.waitReadable() == 0) {
+          return false;
+        }
+        holding_ = true;
+      }
+      const detail::Chunk& chunk = pipe_.front();
+      *data = reinterpret_cast<const uint8_t*> (chunk.tellReadPos()) + offset_;
+      *len = chunk.dataSize() - offset_;
+      offset_ = chunk.dataSize();
+      byteCount_ += *len;
+      return true;
+    }
+
+    void backup(size_t len) override {
+      offset_ -= len;
+      byteCount_ -= len;
+    }
+
+    void skip(size_t len) override {
+      const uint8_t* data;
+      size_t n;
+      while (len > 0 && next(&data, &n)) {
+        if (n > len) {
+          backup(n - len);
+          n = len;
+        }
+        len -= n;
+      }
+    }
+
+    size_t byteCount() const override {
+      return byteCount_;
+    }
+  };
+
+  ChunkPipe::ChunkPipe(size_t capacity, size_t chunkSize) :
+  slots_(capacity, emptyChunk()),
+  chunkSize_(chunkSize),
+  head_(0),
+  tail_(0),
+  closed_(false),
+  output_(new Output(*this)),
+  input_(new Input(*this)) {
+    if (capacity == 0 || chunkSize == 0) {
+      throw Exception("ChunkPipe capacity and chunk size must be positive");
+    }
+  }
+
+  ChunkPipe::~ChunkPipe() {
+    delete output_;
+    delete input_;
+  }
+
+  OutputStream& ChunkPipe::output() {
+    return *output_;
+  }
+
+  InputStream& ChunkPipe::input() {
+    return *input_;
+  }
+
+  void ChunkPipe::close() {
+    output_->flush();
+    closed_.store(true, std::memory_order_release);
+  }
+
+  void ChunkPipe::publish(const detail::Chunk& chunk) {
+    size_t head = head_.load(std::memory_order_relaxed);
+    while (head - tail_.load(std::memory_order_acquire) == slots_.size()) {
+      std::this_thread::yield();
+    }
+    slots_[head % slots_.size()] = chunk;
+    head_.store(head + 1, std::memory_order_release);
+  }
+
+  size_t ChunkPipe::waitReadable() {
+    size_t tail = tail_.load(std::memory_order_relaxed);
+    for (;;) {
+      size_t head = head_.load(std::memory_order_acquire);
+      if (head != tail) {
+        return head - tail;
+      }
+      if (closed_.load(std::memory_order_acquire)) {
+        // the producer may have published between the two loads
+        head = head_.load(std::memory_order_acquire);
+        return head - tail;
+      }
+      std::this_thread::yield();
+    }
+  }
+
+  const detail::Chunk& ChunkPipe::front() const {
+    return slot(0);
+  }
+
+  const detail::Chunk& ChunkPipe::slot(size_t i) const {
+    return slots_[(tail_.load(std::memory_order_relaxed) + i) % slots_.size()];
+  }
+
+  void ChunkPipe::pop(size_t n) {
+    size_t tail = tail_.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < n; ++i) {
+      // drop the reference here so that the block goes back to the producer's pool
+      slots_[(tail + i) % slots_.size()] = emptyChunk();
+    }
+    tail_.store(tail + n, std::memory_order_release);
+  }
+
+  size_t ChunkPipe::drainTo(int fd) {
+    std::vector<iovec> iov;
+    size_t written = 0;
+    while (size_t available = waitReadable()) {
+      available = std::min<size_t>(available, IOV_MAX);
+      iov.resize(available);
+      for (size_t i = 0; i < available; ++i) {
+        const detail::Chunk& chunk = slot(i);
+        iov[i].iov_base = const_cast<detail::data_type*> (chunk.tellReadPos());
+        iov[i].iov_len = chunk.dataSize();
+      }
+
+      iovec* first = &iov[0];
+      size_t count = available;
+      while (count > 0) {
+        ssize_t n = ::writev(fd, first, count);
+        if (n < 0) {
+          if (errno == EINTR) {
+            continue;
+          }
+          throw Exception(boost::format("Cannot write to pipe target: %1%") %
+            ::strerror(errno));
+        }
+        written += n;
+        while (count > 0 && static_cast<size_t> (n) >= first->iov_len) {
+          n -= first->iov_len;
+          ++first;
+          --count;
+        }
+        if (count > 0) {
+          first->iov_base = static_cast<char*> (first->iov_base) + n;
+          first->iov_len -= n;
+        }
+      }
+      pop(available);
+    }
+    return written;
+  }
+
+} // namespace avro
@@ -0,0 +1,86 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "CompiledSchema.hh"
+#include "NodeImpl.hh"
+
+namespace avro {
+
+  namespace {
+
+    // a record nested deeper than this can only be a record that contains itself, which has no finite encoding
+    const size_t kMaxDepth = 1000;
+
+    /* The order of a field with the given order inside a field of the enclosing order.*/
+    FieldOrder combine(FieldOrder enclosing, FieldOrder field) {
+      if (enclosing == FieldOrder::IGNORE || field == FieldOrder::IGNORE) {
+        return FieldOrder::IGNORE;
+      }
+      return enclosing == field ? FieldOrder::ASCENDING : FieldOrder::DESCENDING;
+    }
+
+  }
+
+  CompiledSchema::CompiledSchema(const ValidSchema& schema) {
+    compile(schema.root(), 0, FieldOrder::ASCENDING);
+  }
+
+  CompiledSchema::CompiledSchema(const ValidSchema& schema, const std::vector<std::string>& keyFields) {
+    NodePtr root = schema.root();
+    if (root->type() != Type::AVRO_RECORD) {
+      throw Exception(boost::format("Key fields need a record schema, not %1%") % root->type());
+    }
+    std::vector<bool> key(root->leaves(), false);
+    for (std::vector<std::string>::const_iterator it = keyFields.begin(); it != keyFields.end(); ++it) {
+      size_t index = 0;
+      if (!root->nameIndex(*it, index)) {
+        throw Exception(boost::format("No field named %1% in record %2%") % *it % root->name());
+      }
+      key[index] = true;
+    }
+    for (size_t i = 0; i < root->leaves(); ++i) {
+      compile(root->leafAt(i), 1, key[i] ? root->fieldOrderAt(i) : FieldOrder::IGNORE);
+    }
+  }
+
+  void CompiledSchema::compile(const NodePtr& n, size_t depth, FieldOrder order) {
+    NodePtr node = (n->type() == Type::AVRO_SYMBOLIC) ? resolveSymbol(n) : n;
+    if (node->type() == Type::AVRO_RECORD) {
+      if (depth > kMaxDepth) {
+        throw Exception(boost::format("Cannot compile recursive record %1%") % node->name());
+      }
+      for (size_t i = 0; i < node->leaves(); ++i) {
+        compile(node->leafAt(i), depth + 1, combine(order, node->fieldOrderAt(i)));
+      }
+    } else if (node->type() == Type::AVRO_ARRAY || node->type() == Type::AVRO_MAP) {
+      size_t index = ops_.size();
+      Op op = { node->type(), 0, order };
+      ops_.push_back(op);
+      if (node->type() == Type::AVRO_MAP) {
+        Op key = { Type::AVRO_STRING, index + 2, order };
+        ops_.push_back(key);
+      }
+      compile(node->leafAt(node->type() == Type::AVRO_MAP ? 1 : 0), depth + 1, order);
+      ops_[index].end = ops_.size();
+    } else {
+      Op op = { node->type(), ops_.size() + 1, order };
+      ops_.push_back(op);
+    }
+  }
+
+} // namespace avro
@@ -133,9 +133,10 @@ namespace avro {
     const string& name;
     const NodePtr schema;
     const GenericDatum defaultValue;
+    const FieldOrder order;
 
-    Field(const string& n, const NodePtr& v, GenericDatum dv) :
-    name(n), schema(v), defaultValue(dv) {
+    Field(const string& n, const NodePtr& v, GenericDatum dv, FieldOrder o) :
+    name(n), schema(v), defaultValue(dv), order(o) {
     }
   };
 
@@ -203,13 +204,53 @@ namespace avro {
             makeGenericDatum(n->leafAt(i), it->second, st));
         }
         return GenericDatum(n, result);
-      }      
+      }
+      case Type::AVRO_ARRAY:
+      {
+        assertType(e, json::etArray);
+        GenericArray result(n);
+        const vector<Entity>& elements = e.arrayValue();
+        for (vector<Entity>::const_iterator it = elements.begin();
+          it != elements.end(); ++it) {
+          result.value().push_back(makeGenericDatum(n->leafAt(0), *it, st));
+        }
+        return GenericDatum(n, result);
+      }
+      case Type::AVRO_MAP:
+      {
+        assertType(e, json::etObject);
+        GenericMap result(n);
+        const map<string, Entity>& v = e.objectValue();
+        for (map<string, Entity>::const_iterator it = v.begin();
+          it != v.end(); ++it) {
+          result.value().push_back(std::make_pair(it->first,
+            makeGenericDatum(n->leafAt(1), it->second, st)));
+        }
+        return GenericDatum(n, result);
+      }
       default:
         throw Exception(boost::format("Unknown type: %1%") % t);
     }
     return GenericDatum();
   }
 
+  static FieldOrder makeFieldOrder(const Entity& e, const Object& m) {
+    Object::const_iterator it = m.find("order");
+    if (it == m.end()) {
+      return FieldOrder::ASCENDING;
+    }
+    ensureType<string>(it->second, "order");
+    const string& order = it->second.stringValue();
+    if (order == "ascending") {
+      return FieldOrder::ASCENDING;
+    } else if (order == "descending") {
+      return FieldOrder::DESCENDING;
+    } else if (order == "ignore") {
+      return FieldOrder::IGNORE;
+    }
+    throw Exception(boost::format("Invalid field order %1% in line %2%") % order % e.line());
+  }
+
   static Field makeField(const Entity& e, SymbolTable& st, const string& ns) {
     const Object& m = e.objectValue();
     const string& n = getStringField(e, m, "name");
@@ -218,7 +259,7 @@ namespace avro {
     NodePtr node = makeNode(it->second, st, ns);
     GenericDatum d = (it2 == m.end()) ? GenericDatum() :
       makeGenericDatum(node, it2->second, st);
-    return Field(n, node, d);
+    return Field(n, node, d, makeFieldOrder(e, m));
   }
 
   static NodePtr makeRecordNode(const Entity& e,
@@ -227,17 +268,33 @@ namespace avro {
     concepts::MultiAttribute<string> fieldNames;
     concepts::MultiAttribute<NodePtr> fieldValues;
     vector<GenericDatum> defaultValues;
+    vector<FieldOrder> fieldOrders;
 
     for (Array::const_iterator it = v.begin(); it != v.end(); ++it) {
       Field f = makeField(*it, st, ns);
       fieldNames.add(f.name);
       fieldValues.add(f.schema);
       defaultValues.push_back(f.defaultValue);
+      fieldOrders.push_back(f.order);
     }
     return NodePtr(new NodeRecord(asSingleAttribute(name),
-      fieldValues, fieldNames, defaultValues));
+      fieldValues, fieldNames, defaultValues, fieldOrders));
   }
-  
+
+  static NodePtr makeArrayNode(const Entity& e, const Object& m,
+    SymbolTable& st, const string& ns) {
+    Object::const_iterator it = findField(e, m, "items");
+    return NodePtr(new NodeArray(asSingleAttribute(
+      makeNode(it->second, st, ns))));
+  }
+
+  static NodePtr makeMapNode(const Entity& e, const Object& m,
+    SymbolTable& st, const string& ns) {
+    Object::const_iterator it = findField(e, m, "values");
+    return NodePtr(new NodeMap(asSingleAttribute(
+      makeNode(it->second, st, ns))));
+  }
+
   static Name getName(const Entity& e, const Object& m, const string& ns) {
     const string& name = getStringField(e, m, "name");
 
@@ -276,6 +333,10 @@ namespace avro {
           *std::dynamic_pointer_cast<NodeRecord>(result));
       }
       return result;
+    } else if (type == "array") {
+      return makeArrayNode(e, m, st, ns);
+    } else if (type == "map") {
+      return makeMapNode(e, m, st, ns);
     }
     throw Exception(boost::format("Unknown type definition: %1%")
       % e.toString());
@@ -0,0 +1,526 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include "BinaryCompare.hh"
+#include "Decoder.hh"
+#include "Encoder.hh"
+#include "ExternalSort.hh"
+#include "ResumableDecoder.hh"
+#include "unistd.h"
+#include "errno.h"
+
+namespace avro {
+
+  namespace {
+
+    const size_t kDefaultMaxFanIn = 64;
+
+    // the fewest datums worth sorting on a thread of their own
+    const size_t kMinSliceSize = 4096;
+
+    // chunks a run reads ahead of the merge
+    const size_t kPrefetchChunks = 4;
+
+    const size_t kFileBufferSize = 64 * 1024;
+
+    /* Where a datum begins and ends in the bytes of its run.*/
+    typedef std::pair<size_t, size_t> Span;
+
+    /* Datums held in memory, their bytes one after the other.*/
+    struct Run {
+      std::vector<uint8_t> bytes;
+      std::vector<Span> datums;
+    };
+
+    class SpanLess {
+      const CompiledSchema& schema_;
+      const uint8_t* bytes_;
+    public:
+
+      SpanLess(const CompiledSchema& schema, const uint8_t* bytes) : schema_(schema), bytes_(bytes) {
+      }
+
+      bool operator()(const Span& a, const Span& b) const {
+        return compareBinary(schema_, bytes_ + a.first, a.second - a.first, bytes_ + b.first, b.second - b.first) < 0;
+      }
+    };
+
+    /* Sorts the datums of the run on up to the given number of threads: slices of the datums are sorted apart and then merged pairwise,
+       both stable.*/
+    void sortRun(const CompiledSchema& schema, Run& run, size_t threads) {
+      SpanLess less(schema, run.bytes.data());
+      std::vector<Span>& d = run.datums;
+      size_t slices = std::max<size_t>(1, std::min(threads, d.size() / kMinSliceSize));
+      std::vector<size_t> bounds;
+      for (size_t i = 0; i <= slices; ++i) {
+        bounds.push_back(d.size() * i / slices);
+      }
+      std::vector<std::future<void> > sorts;
+      for (size_t i = 1; i < slices; ++i) {
+        sorts.push_back(std::async(std::launch::async, [&d, &bounds, &less, i]() {
+          std::stable_sort(d.begin() + bounds[i], d.begin() + bounds[i + 1], less);
+        }));
+      }
+      std::stable_sort(d.begin(), d.begin() + bounds[1], less);
+      for (size_t i = 0; i < sorts.size(); ++i) {
+        sorts[i].get();
+      }
+      for (size_t width = 1; width < slices; width *= 2) {
+        std::vector<std::future<void> > merges;
+        for (size_t i = 0; i + width < slices; i += 2 * width) {
+          size_t first = bounds[i];
+          size_t middle = bounds[i + width];
+          size_t last = bounds[std::min(i + 2 * width, slices)];
+          merges.push_back(std::async(std::launch::async, [&d, &less, first, middle, last]() {
+            std::inplace_merge(d.begin() + first, d.begin() + middle, d.begin() + last, less);
+          }));
+        }
+        for (size_t i = 0; i < merges.size(); ++i) {
+          merges[i].get();
+        }
+      }
+    }
+
+    /* A temporary file, removed with this object.*/
+    class TempFile {
+      std::string path_;
+    public:
+
+      explicit TempFile(const std::string& directory) : path_(directory + "/avro-sort-XXXXXX") {
+        int fd = ::mkstemp(&path_[0]);
+        if (fd < 0) {
+          throw Exception(boost::format("Cannot create a temporary file in %1%: %2%") % directory % ::strerror(errno));
+        }
+        ::close(fd);
+      }
+
+      ~TempFile() {
+        ::unlink(path_.c_str());
+      }
+
+      TempFile(const TempFile&) = delete;
+      const TempFile& operator=(const TempFile&) = delete;
+
+      const char* path() const {
+        return path_.c_str();
+      }
+    };
+
+    /* A sorted run on disk: the number of datums, then every datum as Avro bytes.*/
+    struct SpilledRun {
+      std::shared_ptr<TempFile> file;
+      size_t count;
+    };
+
+    SpilledRun spill(const Run& run, const std::string& directory) {
+      SpilledRun result = { std::make_shared<TempFile>(directory), run.datums.size() };
+      std::shared_ptr<OutputStream> os = fileOutputStream(result.file->path(), kFileBufferSize);
+      EncoderPtr e = binaryEncoder();
+      e->init(*os);
+      e->encodeLong(result.count);
+      for (std::vector<Span>::const_iterator it = run.datums.begin(); it != run.datums.end(); ++it) {
+        e->encodeBytes(&run.bytes[it->first], it->second - it->first);
+      }
+      e->flush();
+      return result;
+    }
+
+    class PrefetchInputStream;
+
+    /* The threads that read the runs being merged ahead of the merges, shared by all the runs of a sort so that the number of threads does
+       not grow with the number of runs.  A run waits in line while it has room for more chunks, and each thread reads one chunk of the
+       first run in line at a time.*/
+    class PrefetchPool {
+      std::mutex mutex_; // guards the pool and the state of its streams
+      std::condition_variable cond_;
+      std::deque<PrefetchInputStream*> wanted_;
+      bool stop_;
+      std::vector<std::thread> threads_;
+
+      friend class PrefetchInputStream;
+
+      void run();
+
+      /* Puts the stream in line, with the mutex held.*/
+      void want(PrefetchInputStream* s) {
+        wanted_.push_back(s);
+        cond_.notify_one();
+      }
+
+    public:
+
+      explicit PrefetchPool(size_t threads) : stop_(false) {
+        for (size_t i = 0; i < threads; ++i) {
+          threads_.emplace_back(&PrefetchPool::run, this);
+        }
+      }
+
+      ~PrefetchPool() {
+        {
+          std::lock_guard<std::mutex> lock(mutex_);
+          stop_ = true;
+        }
+        cond_.notify_all();
+        for (std::vector<std::thread>::iterator it = threads_.begin(); it != threads_.end(); ++it) {
+          it->join();
+        }
+      }
+    };
+
+    /* Reads a file up to kPrefetchChunks chunks ahead of the consumer, on the threads of a pool.*/
+    class PrefetchInputStream : public InputStream {
+      PrefetchPool& pool_;
+      std::shared_ptr<InputStream> in_;
+      std::condition_variable cond_;
+      std::deque<std::vector<uint8_t> > ready_;
+      bool done_;
+      bool busy_; // in line or being read by the pool
+      bool stop_;
+      std::exception_ptr error_;
+      std::vector<uint8_t> current_; // the chunk the consumer is reading
+      size_t pos_;
+      size_t byteCount_;
+
+      friend class PrefetchPool;
+
+      /* Reads the next chunk, on a thread of the pool without its mutex held.*/
+      void fetch() {
+        std::vector<uint8_t> chunk;
+        std::exception_ptr error;
+        try {
+          const uint8_t* data = 0;
+          size_t len = 0;
+          while (chunk.empty() && in_->next(&data, &len)) {
+            chunk.assign(data, data + len);
+          }
+        } catch (...) {
+          error = std::current_exception();
+        }
+
+        std::lock_guard<std::mutex> lock(pool_.mutex_);
+        if (chunk.empty()) {
+          error_ = error;
+          done_ = true;
+        } else {
+          ready_.push_back(std::move(chunk));
+        }
+        if (!done_ && !stop_ && ready_.size() < kPrefetchChunks) {
+          pool_.want(this);
+        } else {
+          busy_ = false;
+        }
+        cond_.notify_all();
+      }
+
+    public:
+
+      PrefetchInputStream(const char* path, PrefetchPool& pool) : pool_(pool), in_(fileInputStream(path, kFileBufferSize)), done_(false),
+      busy_(true), stop_(false), pos_(0), byteCount_(0) {
+        std::lock_guard<std::mutex> lock(pool_.mutex_);
+        pool_.want(this);
+      }
+
+      ~PrefetchInputStream() {
+        std::unique_lock<std::mutex> lock(pool_.mutex_);
+        stop_ = true;
+        std::deque<PrefetchInputStream*>::iterator it = std::find(pool_.wanted_.begin(), pool_.wanted_.end(), this);
+        if (it != pool_.wanted_.end()) {
+          pool_.wanted_.erase(it);
+          busy_ = false;
+        }
+        cond_.wait(lock, [this]() {
+          return !busy_;
+        });
+      }
+
+      bool next(const uint8_t** data, size_t* len) override {
+        if (pos_ == current_.size()) {
+          std::unique_lock<std::mutex> lock(pool_.mutex_);
+          cond_.wait(lock, [this]() {
+            return !ready_.empty() || done_;
+          });
+          if (ready_.empty()) {
+            if (error_) {
+              std::rethrow_exception(error_);
+            }
+            return false;
+          }
+          current_.swap(ready_.front());
+          ready_.pop_front();
+          pos_ = 0;
+          if (!busy_ && !done_) {
+            busy_ = true;
+            pool_.want(this);
+          }
+        }
+        *data = &current_[pos_];
+        *len = current_.size() - pos_;
+        byteCount_ += *len;
+        pos_ = current_.size();
+        return true;
+      }
+
+      void backup(size_t len) override {
+        pos_ -= len;
+        byteCount_ -= len;
+      }
+
+      void skip(size_t len) override {
+        const uint8_t* data = 0;
+        size_t n = 0;
+        while (len > 0 && next(&data, &n)) {
+          if (n > len) {
+            backup(n - len);
+            n = len;
+          }
+          len -= n;
+        }
+      }
+
+      size_t byteCount() const override {
+        return byteCount_;
+      }
+    };
+
+    void PrefetchPool::run() {
+      std::unique_lock<std::mutex> lock(mutex_);
+      for (;;) {
+        cond_.wait(lock, [this]() {
+          return !wanted_.empty() || stop_;
+        });
+        if (wanted_.empty()) {
+          return;
+        }
+        PrefetchInputStream* s = wanted_.front();
+        wanted_.pop_front();
+        lock.unlock();
+        s->fetch();
+        lock.lock();
+      }
+    }
+
+    /* The datums of a spilled run, one at a time.*/
+    class RunReader {
+      PrefetchInputStream in_;
+      DecoderPtr decoder_;
+      size_t left_;
+    public:
+
+      /* The current datum.*/
+      std::vector<uint8_t> datum;
+
+      RunReader(const TempFile& file, PrefetchPool& pool) : in_(file.path(), pool), decoder_(binaryDecoder()) {
+        decoder_->init(in_);
+        left_ = static_cast<size_t> (decoder_->decodeLong());
+      }
+
+      /* Moves to the next datum, false at the end of the run.*/
+      bool next() {
+        if (left_ == 0) {
+          return false;
+        }
+        --left_;
+        decoder_->decodeBytes(datum);
+        return true;
+      }
+    };
+
+    /* Merges the runs through a heap, calling emit(datum) in sorted order.  Of equal datums, those of earlier runs come first.*/
+    template <typename F>
+    void merge(const CompiledSchema& schema, const std::vector<SpilledRun>& runs, PrefetchPool& pool, F emit) {
+      std::vector<std::unique_ptr<RunReader> > readers;
+      for (std::vector<SpilledRun>::const_iterator it = runs.begin(); it != runs.end(); ++it) {
+        readers.emplace_back(new RunReader(*it->file, pool));
+      }
+      auto later = [&schema, &readers](size_t a, size_t b) {
+        const std::vector<uint8_t>& x = readers[a]->datum;
+        const std::vector<uint8_t>& y = readers[b]->datum;
+        int c = compareBinary(schema, x.data(), x.size(), y.data(), y.size());
+        return c != 0 ? c > 0 : a > b;
+      };
+      std::priority_queue<size_t, std::vector<size_t>, decltype(later)> heap(later);
+      for (size_t i = 0; i < readers.size(); ++i) {
+        if (readers[i]->next()) {
+          heap.push(i);
+        }
+      }
+      while (!heap.empty()) {
+        size_t i = heap.top();
+        heap.pop();
+        emit(readers[i]->datum);
+        if (readers[i]->next()) {
+          heap.push(i);
+        }
+      }
+    }
+
+    SpilledRun mergeToFile(const CompiledSchema& schema, const std::vector<SpilledRun>& runs, const std::string& directory,
+      PrefetchPool& pool) {
+      SpilledRun result = { std::make_shared<TempFile>(directory), 0 };
+      for (std::vector<SpilledRun>::const_iterator it = runs.begin(); it != runs.end(); ++it) {
+        result.count += it->count;
+      }
+      std::shared_ptr<OutputStream> os = fileOutputStream(result.file->path(), kFileBufferSize);
+      EncoderPtr e = binaryEncoder();
+      e->init(*os);
+      e->encodeLong(result.count);
+      merge(schema, runs, pool, [&e](const std::vector<uint8_t>& datum) {
+        e->encodeBytes(datum);
+      });
+      e->flush();
+      return result;
+    }
+
+    std::string defaultTempDirectory() {
+      const char* dir = std::getenv("TMPDIR");
+      return dir != 0 && *dir != 0 ? dir : "/tmp";
+    }
+
+  }
+
+  ExternalSorter::ExternalSorter(const CompiledSchema& schema, size_t runSize, size_t threads, const std::string& tempDirectory) :
+  schema_(schema), runSize_(runSize),
+  threads_(threads != 0 ? threads : std::max<size_t>(1, std::thread::hardware_concurrency())),
+  tempDirectory_(tempDirectory.empty() ? defaultTempDirectory() : tempDirectory), maxFanIn_(kDefaultMaxFanIn), spilledRuns_(0) {
+  }
+
+  void ExternalSorter::setMaxFanIn(size_t maxFanIn) {
+    if (maxFanIn < 2) {
+      throw Exception(boost::format("Cannot merge fewer than 2 runs at once: %1%") % maxFanIn);
+    }
+    maxFanIn_ = maxFanIn;
+  }
+
+  size_t ExternalSorter::sort(InputStream& in, OutputStream& out) {
+    spilledRuns_ = 0;
+    std::vector<SpilledRun> runs;
+    std::deque<std::future<SpilledRun> > spilling;
+    std::shared_ptr<Run> run = std::make_shared<Run>();
+    DatumScanner scanner(schema_);
+    size_t begin = 0;
+    auto spillRun = [this, &run, &runs, &spilling]() {
+      if (spilling.size() == threads_) {
+        runs.push_back(spilling.front().get());
+        spilling.pop_front();
+      }
+      std::shared_ptr<Run> full = run;
+      spilling.push_back(std::async(std::launch::async, [this, full]() {
+        sortRun(schema_, *full, 1);
+        return spill(*full, tempDirectory_);
+      }));
+    };
+
+    // read the input into runs, spilling the full ones on other threads
+    const uint8_t* data = 0;
+    size_t len = 0;
+    while (in.next(&data, &len)) {
+      while (len > 0) {
+        size_t n = scanner.scan(data, len);
+        run->bytes.insert(run->bytes.end(), data, data + n);
+        data += n;
+        len -= n;
+        if (!scanner.complete()) {
+          continue;
+        }
+        if (run->bytes.size() == begin) {
+          throw Exception("Cannot sort datums with an empty encoding");
+        }
+        run->datums.push_back(Span(begin, run->bytes.size()));
+        scanner.reset();
+        begin = run->bytes.size();
+        if (begin >= runSize_) {
+          spillRun();
+          run = std::make_shared<Run>();
+          begin = 0;
+        }
+      }
+    }
+    if (run->bytes.size() != begin) {
+      throw Exception("Truncated Avro data");
+    }
+
+    if (spilling.empty()) {
+      sortRun(schema_, *run, threads_);
+      StreamWriter w(out);
+      for (std::vector<Span>::const_iterator it = run->datums.begin(); it != run->datums.end(); ++it) {
+        w.writeBytes(&run->bytes[it->first], it->second - it->first);
+      }
+      w.flush();
+      return run->datums.size();
+    }
+    if (!run->datums.empty()) {
+      spillRun();
+    }
+    run.reset();
+    while (!spilling.empty()) {
+      runs.push_back(spilling.front().get());
+      spilling.pop_front();
+    }
+    spilledRuns_ = runs.size();
+    size_t count = 0;
+    for (std::vector<SpilledRun>::const_iterator it = runs.begin(); it != runs.end(); ++it) {
+      count += it->count;
+    }
+
+    // merge groups of runs into longer ones until a single merge is enough
+    PrefetchPool prefetch(threads_);
+    while (runs.size() > maxFanIn_) {
+      std::vector<SpilledRun> merged;
+      std::deque<std::future<SpilledRun> > merging;
+      for (size_t i = 0; i < runs.size(); i += maxFanIn_) {
+        std::vector<SpilledRun> group(runs.begin() + i, runs.begin() + std::min(i + maxFanIn_, runs.size()));
+        if (merging.size() == threads_) {
+          merged.push_back(merging.front().get());
+          merging.pop_front();
+        }
+        if (group.size() == 1) {
+          // a run of its own is already merged
+          merging.push_back(std::async(std::launch::deferred, [group]() {
+            return group[0];
+          }));
+        } else {
+          merging.push_back(std::async(std::launch::async, [this, group, &prefetch]() {
+            return mergeToFile(schema_, group, tempDirectory_, prefetch);
+          }));
+        }
+      }
+      while (!merging.empty()) {
+        merged.push_back(merging.front().get());
+        merging.pop_front();
+      }
+      runs.swap(merged);
+    }
+
+    StreamWriter w(out);
+    merge(schema_, runs, prefetch, [&w](const std::vector<uint8_t>& datum) {
+      w.writeBytes(datum.data(), datum.size());
+    });
+    w.flush();
+    return count;
+  }
+
+} // namespace avro
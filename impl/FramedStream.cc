@@ -0,0 +1,205 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "FramedStream.hh"
+#include "Zigzag.hh"
+
+namespace avro {
+
+  namespace {
+
+    const size_t kMinFrameBuffer = 256;
+
+  }
+
+  FramedOutputStream::FramedOutputStream(OutputStream& out, FrameLengthEncoding encoding, size_t batchSize) :
+  out_(out), encoding_(encoding), batchSize_(batchSize), frameLen_(0), batched_(0), byteCount_(0) {
+  }
+
+  bool FramedOutputStream::next(uint8_t** data, size_t* len) {
+    if (frameLen_ == frame_.size()) {
+      frame_.resize(std::max(kMinFrameBuffer, 2 * frame_.size()));
+    }
+    *data = &frame_[frameLen_];
+    *len = frame_.size() - frameLen_;
+    byteCount_ += *len;
+    frameLen_ = frame_.size();
+    return true;
+  }
+
+  void FramedOutputStream::backup(size_t len) {
+    frameLen_ -= len;
+    byteCount_ -= len;
+  }
+
+  uint64_t FramedOutputStream::byteCount() const {
+    return byteCount_;
+  }
+
+  void FramedOutputStream::endFrame() {
+    if (encoding_ == FrameLengthEncoding::VARINT) {
+      boost::array<uint8_t, 10> bytes;
+      size_t n = encodeInt64(frameLen_, bytes);
+      out_.writeBytes(bytes.data(), n);
+      batched_ += n;
+    } else {
+      if (frameLen_ > 0xffffffff) {
+        throw Exception(boost::format("Frame of %1% bytes is too large for a 32-bit length") % frameLen_);
+      }
+      uint32_t len = static_cast<uint32_t> (frameLen_);
+      uint8_t bytes[4] = {
+        static_cast<uint8_t> (len >> 24), static_cast<uint8_t> (len >> 16),
+        static_cast<uint8_t> (len >> 8), static_cast<uint8_t> (len)
+      };
+      out_.writeBytes(bytes, sizeof (bytes));
+      batched_ += sizeof (bytes);
+    }
+    if (frameLen_) {
+      out_.writeBytes(&frame_[0], frameLen_);
+    }
+    batched_ += frameLen_;
+    frameLen_ = 0;
+  }
+
+  void FramedOutputStream::flush() {
+    if (frameLen_) {
+      endFrame();
+    }
+    if (batched_ >= batchSize_) {
+      out_.flush();
+      batched_ = 0;
+    }
+  }
+
+  void FramedOutputStream::sync() {
+    if (frameLen_) {
+      endFrame();
+    }
+    out_.flush();
+    batched_ = 0;
+  }
+
+  FramedInputStream::FramedInputStream(InputStream& in, FrameLengthEncoding encoding) :
+  in_(in), encoding_(encoding), frameSize_(0), remaining_(0), byteCount_(0) {
+  }
+
+  bool FramedInputStream::readByte(uint8_t& b) {
+    const uint8_t* data;
+    size_t n = 0;
+    while (n == 0) {
+      if (!in_.next(&data, &n)) {
+        return false;
+      }
+    }
+    b = *data;
+    in_.backup(n - 1);
+    return true;
+  }
+
+  bool FramedInputStream::nextFrame() {
+    skipFrame();
+
+    uint8_t b;
+    if (!readByte(b)) {
+      return false;
+    }
+    uint64_t size = 0;
+    if (encoding_ == FrameLengthEncoding::VARINT) {
+      uint64_t encoded = b & 0x7f;
+      for (int shift = 7; b & 0x80; shift += 7) {
+        if (shift > 63 || !readByte(b)) {
+          throw Exception("Invalid or truncated frame length");
+        }
+        encoded |= static_cast<uint64_t> (b & 0x7f) << shift;
+      }
+      int64_t len = decodeZigzag64(encoded);
+      if (len < 0) {
+        throw Exception(boost::format("Invalid frame length: %1%") % len);
+      }
+      size = len;
+    } else {
+      size = b;
+      for (int i = 1; i < 4; ++i) {
+        if (!readByte(b)) {
+          throw Exception("Truncated frame length");
+        }
+        size = (size << 8) | b;
+      }
+    }
+    frameSize_ = remaining_ = size;
+    return true;
+  }
+
+  void FramedInputStream::skipFrame() {
+    if (remaining_) {
+      in_.skip(remaining_);
+      byteCount_ += remaining_;
+      remaining_ = 0;
+    }
+  }
+
+  const uint8_t* FramedInputStream::contiguousFrame() {
+    if (remaining_ == 0) {
+      return 0;
+    }
+    const uint8_t* data;
+    size_t n;
+    if (!in_.next(&data, &n)) {
+      return 0;
+    }
+    if (n < remaining_) {
+      in_.backup(n);
+      return 0;
+    }
+    in_.backup(n - remaining_);
+    byteCount_ += remaining_;
+    remaining_ = 0;
+    return data;
+  }
+
+  bool FramedInputStream::next(const uint8_t** data, size_t* len) {
+    if (remaining_ == 0 || !in_.next(data, len)) {
+      return false;
+    }
+    if (*len > remaining_) {
+      in_.backup(*len - remaining_);
+      *len = remaining_;
+    }
+    remaining_ -= *len;
+    byteCount_ += *len;
+    return true;
+  }
+
+  void FramedInputStream::backup(size_t len) {
+    in_.backup(len);
+    remaining_ += len;
+    byteCount_ -= len;
+  }
+
+  void FramedInputStream::skip(size_t len) {
+    len = std::min(len, remaining_);
+    in_.skip(len);
+    remaining_ -= len;
+    byteCount_ += len;
+  }
+
+  size_t FramedInputStream::byteCount() const {
+    return byteCount_;
+  }
+
+} // namespace avro
@@ -17,6 +17,9 @@
  */
 
 #include "Generic.hh"
+#include "NodeImpl.hh"
+#include "Specific.hh"
+#include "Zigzag.hh"
 #include <sstream>
 
 namespace avro {
@@ -27,6 +30,15 @@ namespace avro {
 
   typedef vector<uint8_t> bytes;
 
+  namespace {
+
+    /* The type of the datums made for items of the given schema, so that an item left from an earlier decode can be decoded into.*/
+    Type itemTypeOf(const NodePtr& n) {
+      return n->type() == Type::AVRO_SYMBOLIC ? resolveSymbol(n)->type() : n->type();
+    }
+
+  }
+
   void GenericContainer::assertType(const NodePtr& schema, Type type) {
     if (schema->type() != type) {
       throw Exception(boost::format("Schema type %1 expected %2") %
@@ -94,6 +106,49 @@ namespace avro {
         }
       }
         break;
+      case Type::AVRO_ARRAY:
+      {
+        GenericArray& v = datum.value<GenericArray>();
+        vector<GenericDatum>& r = v.value();
+        const NodePtr& nn = v.schema()->leafAt(0);
+        const Type itemType = itemTypeOf(nn);
+        size_t used = 0;
+        for (size_t m = d.arrayStart(); m != 0; m = d.arrayNext()) {
+          detail::reserveItems(r, used, m);
+          for (size_t i = 0; i < m; ++i, ++used) {
+            if (used == r.size()) {
+              r.push_back(GenericDatum(nn));
+            } else if (r[used].type() != itemType) {
+              r[used] = GenericDatum(nn);
+            }
+            read(r[used], d, isResolving);
+          }
+        }
+        r.erase(r.begin() + used, r.end());
+      }
+        break;
+      case Type::AVRO_MAP:
+      {
+        GenericMap& v = datum.value<GenericMap>();
+        GenericMap::Value& r = v.value();
+        const NodePtr& nn = v.schema()->leafAt(1);
+        const Type itemType = itemTypeOf(nn);
+        size_t used = 0;
+        for (size_t m = d.mapStart(); m != 0; m = d.mapNext()) {
+          detail::reserveItems(r, used, m);
+          for (size_t i = 0; i < m; ++i, ++used) {
+            if (used == r.size()) {
+              r.push_back(std::make_pair(string(), GenericDatum(nn)));
+            } else if (r[used].second.type() != itemType) {
+              r[used].second = GenericDatum(nn);
+            }
+            d.decodeString(r[used].first);
+            read(r[used].second, d, isResolving);
+          }
+        }
+        r.erase(r.begin() + used, r.end());
+      }
+        break;
       default:
         throw Exception(boost::format("Unknown schema type %1%") %
           toString(datum.type()));
@@ -152,6 +207,37 @@ namespace avro {
         }
       }
         break;
+      case Type::AVRO_ARRAY:
+      {
+        const GenericArray::Value& r = datum.value<GenericArray>().value();
+        e.arrayStart();
+        if (!r.empty()) {
+          e.setItemCount(r.size());
+          for (GenericArray::Value::const_iterator it = r.begin();
+            it != r.end(); ++it) {
+            e.startItem();
+            write(*it, e);
+          }
+        }
+        e.arrayEnd();
+      }
+        break;
+      case Type::AVRO_MAP:
+      {
+        const GenericMap::Value& r = datum.value<GenericMap>().value();
+        e.mapStart();
+        if (!r.empty()) {
+          e.setItemCount(r.size());
+          for (GenericMap::Value::const_iterator it = r.begin();
+            it != r.end(); ++it) {
+            e.startItem();
+            e.encodeString(it->first);
+            write(it->second, e);
+          }
+        }
+        e.mapEnd();
+      }
+        break;
       default:
         throw Exception(boost::format("Unknown schema type %1%") %
           toString(datum.type()));
@@ -162,4 +248,69 @@ namespace avro {
     write(g, e);
   }
 
+  size_t GenericWriter::encodedSize(const GenericDatum& datum) {
+    switch (datum.type()) {
+      case Type::AVRO_NULL:
+        return 0;
+      case Type::AVRO_BOOL:
+        return 1;
+      case Type::AVRO_INT:
+        return encodedInt32Size(datum.value<int32_t>());
+      case Type::AVRO_LONG:
+        return encodedInt64Size(datum.value<int64_t>());
+      case Type::AVRO_FLOAT:
+        return 4;
+      case Type::AVRO_DOUBLE:
+        return 8;
+      case Type::AVRO_STRING:
+      {
+        size_t len = datum.value<string>().size();
+        return encodedInt64Size(len) + len;
+      }
+      case Type::AVRO_BYTES:
+      {
+        size_t len = datum.value<bytes>().size();
+        return encodedInt64Size(len) + len;
+      }
+      case Type::AVRO_RECORD:
+      {
+        const GenericRecord& r = datum.value<GenericRecord>();
+        size_t size = 0;
+        for (size_t i = 0; i < r.fieldCount(); ++i) {
+          size += encodedSize(r.fieldAt(i));
+        }
+        return size;
+      }
+      case Type::AVRO_ARRAY:
+      {
+        const GenericArray::Value& r = datum.value<GenericArray>().value();
+        size_t size = 1;
+        if (!r.empty()) {
+          size += encodedInt64Size(r.size());
+          for (GenericArray::Value::const_iterator it = r.begin();
+            it != r.end(); ++it) {
+            size += encodedSize(*it);
+          }
+        }
+        return size;
+      }
+      case Type::AVRO_MAP:
+      {
+        const GenericMap::Value& r = datum.value<GenericMap>().value();
+        size_t size = 1;
+        if (!r.empty()) {
+          size += encodedInt64Size(r.size());
+          for (GenericMap::Value::const_iterator it = r.begin();
+            it != r.end(); ++it) {
+            size += encodedInt64Size(it->first.size()) + it->first.size() + encodedSize(it->second);
+          }
+        }
+        return size;
+      }
+      default:
+        throw Exception(boost::format("Unknown schema type %1%") %
+          toString(datum.type()));
+    }
+  }
+
 }
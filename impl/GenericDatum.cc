@@ -66,6 +66,12 @@ namespace avro {
       case Type::AVRO_RECORD:
         value_ = GenericRecord(sc);
         break;
+      case Type::AVRO_ARRAY:
+        value_ = GenericArray(sc);
+        break;
+      case Type::AVRO_MAP:
+        value_ = GenericMap(sc);
+        break;
       default:
         throw Exception(boost::format("Unknown schema type %1%") %
           toString(type_));
@@ -50,6 +50,21 @@ namespace avro {
     return furtherResolution(reader);
   }
 
+  SchemaResolution NodeArray::resolve(const Node &reader) const {
+    if (reader.type() == Type::AVRO_ARRAY) {
+      const NodePtr &arrayType = leafAt(0);
+      return arrayType->resolve(*reader.leafAt(0));
+    }
+    return furtherResolution(reader);
+  }
+
+  SchemaResolution NodeMap::resolve(const Node &reader) const {
+    if (reader.type() == Type::AVRO_MAP) {
+      const NodePtr &valueType = leafAt(1);
+      return valueType->resolve(*reader.leafAt(1));
+    }
+    return furtherResolution(reader);
+  }
 
   SchemaResolution NodeSymbolic::resolve(const Node &reader) const {
     const NodePtr &node = leafAt(0);
@@ -105,6 +120,11 @@ namespace avro {
       os << indent(++depth) << "\"name\": \"" << leafNameAttributes_.get(i) << "\",\n";
       os << indent(depth) << "\"type\": ";
       leafAttributes_.get(i)->printJson(os, depth);
+      if (fieldOrderAt(i) == FieldOrder::DESCENDING) {
+        os << ",\n" << indent(depth) << "\"order\": \"descending\"";
+      } else if (fieldOrderAt(i) == FieldOrder::IGNORE) {
+        os << ",\n" << indent(depth) << "\"order\": \"ignore\"";
+      }
       os << '\n';
       os << indent(--depth) << '}';
     }
@@ -112,4 +132,22 @@ namespace avro {
     os << indent(--depth) << '}';
   }
 
+  void NodeArray::printJson(std::ostream &os, int depth) const {
+    os << "{\n";
+    os << indent(depth + 1) << "\"type\": \"array\",\n";
+    os << indent(depth + 1) << "\"items\": ";
+    leafAttributes_.get()->printJson(os, depth + 1);
+    os << '\n';
+    os << indent(depth) << '}';
+  }
+
+  void NodeMap::printJson(std::ostream &os, int depth) const {
+    os << "{\n";
+    os << indent(depth + 1) << "\"type\": \"map\",\n";
+    os << indent(depth + 1) << "\"values\": ";
+    leafAttributes_.get(1)->printJson(os, depth + 1);
+    os << '\n';
+    os << indent(depth) << '}';
+  }
+
 }
@@ -46,6 +46,128 @@ namespace avro {
 #define DEBUG_OUT(str) noop << str 
 #endif
 
+  typedef ResolverProgram::Opcode Opcode;
+
+  /* The instructions that read or skip a value of type T.*/
+  template<typename T>
+  struct ResolverOps;
+
+  template<>
+  struct ResolverOps<std::string> {
+
+    static void read(ResolverProgram &program, size_t offset) {
+      program.add(Opcode::READ_STRING, offset);
+    }
+
+    static void skip(ResolverProgram &program) {
+      program.addSkip(Opcode::SKIP_LENGTH_PREFIXED, 1);
+    }
+  };
+
+  template<>
+  struct ResolverOps<std::vector<uint8_t> > {
+
+    static void read(ResolverProgram &program, size_t offset) {
+      program.add(Opcode::READ_BYTES, offset);
+    }
+
+    static void skip(ResolverProgram &program) {
+      program.addSkip(Opcode::SKIP_LENGTH_PREFIXED, 1);
+    }
+  };
+
+  template<>
+  struct ResolverOps<int32_t> {
+
+    static void read(ResolverProgram &program, size_t offset) {
+      program.add(Opcode::READ_INT, offset);
+    }
+
+    static void skip(ResolverProgram &program) {
+      program.addSkip(Opcode::SKIP_VARINTS, 1);
+    }
+  };
+
+  template<>
+  struct ResolverOps<int64_t> {
+
+    static void read(ResolverProgram &program, size_t offset) {
+      program.add(Opcode::READ_LONG, offset);
+    }
+
+    static void skip(ResolverProgram &program) {
+      program.addSkip(Opcode::SKIP_VARINTS, 1);
+    }
+  };
+
+  template<>
+  struct ResolverOps<float> {
+
+    static void read(ResolverProgram &program, size_t offset) {
+      program.add(Opcode::READ_FLOAT, offset);
+    }
+
+    static void skip(ResolverProgram &program) {
+      program.addSkip(Opcode::SKIP_BYTES, sizeof (float));
+    }
+  };
+
+  template<>
+  struct ResolverOps<double> {
+
+    static void read(ResolverProgram &program, size_t offset) {
+      program.add(Opcode::READ_DOUBLE, offset);
+    }
+
+    static void skip(ResolverProgram &program) {
+      program.addSkip(Opcode::SKIP_BYTES, sizeof (double));
+    }
+  };
+
+  template<>
+  struct ResolverOps<bool> {
+
+    static void read(ResolverProgram &program, size_t offset) {
+      program.add(Opcode::READ_BOOL, offset);
+    }
+
+    static void skip(ResolverProgram &program) {
+      program.addSkip(Opcode::SKIP_BYTES, 1);
+    }
+  };
+
+  template<>
+  struct ResolverOps<Null> {
+
+    static void read(ResolverProgram &, size_t) {
+    }
+
+    static void skip(ResolverProgram &) {
+    }
+  };
+
+  namespace {
+
+    /* The instruction that reads a value of the writer's type and stores it as the reader's type.*/
+    Opcode promotionOpcode(Type writer, Type reader) {
+      if (writer == Type::AVRO_INT && reader == Type::AVRO_LONG) {
+        return Opcode::INT_TO_LONG;
+      } else if (writer == Type::AVRO_INT && reader == Type::AVRO_FLOAT) {
+        return Opcode::INT_TO_FLOAT;
+      } else if (writer == Type::AVRO_INT && reader == Type::AVRO_DOUBLE) {
+        return Opcode::INT_TO_DOUBLE;
+      } else if (writer == Type::AVRO_LONG && reader == Type::AVRO_FLOAT) {
+        return Opcode::LONG_TO_FLOAT;
+      } else if (writer == Type::AVRO_LONG && reader == Type::AVRO_DOUBLE) {
+        return Opcode::LONG_TO_DOUBLE;
+      } else if (writer == Type::AVRO_FLOAT && reader == Type::AVRO_DOUBLE) {
+        return Opcode::FLOAT_TO_DOUBLE;
+      }
+      throw Exception(boost::format("Cannot promote %1% to %2%") % writer % reader);
+    }
+
+  }
+
   template<typename T>
   class PrimitiveSkipper : public Resolver {
   public:
@@ -59,6 +181,10 @@ namespace avro {
       reader.readValue(val);
       DEBUG_OUT("Skipping " << val);
     }
+
+    virtual void compile(ResolverProgram &program) const {
+      ResolverOps<T>::skip(program);
+    }
   };
 
   template<typename T>
@@ -76,6 +202,10 @@ namespace avro {
       DEBUG_OUT("Reading " << *location);
     }
 
+    virtual void compile(ResolverProgram &program) const {
+      ResolverOps<T>::read(program, offset_);
+    }
+
   private:
 
     size_t offset_;
@@ -94,6 +224,10 @@ namespace avro {
       parseIt<WT>(reader, address);
     }
 
+    virtual void compile(ResolverProgram &program) const {
+      program.add(promotionOpcode(type_to_avro<WT>::type, type_to_avro<RT>::type), offset_);
+    }
+
   private:
 
     void parseIt(Reader &reader, uint8_t *address, const boost::true_type &) const {
@@ -128,6 +262,10 @@ namespace avro {
       reader.readBytes(val);
       DEBUG_OUT("Skipping bytes");
     }
+
+    virtual void compile(ResolverProgram &program) const {
+      ResolverOps<std::vector<uint8_t> >::skip(program);
+    }
   };
 
   template <>
@@ -145,6 +283,10 @@ namespace avro {
       DEBUG_OUT("Reading bytes");
     }
 
+    virtual void compile(ResolverProgram &program) const {
+      ResolverOps<std::vector<uint8_t> >::read(program, offset_);
+    }
+
   private:
 
     size_t offset_;
@@ -165,6 +307,12 @@ namespace avro {
       }
     }
 
+    virtual void compile(ResolverProgram &program) const {
+      for (size_t i = 0; i < resolvers_.size(); ++i) {
+        resolvers_[i].compile(program);
+      }
+    }
+
   protected:
 
     ResolverPtrVector resolvers_;
@@ -184,6 +332,12 @@ namespace avro {
       }
     }
 
+    virtual void compile(ResolverProgram &program) const {
+      for (size_t i = 0; i < resolvers_.size(); ++i) {
+        resolvers_[i].compile(program);
+      }
+    }
+
     RecordParser(ResolverFactory &factory, const NodePtr &writer, const NodePtr &reader, const CompoundLayout &offsets);
 
   protected:
@@ -355,6 +509,85 @@ namespace avro {
   }
  
 
+  namespace {
+
+    template<typename T>
+    T &at(uint8_t *address, size_t offset) {
+      return *reinterpret_cast<T *> (address + offset);
+    }
+
+    template<typename WT, typename RT>
+    void promote(Reader &reader, uint8_t *address, size_t offset) {
+      WT val;
+      reader.readValue(val);
+      at<RT>(address, offset) = static_cast<RT> (val);
+    }
+
+  }
+
+  void ResolverProgram::parseOps(Reader &reader, uint8_t *address, const Op *begin, const Op *end) {
+    for (const Op *it = begin; it != end; ++it) {
+      switch (it->opcode) {
+        case Opcode::READ_STRING:
+          reader.readValue(at<std::string>(address, it->offset));
+          break;
+        case Opcode::READ_BYTES:
+          reader.readBytes(at<std::vector<uint8_t> >(address, it->offset));
+          break;
+        case Opcode::READ_INT:
+          reader.readValue(at<int32_t>(address, it->offset));
+          break;
+        case Opcode::READ_LONG:
+          reader.readValue(at<int64_t>(address, it->offset));
+          break;
+        case Opcode::READ_FLOAT:
+          reader.readValue(at<float>(address, it->offset));
+          break;
+        case Opcode::READ_DOUBLE:
+          reader.readValue(at<double>(address, it->offset));
+          break;
+        case Opcode::READ_BOOL:
+          reader.readValue(at<bool>(address, it->offset));
+          break;
+        case Opcode::INT_TO_LONG:
+          promote<int32_t, int64_t>(reader, address, it->offset);
+          break;
+        case Opcode::INT_TO_FLOAT:
+          promote<int32_t, float>(reader, address, it->offset);
+          break;
+        case Opcode::INT_TO_DOUBLE:
+          promote<int32_t, double>(reader, address, it->offset);
+          break;
+        case Opcode::LONG_TO_FLOAT:
+          promote<int64_t, float>(reader, address, it->offset);
+          break;
+        case Opcode::LONG_TO_DOUBLE:
+          promote<int64_t, double>(reader, address, it->offset);
+          break;
+        case Opcode::FLOAT_TO_DOUBLE:
+          promote<float, double>(reader, address, it->offset);
+          break;
+        case Opcode::SKIP_BYTES:
+          reader.skipBytes(it->offset);
+          break;
+        case Opcode::SKIP_VARINTS:
+          reader.skipVarInts(it->offset);
+          break;
+        case Opcode::SKIP_LENGTH_PREFIXED:
+          reader.skipLengthPrefixed(it->offset);
+          break;
+      }
+    }
+  }
+
+  void ResolverProgram::parseBatch(Reader &reader, uint8_t *address, size_t stride, size_t n) const {
+    const Op *begin = ops_.data();
+    const Op *end = begin + ops_.size();
+    for (size_t i = 0; i < n; ++i, address += stride) {
+      parseOps(reader, address, begin, end);
+    }
+  }
+
   Resolver *constructResolver(const ValidSchema &writerSchema,
     const ValidSchema &readerSchema,
     const Layout &readerLayout) {
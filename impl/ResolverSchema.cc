@@ -27,12 +27,18 @@ namespace avro {
     const ValidSchema &writerSchema,
     const ValidSchema &readerSchema,
     const Layout &readerLayout) :
-  resolver_(constructResolver(writerSchema, readerSchema, readerLayout)) {
+  resolver_(constructResolver(writerSchema, readerSchema, readerLayout)),
+  program_(std::make_shared<ResolverProgram>(*resolver_)) {
   }
 
   void
   ResolverSchema::parse(Reader &reader, uint8_t *address) {
-    resolver_->parse(reader, address);
+    program_->parse(reader, address);
+  }
+
+  void
+  ResolverSchema::parseBatch(Reader &reader, uint8_t *address, size_t stride, size_t n) {
+    program_->parseBatch(reader, address, stride, n);
   }
 
 }
@@ -0,0 +1,627 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstring>
+#include <limits>
+#include "ResumableDecoder.hh"
+#include "Generic.hh"
+#include "NodeImpl.hh"
+#include "Zigzag.hh"
+
+namespace avro {
+
+  namespace {
+
+    using detail::DecodeSlot;
+    using detail::DecodeSlots;
+
+    /* The datum a GenericDatum slot is for, found through the record fields on the way from the base.*/
+    GenericDatum& genericValue(void* base, const std::vector<size_t>& path) {
+      GenericDatum* d = static_cast<GenericDatum*> (base);
+      for (size_t i : path) {
+        d = &d->value<GenericRecord>().fieldAt(i);
+      }
+      return *d;
+    }
+
+    Type resolvedType(const NodePtr& n) {
+      return n->type() == Type::AVRO_SYMBOLIC ? resolveSymbol(n)->type() : n->type();
+    }
+
+    class GenericValueSlot : public DecodeSlot {
+    public:
+
+      GenericValueSlot(const std::vector<size_t>& path, Type type) : path_(path), type_(type) { }
+
+      void set(void* base, const void* value) {
+        GenericDatum& d = genericValue(base, path_);
+        switch (type_) {
+          case Type::AVRO_BOOL:
+            d.value<bool>() = *static_cast<const bool*> (value);
+            break;
+          case Type::AVRO_INT:
+            d.value<int32_t>() = *static_cast<const int32_t*> (value);
+            break;
+          case Type::AVRO_LONG:
+            d.value<int64_t>() = *static_cast<const int64_t*> (value);
+            break;
+          case Type::AVRO_FLOAT:
+            d.value<float>() = *static_cast<const float*> (value);
+            break;
+          case Type::AVRO_DOUBLE:
+            d.value<double>() = *static_cast<const double*> (value);
+            break;
+          default:
+            break;
+        }
+      }
+
+      uint8_t* resize(void* base, size_t len) {
+        GenericDatum& d = genericValue(base, path_);
+        if (type_ == Type::AVRO_STRING) {
+          std::string& s = d.value<std::string>();
+          s.resize(len);
+          return reinterpret_cast<uint8_t*> (s.data());
+        }
+        std::vector<uint8_t>& b = d.value<std::vector<uint8_t> >();
+        b.resize(len);
+        return b.data();
+      }
+
+    private:
+      const std::vector<size_t> path_;
+      const Type type_;
+    };
+
+    /* Items of the right type left from an earlier decode are decoded into, as GenericReader does.*/
+    class GenericArraySlot : public DecodeSlot {
+    public:
+
+      GenericArraySlot(const std::vector<size_t>& path, const NodePtr& item) :
+      path_(path), item_(item), itemType_(resolvedType(item)) { }
+
+      void reserve(void* base, size_t used, size_t count) {
+        detail::reserveItems(items(base), used, count);
+      }
+
+      void* item(void* base, size_t index) {
+        GenericArray::Value& r = items(base);
+        if (index == r.size()) {
+          r.push_back(GenericDatum(item_));
+        } else if (r[index].type() != itemType_) {
+          r[index] = GenericDatum(item_);
+        }
+        return &r[index];
+      }
+
+      void end(void* base, size_t used) {
+        GenericArray::Value& r = items(base);
+        r.erase(r.begin() + used, r.end());
+      }
+
+    private:
+
+      GenericArray::Value& items(void* base) {
+        return genericValue(base, path_).value<GenericArray>().value();
+      }
+
+      const std::vector<size_t> path_;
+      const NodePtr item_;
+      const Type itemType_;
+    };
+
+    class GenericMapSlot : public DecodeSlot {
+    public:
+
+      GenericMapSlot(const std::vector<size_t>& path, const NodePtr& item) :
+      path_(path), item_(item), itemType_(resolvedType(item)) { }
+
+      void reserve(void* base, size_t used, size_t count) {
+        detail::reserveItems(entries(base), used, count);
+      }
+
+      void startKey(void* base, size_t index) {
+        GenericMap::Value& r = entries(base);
+        if (index == r.size()) {
+          r.push_back(std::make_pair(std::string(), GenericDatum(item_)));
+        } else if (r[index].second.type() != itemType_) {
+          r[index].second = GenericDatum(item_);
+        }
+      }
+
+      uint8_t* key(void* base, size_t index, size_t len) {
+        std::string& k = entries(base)[index].first;
+        k.resize(len);
+        return reinterpret_cast<uint8_t*> (k.data());
+      }
+
+      void* item(void* base, size_t index) {
+        return &entries(base)[index].second;
+      }
+
+      void end(void* base, size_t used) {
+        GenericMap::Value& r = entries(base);
+        r.erase(r.begin() + used, r.end());
+      }
+
+    private:
+
+      GenericMap::Value& entries(void* base) {
+        return genericValue(base, path_).value<GenericMap>().value();
+      }
+
+      const std::vector<size_t> path_;
+      const NodePtr item_;
+      const Type itemType_;
+    };
+
+    /* Adds the slots of the ops of n, in the order CompiledSchema compiles them.  Path holds the fields from the base to n.*/
+    void addGenericSlots(DecodeSlots& slots, const NodePtr& n, std::vector<size_t>& path) {
+      NodePtr node = (n->type() == Type::AVRO_SYMBOLIC) ? resolveSymbol(n) : n;
+      std::vector<size_t> itemPath;
+      switch (node->type()) {
+        case Type::AVRO_RECORD:
+          for (size_t i = 0; i < node->leaves(); ++i) {
+            path.push_back(i);
+            addGenericSlots(slots, node->leafAt(i), path);
+            path.pop_back();
+          }
+          break;
+        case Type::AVRO_ARRAY:
+          slots.emplace_back(new GenericArraySlot(path, node->leafAt(0)));
+          addGenericSlots(slots, node->leafAt(0), itemPath);
+          break;
+        case Type::AVRO_MAP:
+          slots.emplace_back(new GenericMapSlot(path, node->leafAt(1)));
+          slots.emplace_back(new DecodeSlot());
+          addGenericSlots(slots, node->leafAt(1), itemPath);
+          break;
+        default:
+          slots.emplace_back(new GenericValueSlot(path, node->type()));
+          break;
+      }
+    }
+
+  }
+
+  namespace detail {
+
+    void checkSlot(const DecodeSlots& slots, const CompiledSchema& program, Type type) {
+      if (slots.size() >= program.ops().size()) {
+        throw Exception(boost::format("The schema has no value for a %1% of the type decoded into") % type);
+      }
+      if (program.ops()[slots.size()].type != type) {
+        throw Exception(boost::format("The schema has a %1% where the type decoded into has a %2%") %
+          program.ops()[slots.size()].type % type);
+      }
+    }
+
+    void checkSlots(const DecodeSlots& slots, const CompiledSchema& program, size_t end) {
+      if (slots.size() < end) {
+        throw Exception(boost::format("The type decoded into has no value for the %1% of the schema") % program.ops()[slots.size()].type);
+      } else if (slots.size() > end) {
+        throw Exception("The type decoded into has more values than the schema");
+      }
+    }
+
+  }
+
+  DatumScanner::DatumScanner(const ValidSchema& schema) :
+  program_(schema), op_(0), state_(State::START), varint_(0), shift_(0), remaining_(0) {
+  }
+
+  DatumScanner::DatumScanner(const CompiledSchema& program) :
+  program_(program), op_(0), state_(State::START), varint_(0), shift_(0), remaining_(0) {
+  }
+
+  size_t DatumScanner::scan(const uint8_t* data, size_t len) {
+    const std::vector<CompiledSchema::Op>& ops = program_.ops();
+    size_t i = 0;
+    for (;;) {
+      switch (state_) {
+        case State::START:
+          if (!blocks_.empty() && op_ == ops[blocks_.back().op].end) {
+            // the end of an item
+            Block& b = blocks_.back();
+            if (--b.count) {
+              op_ = b.op + 1;
+            } else {
+              op_ = b.op;
+              blocks_.pop_back();
+              state_ = State::COUNT;
+              varint_ = 0;
+              shift_ = 0;
+            }
+            continue;
+          }
+          if (op_ == ops.size()) {
+            return i;
+          }
+          switch (ops[op_].type) {
+            case Type::AVRO_NULL:
+              ++op_;
+              continue;
+            case Type::AVRO_BOOL:
+              remaining_ = 1;
+              state_ = State::FIXED;
+              break;
+            case Type::AVRO_FLOAT:
+              remaining_ = sizeof (float);
+              state_ = State::FIXED;
+              break;
+            case Type::AVRO_DOUBLE:
+              remaining_ = sizeof (double);
+              state_ = State::FIXED;
+              break;
+            case Type::AVRO_INT:
+            case Type::AVRO_LONG:
+              state_ = State::VARINT;
+              break;
+            case Type::AVRO_STRING:
+            case Type::AVRO_BYTES:
+              state_ = State::LENGTH;
+              break;
+            case Type::AVRO_ARRAY:
+            case Type::AVRO_MAP:
+              state_ = State::COUNT;
+              break;
+            default:
+              throw Exception(boost::format("Cannot scan values of type %1%") % ops[op_].type);
+          }
+          varint_ = 0;
+          shift_ = 0;
+          break;
+        case State::VARINT:
+        case State::LENGTH:
+        case State::COUNT:
+        case State::BLOCK_SIZE:
+        {
+          bool done = false;
+          while (!done && i < len) {
+            uint8_t b = data[i++];
+            if (shift_ > 63) {
+              throw Exception("Invalid variable length integer");
+            }
+            varint_ |= static_cast<uint64_t> (b & 0x7f) << shift_;
+            shift_ += 7;
+            done = !(b & 0x80);
+          }
+          if (!done) {
+            return i;
+          }
+          int64_t n = decodeZigzag64(varint_);
+          varint_ = 0;
+          shift_ = 0;
+          if (state_ == State::LENGTH || state_ == State::BLOCK_SIZE) {
+            if (n < 0) {
+              throw Exception(boost::format("Invalid length: %1%") % n);
+            }
+            remaining_ = n;
+            state_ = (state_ == State::LENGTH) ? State::FIXED : State::SKIP_BLOCK;
+          } else if (state_ == State::COUNT) {
+            if (n == 0) {
+              op_ = ops[op_].end;
+              state_ = State::START;
+            } else if (n < 0) {
+              // the block says how many bytes it takes, so its items need not be looked at
+              state_ = State::BLOCK_SIZE;
+            } else {
+              Block b = { op_, static_cast<uint64_t> (n) };
+              blocks_.push_back(b);
+              ++op_;
+              state_ = State::START;
+            }
+          } else {
+            state_ = State::START;
+            ++op_;
+          }
+          break;
+        }
+        case State::FIXED:
+        case State::SKIP_BLOCK:
+        {
+          size_t n = std::min<uint64_t>(remaining_, len - i);
+          i += n;
+          remaining_ -= n;
+          if (remaining_) {
+            return i;
+          }
+          if (state_ == State::SKIP_BLOCK) {
+            state_ = State::COUNT;
+          } else {
+            state_ = State::START;
+            ++op_;
+          }
+          break;
+        }
+      }
+    }
+  }
+
+  ResumableDecoder::ResumableDecoder(const ValidSchema& schema) :
+  schema_(schema), program_(schema), slotsType_(0), root_(0), partialBytes_(0), op_(0), state_(State::START), varint_(0), shift_(0),
+  remaining_(0), blockCount_(0), length_(0), sized_(0), payload_(0), filled_(0) {
+  }
+
+  DecodeStatus ResumableDecoder::decode(const uint8_t* data, size_t len, size_t& consumed, GenericDatum& value) {
+    if (slotsType_ != &typeid (GenericDatum)) {
+      startSlots();
+      std::vector<size_t> path;
+      addGenericSlots(slots_, schema_.root(), path);
+      detail::checkSlots(slots_, program_, program_.ops().size());
+      slotsType_ = &typeid (GenericDatum);
+    }
+    Type type = resolvedType(schema_.root());
+    if (value.type() != type) {
+      throw Exception(boost::format("Cannot decode a %1% into a GenericDatum of type %2%") % type % value.type());
+    }
+    return resume(data, len, consumed, &value);
+  }
+
+  void ResumableDecoder::reset() {
+    root_ = 0;
+    partialBytes_ = 0;
+    op_ = 0;
+    frames_.clear();
+    state_ = State::START;
+  }
+
+  void ResumableDecoder::startSlots() {
+    if (inDatum()) {
+      throw Exception("Cannot decode into a value of another type within a datum");
+    }
+    slots_.clear();
+    slotsType_ = 0;
+  }
+
+  DecodeStatus ResumableDecoder::resume(const uint8_t* data, size_t len, size_t& consumed, void* root) {
+    if (!inDatum()) {
+      root_ = root;
+    } else if (root != root_) {
+      throw Exception("A datum must be decoded into the same value until it is ready");
+    }
+    size_t i = 0;
+    bool done;
+    try {
+      done = run(data, len, i);
+    } catch (...) {
+      reset();
+      throw;
+    }
+    consumed = i;
+    if (!done) {
+      partialBytes_ += i;
+      return DecodeStatus::NEED_MORE_DATA;
+    }
+    reset();
+    return DecodeStatus::DATUM_READY;
+  }
+
+  bool ResumableDecoder::isKey() const {
+    return !frames_.empty() && op_ == frames_.back().op + 1 && program_.ops()[frames_.back().op].type == Type::AVRO_MAP;
+  }
+
+  void ResumableDecoder::sizePayload(size_t size) {
+    if (isKey()) {
+      const Frame& f = frames_.back();
+      payload_ = slots_[f.op]->key(f.base, f.used, size);
+    } else {
+      payload_ = slots_[op_]->resize(base(), size);
+    }
+    sized_ = size;
+  }
+
+  void ResumableDecoder::startItems(uint64_t count) {
+    Frame& f = frames_.back();
+    slots_[f.op]->reserve(f.base, f.used, count);
+    f.count = count;
+    op_ = f.op + 1;
+    if (program_.ops()[f.op].type == Type::AVRO_ARRAY) {
+      f.item = slots_[f.op]->item(f.base, f.used);
+    }
+    state_ = State::START;
+  }
+
+  bool ResumableDecoder::run(const uint8_t* data, size_t len, size_t& i) {
+    const std::vector<CompiledSchema::Op>& ops = program_.ops();
+    for (;;) {
+      switch (state_) {
+        case State::START:
+          if (!frames_.empty() && op_ == ops[frames_.back().op].end) {
+            // the end of an item
+            Frame& f = frames_.back();
+            ++f.used;
+            if (--f.count) {
+              op_ = f.op + 1;
+              if (ops[f.op].type == Type::AVRO_ARRAY) {
+                f.item = slots_[f.op]->item(f.base, f.used);
+              }
+            } else {
+              op_ = f.op;
+              state_ = State::COUNT;
+            }
+            continue;
+          }
+          if (op_ == ops.size()) {
+            return true;
+          }
+          switch (ops[op_].type) {
+            case Type::AVRO_NULL:
+              ++op_;
+              continue;
+            case Type::AVRO_BOOL:
+              remaining_ = 1;
+              state_ = State::FIXED;
+              break;
+            case Type::AVRO_FLOAT:
+              remaining_ = sizeof (float);
+              state_ = State::FIXED;
+              break;
+            case Type::AVRO_DOUBLE:
+              remaining_ = sizeof (double);
+              state_ = State::FIXED;
+              break;
+            case Type::AVRO_INT:
+            case Type::AVRO_LONG:
+              state_ = State::VARINT;
+              break;
+            case Type::AVRO_STRING:
+            case Type::AVRO_BYTES:
+              state_ = State::LENGTH;
+              break;
+            case Type::AVRO_ARRAY:
+            case Type::AVRO_MAP:
+            {
+              Frame f = { op_, base(), 0, 0, 0 };
+              slots_[op_]->start(f.base);
+              frames_.push_back(f);
+              state_ = State::COUNT;
+              break;
+            }
+            default:
+              throw Exception(boost::format("Cannot decode values of type %1%") % ops[op_].type);
+          }
+          varint_ = 0;
+          shift_ = 0;
+          filled_ = 0;
+          break;
+        case State::VARINT:
+        case State::LENGTH:
+        case State::COUNT:
+        case State::BLOCK_SIZE:
+        {
+          bool done = false;
+          while (!done && i < len) {
+            uint8_t b = data[i++];
+            if (shift_ > 63) {
+              throw Exception("Invalid variable length integer");
+            }
+            varint_ |= static_cast<uint64_t> (b & 0x7f) << shift_;
+            shift_ += 7;
+            done = !(b & 0x80);
+          }
+          if (!done) {
+            return false;
+          }
+          int64_t n = decodeZigzag64(varint_);
+          varint_ = 0;
+          shift_ = 0;
+          if (state_ == State::VARINT) {
+            if (ops[op_].type == Type::AVRO_INT) {
+              if (n < std::numeric_limits<int32_t>::min() || n > std::numeric_limits<int32_t>::max()) {
+                throw Exception(boost::format("Value out of range for Avro int: %1%") % n);
+              }
+              int32_t v = static_cast<int32_t> (n);
+              slots_[op_]->set(base(), &v);
+            } else {
+              slots_[op_]->set(base(), &n);
+            }
+            ++op_;
+            state_ = State::START;
+          } else if (state_ == State::LENGTH) {
+            if (n < 0) {
+              throw Exception(boost::format("Invalid length: %1%") % n);
+            }
+            if (isKey()) {
+              const Frame& f = frames_.back();
+              slots_[f.op]->startKey(f.base, f.used);
+            }
+            // the length is only a claim of the input, which may be corrupt, so beyond a limit the value grows as the bytes arrive
+            length_ = n;
+            sizePayload(std::min<uint64_t>(length_, detail::kMaxPresizeBytes));
+            remaining_ = n;
+            state_ = State::PAYLOAD;
+          } else if (state_ == State::COUNT) {
+            if (n == 0) {
+              const Frame& f = frames_.back();
+              slots_[f.op]->end(f.base, f.used);
+              op_ = ops[f.op].end;
+              frames_.pop_back();
+              state_ = State::START;
+            } else if (n < 0) {
+              // the items are decoded all the same, the size of the block that follows is of no use
+              blockCount_ = -static_cast<uint64_t> (n);
+              state_ = State::BLOCK_SIZE;
+            } else {
+              startItems(n);
+            }
+          } else {
+            if (n < 0) {
+              throw Exception(boost::format("Invalid length: %1%") % n);
+            }
+            startItems(blockCount_);
+          }
+          break;
+        }
+        case State::FIXED:
+        {
+          size_t n = std::min<uint64_t>(remaining_, len - i);
+          ::memcpy(fixed_ + filled_, data + i, n);
+          i += n;
+          filled_ += n;
+          remaining_ -= n;
+          if (remaining_) {
+            return false;
+          }
+          if (ops[op_].type == Type::AVRO_BOOL) {
+            if (fixed_[0] > 1) {
+              throw Exception("Invalid value for bool");
+            }
+            bool v = fixed_[0] != 0;
+            slots_[op_]->set(base(), &v);
+          } else if (ops[op_].type == Type::AVRO_FLOAT) {
+            float v;
+            ::memcpy(&v, fixed_, sizeof (v));
+            slots_[op_]->set(base(), &v);
+          } else {
+            double v;
+            ::memcpy(&v, fixed_, sizeof (v));
+            slots_[op_]->set(base(), &v);
+          }
+          ++op_;
+          state_ = State::START;
+          break;
+        }
+        case State::PAYLOAD:
+        {
+          size_t n = std::min<uint64_t>(remaining_, len - i);
+          if (n) {
+            size_t done = length_ - remaining_;
+            if (done + n > sized_) {
+              sizePayload(std::min<uint64_t>(length_, std::max<uint64_t>(done + n, 2 * sized_)));
+            }
+            ::memcpy(payload_ + done, data + i, n);
+            i += n;
+            remaining_ -= n;
+          }
+          if (remaining_) {
+            return false;
+          }
+          if (isKey()) {
+            Frame& f = frames_.back();
+            f.item = slots_[f.op]->item(f.base, f.used);
+          }
+          ++op_;
+          state_ = State::START;
+          break;
+        }
+      }
+    }
+  }
+
+} // namespace avro
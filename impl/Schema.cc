@@ -47,7 +47,23 @@ namespace avro {
     node_->addName(name);
 
     node_->addLeaf(fieldSchema.root());
-  }  
+  }
+
+  void
+  RecordSchema::addField(const std::string &name, const Schema &fieldSchema, FieldOrder order) {
+    addField(name, fieldSchema);
+    static_cast<NodeRecord &> (*node_).setFieldOrder(node_->leaves() - 1, order);
+  }
+
+  ArraySchema::ArraySchema(const Schema &itemsSchema) :
+  Schema(new NodeArray) {
+    node_->addLeaf(itemsSchema.root());
+  }
+
+  MapSchema::MapSchema(const Schema &valuesSchema) :
+  Schema(new NodeMap) {
+    node_->addLeaf(valuesSchema.root());
+  }
 
   SymbolicSchema::SymbolicSchema(const Name &name, const NodePtr& link) :
   Schema(new NodeSymbolic(HasName(name), link)) {
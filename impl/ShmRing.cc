@@ -0,0 +1,317 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <atomic>
+#include <cstring>
+#include <thread>
+#include <new>
+#include "ShmRing.hh"
+#include "unistd.h"
+#include "fcntl.h"
+#include "errno.h"
+#include "sys/mman.h"
+#include "sys/stat.h"
+#include "sys/syscall.h"
+#include "linux/futex.h"
+
+namespace avro {
+
+  /* The control block at the start of the shared memory object.  The producer and consumer counters live on separate cache lines.*/
+  struct ShmRingHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t capacity;
+
+    alignas(64) std::atomic<uint64_t> head; // end of the published records
+    std::atomic<uint32_t> headSeq; // bumped on every publication, the consumer sleeps on it
+    std::atomic<uint32_t> consumerWaiting;
+    std::atomic<uint32_t> closed;
+
+    alignas(64) std::atomic<uint64_t> tail; // start of the records not yet released by the consumer
+    std::atomic<uint32_t> tailSeq; // bumped on every release, the producer sleeps on it
+    std::atomic<uint32_t> producerWaiting;
+  };
+
+  namespace {
+
+    const uint32_t kMagic = 0x41767253; // "AvrS"
+    const uint32_t kWrapMarker = 0xffffffff;
+    const uint64_t kLengthSize = sizeof (uint32_t);
+    const size_t kDataOffset = (sizeof (ShmRingHeader) + 63) & ~static_cast<size_t> (63);
+    const int kSpins = 64;
+
+    uint64_t align(uint64_t pos) {
+      return (pos + kLengthSize - 1) & ~(kLengthSize - 1);
+    }
+
+    uint8_t* mapRing(int fd, size_t size) {
+      void* p = ::mmap(0, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+      if (p == MAP_FAILED) {
+        int err = errno;
+        ::close(fd);
+        throw Exception(boost::format("Cannot map shared memory: %1%") % ::strerror(err));
+      }
+      ::close(fd);
+      return static_cast<uint8_t*> (p);
+    }
+
+    void futexWait(std::atomic<uint32_t>& word, uint32_t expected) {
+      ::syscall(SYS_futex, reinterpret_cast<uint32_t*> (&word), FUTEX_WAIT, expected, 0, 0, 0);
+    }
+
+    void futexWake(std::atomic<uint32_t>& word) {
+      ::syscall(SYS_futex, reinterpret_cast<uint32_t*> (&word), FUTEX_WAKE, 1, 0, 0, 0);
+    }
+
+    /* Waits until ready() holds, first spinning briefly and then sleeping on seq.  The waiting flag is raised before seq is sampled and
+       ready() checked again, so a counterpart that changes the state, then bumps seq and then checks the flag can never miss us.*/
+    template <typename Ready>
+    void waitUntil(Ready ready, std::atomic<uint32_t>& seq, std::atomic<uint32_t>& waiting) {
+      for (int i = 0; i < kSpins; ++i) {
+        if (ready()) {
+          return;
+        }
+        std::this_thread::yield();
+      }
+      while (!ready()) {
+        waiting.store(1);
+        uint32_t s = seq.load();
+        if (!ready()) {
+          futexWait(seq, s);
+        }
+        waiting.store(0);
+      }
+    }
+
+    void signal(std::atomic<uint32_t>& seq, std::atomic<uint32_t>& waiting) {
+      seq.fetch_add(1);
+      if (waiting.load()) {
+        futexWake(seq);
+      }
+    }
+
+  }
+
+  ShmOutputStream::ShmOutputStream(const char* name, size_t capacity) :
+  name_(name), header_(0), data_(0), capacity_(align(capacity)),
+  recordStart_(0), lapEnd_(0), next_(0), byteCount_(0), closed_(false) {
+    if (capacity_ < 4 * kLengthSize) {
+      throw Exception(boost::format("Shared memory ring capacity too small: %1%") % capacity);
+    }
+    int fd = ::shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd < 0) {
+      throw Exception(boost::format("Cannot create shared memory %1%: %2%") % name % ::strerror(errno));
+    }
+    if (::ftruncate(fd, kDataOffset + capacity_) < 0) {
+      int err = errno;
+      ::close(fd);
+      ::shm_unlink(name);
+      throw Exception(boost::format("Cannot size shared memory %1%: %2%") % name % ::strerror(err));
+    }
+    uint8_t* base;
+    try {
+      base = mapRing(fd, kDataOffset + capacity_);
+    } catch (...) {
+      ::shm_unlink(name);
+      throw;
+    }
+
+    header_ = new (base) ShmRingHeader();
+    header_->version = 1;
+    header_->capacity = capacity_;
+    data_ = base + kDataOffset;
+    std::atomic_thread_fence(std::memory_order_release);
+    header_->magic = kMagic;
+    startRecord(0);
+  }
+
+  ShmOutputStream::~ShmOutputStream() {
+    close();
+    ::munmap(header_, kDataOffset + capacity_);
+    ::shm_unlink(name_.c_str());
+  }
+
+  void ShmOutputStream::startRecord(uint64_t pos) {
+    recordStart_ = pos;
+    lapEnd_ = pos - pos % capacity_ + capacity_;
+    next_ = pos + kLengthSize;
+  }
+
+  void ShmOutputStream::waitForSpace() {
+    uint64_t tail = header_->tail.load(std::memory_order_relaxed);
+    waitUntil([this, tail]() {
+      return header_->tail.load(std::memory_order_acquire) != tail;
+    }, header_->tailSeq, header_->producerWaiting);
+  }
+
+  /* Moves the record being written, which has reached the end of the ring, to the start of the ring, leaving a wrap marker behind.*/
+  void ShmOutputStream::relocateRecord() {
+    uint64_t written = next_ - recordStart_;
+    uint64_t index = recordStart_ % capacity_;
+    if (written > index) {
+      throw Exception(boost::format("Record of more than %1% bytes does not fit in a shared memory ring of %2% bytes")
+        % (written - kLengthSize) % capacity_);
+    }
+    while (header_->tail.load(std::memory_order_acquire) + capacity_ < lapEnd_ + written) {
+      waitForSpace();
+    }
+    std::memcpy(data_ + kLengthSize, data_ + index + kLengthSize, written - kLengthSize);
+    std::memcpy(data_ + index, &kWrapMarker, kLengthSize);
+    startRecord(lapEnd_);
+    next_ += written - kLengthSize;
+  }
+
+  bool ShmOutputStream::next(uint8_t** data, size_t* len) {
+    if (closed_) {
+      throw Exception("Shared memory ring is closed");
+    }
+    for (;;) {
+      uint64_t end = std::min(lapEnd_, header_->tail.load(std::memory_order_acquire) + capacity_);
+      if (next_ < end) {
+        *data = data_ + next_ % capacity_;
+        *len = end - next_;
+        byteCount_ += *len;
+        next_ = end;
+        return true;
+      } else if (next_ == lapEnd_) {
+        relocateRecord();
+      } else {
+        waitForSpace();
+      }
+    }
+  }
+
+  void ShmOutputStream::backup(size_t len) {
+    next_ -= len;
+    byteCount_ -= len;
+  }
+
+  uint64_t ShmOutputStream::byteCount() const {
+    return byteCount_;
+  }
+
+  void ShmOutputStream::flush() {
+    uint64_t size = next_ - recordStart_ - kLengthSize;
+    if (size == 0) {
+      return;
+    }
+    uint32_t length = static_cast<uint32_t> (size);
+    std::memcpy(data_ + recordStart_ % capacity_, &length, kLengthSize);
+    uint64_t head = align(next_);
+    header_->head.store(head, std::memory_order_release);
+    signal(header_->headSeq, header_->consumerWaiting);
+    startRecord(head);
+  }
+
+  void ShmOutputStream::close() {
+    if (!closed_) {
+      flush();
+      closed_ = true;
+      header_->closed.store(1, std::memory_order_release);
+      signal(header_->headSeq, header_->consumerWaiting);
+    }
+  }
+
+  ShmInputStream::ShmInputStream(const char* name) :
+  header_(0), data_(0), capacity_(0), tail_(0), recordEnd_(0),
+  record_(0), recordSize_(0), offset_(0), byteCount_(0) {
+    int fd = ::shm_open(name, O_RDWR, 0);
+    if (fd < 0) {
+      throw Exception(boost::format("Cannot open shared memory %1%: %2%") % name % ::strerror(errno));
+    }
+    struct stat st;
+    if (::fstat(fd, &st) < 0 || static_cast<size_t> (st.st_size) < kDataOffset) {
+      ::close(fd);
+      throw Exception(boost::format("Not a shared memory ring: %1%") % name);
+    }
+    uint8_t* base = mapRing(fd, st.st_size);
+    header_ = reinterpret_cast<ShmRingHeader*> (base);
+    if (header_->magic != kMagic || kDataOffset + header_->capacity != static_cast<size_t> (st.st_size)) {
+      ::munmap(base, st.st_size);
+      throw Exception(boost::format("Not a shared memory ring: %1%") % name);
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    capacity_ = header_->capacity;
+    data_ = base + kDataOffset;
+    tail_ = recordEnd_ = header_->tail.load(std::memory_order_acquire);
+  }
+
+  ShmInputStream::~ShmInputStream() {
+    ::munmap(header_, kDataOffset + capacity_);
+  }
+
+  bool ShmInputStream::nextRecord() {
+    if (tail_ != recordEnd_) {
+      tail_ = recordEnd_;
+      header_->tail.store(tail_, std::memory_order_release);
+      signal(header_->tailSeq, header_->producerWaiting);
+    }
+    record_ = 0;
+    recordSize_ = offset_ = 0;
+
+    for (;;) {
+      uint64_t tail = tail_;
+      waitUntil([this, tail]() {
+        return header_->head.load(std::memory_order_acquire) != tail ||
+          header_->closed.load(std::memory_order_acquire);
+      }, header_->headSeq, header_->consumerWaiting);
+      if (header_->head.load(std::memory_order_acquire) == tail_) {
+        return false;
+      }
+
+      uint32_t length;
+      std::memcpy(&length, data_ + tail_ % capacity_, kLengthSize);
+      if (length != kWrapMarker) {
+        record_ = data_ + tail_ % capacity_ + kLengthSize;
+        recordSize_ = length;
+        recordEnd_ = align(tail_ + kLengthSize + length);
+        return true;
+      }
+      tail_ = tail_ - tail_ % capacity_ + capacity_;
+      recordEnd_ = tail_;
+    }
+  }
+
+  bool ShmInputStream::next(const uint8_t** data, size_t* len) {
+    if (offset_ == recordSize_) {
+      return false;
+    }
+    *data = record_ + offset_;
+    *len = recordSize_ - offset_;
+    byteCount_ += *len;
+    offset_ = recordSize_;
+    return true;
+  }
+
+  void ShmInputStream::backup(size_t len) {
+    len = std::min(len, offset_);
+    offset_ -= len;
+    byteCount_ -= len;
+  }
+
+  void ShmInputStream::skip(size_t len) {
+    len = std::min(len, recordSize_ - offset_);
+    offset_ += len;
+    byteCount_ += len;
+  }
+
+  size_t ShmInputStream::byteCount() const {
+    return byteCount_;
+  }
+
+} // namespace avro
@@ -21,24 +21,28 @@
 
 namespace avro {
 
-  using std::vector;
-
-  class MemoryInputStream : public InputStream {
-    const std::vector<uint8_t*>& m_data;
-    const size_t m_chunk_size;
+  /* Reads the chunks of a MemoryOutputStream in place.*/
+  class MemoryChunkInputStream : public InputStream {
+    const std::vector<MemoryOutputStream::Chunk>& m_data;
     const size_t m_size;
     const size_t m_available;
     size_t m_cur;
     size_t m_cur_len;
+    size_t m_consumed; // bytes in the chunks before m_cur
+
+    size_t chunkLen(size_t i) const {
+      return (i == (m_size - 1)) ? m_available : m_data[i].used;
+    }
 
     size_t maxLen() {
-      size_t n = (m_cur == (m_size - 1)) ? m_available : m_chunk_size;
+      size_t n = chunkLen(m_cur);
       if (n == m_cur_len) {
         if (m_cur == (m_size - 1)) {
           return 0;
         }
+        m_consumed += n;
         ++m_cur;
-        n = (m_cur == (m_size - 1)) ? m_available : m_chunk_size;
+        n = chunkLen(m_cur);
         m_cur_len = 0;
       }
       return n;
@@ -46,15 +50,14 @@ namespace avro {
 
   public:
 
-    MemoryInputStream(const std::vector<uint8_t*>& b,
-      size_t chunkSize, size_t available) :
-    m_data(b), m_chunk_size(chunkSize), m_size(b.size()),
-    m_available(available), m_cur(0), m_cur_len(0) {
+    MemoryChunkInputStream(const std::vector<MemoryOutputStream::Chunk>& b, size_t size, size_t available) :
+    m_data(b), m_size(size),
+    m_available(available), m_cur(0), m_cur_len(0), m_consumed(0) {
     }
 
     bool next(const uint8_t** data, size_t* len) override {
       if (size_t n = maxLen()) {
-        *data = m_data[m_cur] + m_cur_len;
+        *data = m_data[m_cur].data + m_cur_len;
         *len = n - m_cur_len;
         m_cur_len = n;
         return true;
@@ -81,120 +84,148 @@ namespace avro {
     }
 
     size_t byteCount() const override {
-      return m_cur * m_chunk_size + m_cur_len;
+      return m_consumed + m_cur_len;
     }
   };
 
-  class MemoryInputStream2 : public InputStream {
-    const uint8_t * const m_data;
-    const size_t m_size;
-    size_t m_cur_len;
-  public:
-
-    MemoryInputStream2(const uint8_t *data, size_t len)
-    : m_data(data), m_size(len), m_cur_len(0) {
-    }
+  MemoryOutputStream::MemoryOutputStream(size_t chunkSize, size_t maxChunkSize) : m_chunk_size(chunkSize),
+  m_max_chunk_size(std::max(chunkSize, maxChunkSize)), m_next_chunk_size(chunkSize),
+  m_count(0), m_available(0), m_byte_count(0) {
+  }
 
-    bool next(const uint8_t** data, size_t* len) override {
-      if (m_cur_len == m_size) {
-        return false;
-      }
-      *data = &m_data[m_cur_len];
-      *len = m_size - m_cur_len;
-      m_cur_len = m_size;
-      return true;
+  MemoryOutputStream::~MemoryOutputStream() {
+    for (std::vector<Chunk>::const_iterator it = m_data.begin();
+      it != m_data.end(); ++it) {
+      delete[] it->data;
     }
+  }
 
-    void backup(size_t len) override {
-      m_cur_len -= len;
-    }
+  void MemoryOutputStream::reset() {
+    m_count = 0;
+    m_available = 0;
+    m_byte_count = 0;
+    m_next_chunk_size = m_chunk_size;
+  }
 
-    void skip(size_t len) override {
-      if (len > (m_size - m_cur_len)) {
-        len = m_size - m_cur_len;
+  /* Moves on to the next chunk, which holds at least minSize bytes and at least the next size in the growth sequence if it is a new one.  
+     The current chunk is written over if nothing has been written into it yet.*/
+  void MemoryOutputStream::nextChunk(size_t minSize) {
+    if (m_count != 0) {
+      Chunk& last = m_data[m_count - 1];
+      last.used = last.capacity - m_available;
+      if (last.used == 0) {
+        --m_count;
       }
-      m_cur_len += len;
     }
+    if (m_count == m_data.size()) {
+      size_t n = std::max(minSize, m_next_chunk_size);
+      Chunk c = { new uint8_t[n], n, 0 };
+      m_data.push_back(c);
+    } else if (m_data[m_count].capacity < minSize) {
+      delete[] m_data[m_count].data;
+      m_data[m_count].data = 0;
+      m_data[m_count].data = new uint8_t[minSize];
+      m_data[m_count].capacity = minSize;
+    }
+    m_available = m_data[m_count++].capacity;
+    m_next_chunk_size = std::min(m_next_chunk_size * 2, m_max_chunk_size);
+  }
 
-    size_t byteCount() const override {
-      return m_cur_len;
+  void MemoryOutputStream::reserve(size_t size) {
+    if (m_available < size) {
+      nextChunk(size);
     }
-  };
-
-  class MemoryOutputStream : public OutputStream {
-  public:
-    const size_t m_chunk_size;
-    std::vector<uint8_t*> m_data;
-    size_t m_available;
-    size_t m_byte_count;
+  }
 
-    MemoryOutputStream(size_t chunkSize) : m_chunk_size(chunkSize),
-    m_available(0), m_byte_count(0) {
+  bool MemoryOutputStream::next(uint8_t** data, size_t* len) {
+    if (m_available == 0) {
+      nextChunk(0);
     }
+    Chunk& last = m_data[m_count - 1];
+    *data = &last.data[last.capacity - m_available];
+    *len = m_available;
+    m_byte_count += m_available;
+    m_available = 0;
+    return true;
+  }
 
-    ~MemoryOutputStream() {
-      for (std::vector<uint8_t*>::const_iterator it = m_data.begin();
-        it != m_data.end(); ++it) {
-        delete[] * it;
-      }
-    }
+  void MemoryOutputStream::backup(size_t len) {
+    m_available += len;
+    m_byte_count -= len;
+  }
 
-    bool next(uint8_t** data, size_t* len) {
-      if (m_available == 0) {
-        m_data.push_back(new uint8_t[m_chunk_size]);
-        m_available = m_chunk_size;
-      }
-      *data = &m_data.back()[m_chunk_size - m_available];
-      *len = m_available;
-      m_byte_count += m_available;
-      m_available = 0;
-      return true;
-    }
+  uint64_t MemoryOutputStream::byteCount() const {
+    return m_byte_count;
+  }
 
-    void backup(size_t len) {
-      m_available += len;
-      m_byte_count -= len;
-    }
+  void MemoryOutputStream::flush() {
+  }
 
-    uint64_t byteCount() const {
-      return m_byte_count;
-    }
+  /* The number of bytes in the last chunk holding the contents.*/
+  size_t MemoryOutputStream::lastChunkLen() const {
+    return m_data[m_count - 1].capacity - m_available;
+  }
 
-    void flush() {
+  /* Copies the contents into the given array, which must hold m_byte_count bytes.*/
+  void MemoryOutputStream::copyTo(uint8_t* dest) const {
+    for (size_t i = 0; i < m_count; ++i) {
+      size_t n = (i + 1 == m_count) ? lastChunkLen() : m_data[i].used;
+      dest = std::copy(m_data[i].data, m_data[i].data + n, dest);
     }
-  };
+  }
+
+  std::unique_ptr<uint8_t[]> MemoryOutputStream::releaseContiguous(size_t* len) {
+    std::unique_ptr<uint8_t[]> result;
+    *len = m_byte_count;
+    if (m_count == 1) {
+      result.reset(m_data[0].data);
+      m_data.erase(m_data.begin());
+    } else if (m_count != 0) {
+      result.reset(new uint8_t[m_byte_count]);
+      copyTo(result.get());
+    }
+    reset();
+    return result;
+  }
 
   std::shared_ptr<OutputStream> memoryOutputStream(size_t chunkSize) {
     return std::shared_ptr<OutputStream>(new MemoryOutputStream(chunkSize));
   }
 
+  std::shared_ptr<OutputStream> memoryOutputStream(size_t chunkSize, size_t maxChunkSize) {
+    return std::shared_ptr<OutputStream>(new MemoryOutputStream(chunkSize, maxChunkSize));
+  }
+
   std::shared_ptr<InputStream> memoryInputStream(const uint8_t* data, size_t len) {
-    return std::shared_ptr<InputStream>(new MemoryInputStream2(data, len));
+    return std::shared_ptr<InputStream>(new MemoryInputStream(data, len));
   }
 
   std::shared_ptr<InputStream> memoryInputStream(const OutputStream& source) {
     const MemoryOutputStream& mos =
       dynamic_cast<const MemoryOutputStream&> (source);
-    return (mos.m_data.empty()) ?
-      std::shared_ptr<InputStream>(new MemoryInputStream2(0, 0)) :
-      std::shared_ptr<InputStream>(new MemoryInputStream(mos.m_data,
-      mos.m_chunk_size,
-      (mos.m_chunk_size - mos.m_available)));
+    if (mos.m_count == 0) {
+      return std::shared_ptr<InputStream>(new MemoryInputStream(0, 0));
+    } else if (mos.m_count == 1) {
+      return std::shared_ptr<InputStream>(new MemoryInputStream(mos.m_data[0].data, mos.lastChunkLen()));
+    }
+    return std::shared_ptr<InputStream>(new MemoryChunkInputStream(mos.m_data, mos.m_count, mos.lastChunkLen()));
   }
 
   std::shared_ptr<std::vector<uint8_t> > snapshot(const OutputStream& source) {
     const MemoryOutputStream& mos = dynamic_cast<const MemoryOutputStream&> (source);
-    std::shared_ptr<std::vector<uint8_t> > result(new std::vector<uint8_t>());
-    size_t c = mos.m_byte_count;
-    result->reserve(mos.m_byte_count);
-    for (vector<uint8_t*>::const_iterator it = mos.m_data.begin();
-      it != mos.m_data.end(); ++it) {
-      size_t n = std::min(c, mos.m_chunk_size);
-      std::copy(*it, *it + n, std::back_inserter(*result));
-      c -= n;
+    std::shared_ptr<std::vector<uint8_t> > result(new std::vector<uint8_t>(mos.m_byte_count));
+    if (mos.m_byte_count) {
+      mos.copyTo(&(*result)[0]);
     }
     return result;
   }
 
-}
+  void reserve(OutputStream& source, size_t size) {
+    dynamic_cast<MemoryOutputStream&> (source).reserve(size);
+  }
 
+  std::unique_ptr<uint8_t[]> releaseContiguous(OutputStream& source, size_t* len) {
+    return dynamic_cast<MemoryOutputStream&> (source).releaseContiguous(len);
+  }
+
+}
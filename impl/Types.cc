@@ -33,11 +33,8 @@ namespace avro {
       "boolean",
       "null",
       "record",
-      "enum",
       "array",
       "map",
-      "union",
-      "fixed",
       "symbolic"
     };
 
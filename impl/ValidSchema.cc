@@ -18,6 +18,7 @@
 
 #include <boost/format.hpp>
 #include <sstream>
+#include <vector>
 
 #include "ValidSchema.hh"
 #include "Schema.hh"
@@ -117,5 +118,71 @@ namespace avro {
     root_->printBasicInfo(os);
   }
 
+  static void printCanonical(std::ostream& os, const NodePtr& n) {
+    switch (n->type()) {
+      case Type::AVRO_SYMBOLIC:
+        os << '"' << n->name().fullname() << '"';
+        break;
+      case Type::AVRO_RECORD:
+      {
+        os << "{\"name\":\"" << n->name().fullname() << "\",\"type\":\"record\",\"fields\":[";
+        size_t c = n->leaves();
+        for (size_t i = 0; i < c; ++i) {
+          if (i > 0) {
+            os << ',';
+          }
+          os << "{\"name\":\"" << n->nameAt(i) << "\",\"type\":";
+          printCanonical(os, n->leafAt(i));
+          os << '}';
+        }
+        os << "]}";
+      }
+        break;
+      case Type::AVRO_ARRAY:
+        os << "{\"type\":\"array\",\"items\":";
+        printCanonical(os, n->leafAt(0));
+        os << '}';
+        break;
+      case Type::AVRO_MAP:
+        os << "{\"type\":\"map\",\"values\":";
+        printCanonical(os, n->leafAt(1));
+        os << '}';
+        break;
+      default:
+        os << '"' << n->type() << '"';
+        break;
+    }
+  }
+
+  std::string
+  ValidSchema::toCanonicalJson() const {
+    std::ostringstream oss;
+    printCanonical(oss, root_);
+    return oss.str();
+  }
+
+  uint64_t
+  ValidSchema::fingerprint() const {
+    static const uint64_t kEmpty = 0xc15d213aa4d7a795ULL;
+    static const std::vector<uint64_t> table = [] {
+      std::vector<uint64_t> t(256);
+      for (int i = 0; i < 256; ++i) {
+        uint64_t fp = i;
+        for (int j = 0; j < 8; ++j) {
+          fp = (fp >> 1) ^ (kEmpty & -(fp & 1));
+        }
+        t[i] = fp;
+      }
+      return t;
+    }();
+
+    std::string s = toCanonicalJson();
+    uint64_t fp = kEmpty;
+    for (unsigned char c : s) {
+      fp = (fp >> 8) ^ table[(fp ^ c) & 0xff];
+    }
+    return fp;
+  }
+
 }
 
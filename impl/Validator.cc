@@ -136,11 +136,8 @@ namespace avro {
       0, // bool
       0, // null
       &Validator::countingAdvance, // Record is treated like counting with count == 1
-      &Validator::enumAdvance,
-      &Validator::countingAdvance,
-      &Validator::countingAdvance,
-      &Validator::unionAdvance,
-      &Validator::fixedAdvance
+      &Validator::countingAdvance, // array
+      &Validator::countingAdvance // map
     };
     //static_assert((sizeof (funcs) / sizeof (AdvanceFunc)) == (Type::AVRO_NUM_TYPES));
 
@@ -193,7 +190,9 @@ namespace avro {
       typeToFlag(Type::AVRO_DOUBLE),
       typeToFlag(Type::AVRO_BOOL),
       typeToFlag(Type::AVRO_NULL),
-      typeToFlag(Type::AVRO_RECORD)
+      typeToFlag(Type::AVRO_RECORD),
+      typeToFlag(Type::AVRO_ARRAY),
+      typeToFlag(Type::AVRO_MAP)
     };
     //static_assert((sizeof (flags) / sizeof (flag_t)) == (Type::AVRO_NUM_TYPES));
 
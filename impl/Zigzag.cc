@@ -23,7 +23,7 @@ namespace avro {
 
   uint64_t
   encodeZigzag64(int64_t input) {
-    return ((input << 1) ^ (input >> 63));
+    return (static_cast<uint64_t> (input) << 1) ^ static_cast<uint64_t> (input >> 63);
   }
 
   int64_t
@@ -33,7 +33,7 @@ namespace avro {
 
   uint32_t
   encodeZigzag32(int32_t input) {
-    return ((input << 1) ^ (input >> 31));
+    return (static_cast<uint32_t> (input) << 1) ^ static_cast<uint32_t> (input >> 31);
   }
 
   int32_t
@@ -21,6 +21,7 @@
 #include <fstream>
 #include <map>
 #include <set>
+#include <algorithm>
 
 #include <boost/algorithm/string.hpp>
 #include <boost/lexical_cast.hpp>
@@ -33,6 +34,7 @@
 #include "Compiler.hh"
 #include "ValidSchema.hh"
 #include "NodeImpl.hh"
+#include "Zigzag.hh"
 
 using std::ostream;
 using std::ifstream;
@@ -80,6 +82,10 @@ class CodeGen {
   const std::string headerFile_;
   const std::string includePrefix_;
   const bool noUnion_;
+  const bool views_;
+  const bool pmr_;
+  const bool reorderMembers_;
+  const map<string, vector<string> > hotFields_;
   const std::string guardString_;
   boost::mt19937 random_;
 
@@ -88,33 +94,53 @@ class CodeGen {
 
   map<NodePtr, string> done;
   set<NodePtr> doing;
+  vector<NodePtr> deferred_; // records declared as container items, defined after the record holding them
+
+  NodePtr root_;
+  std::string canonicalJson_;
+  uint64_t fingerprint_;
 
   std::string guard();
   std::string fullname(const string& name) const;
   std::string generateEnumType(const NodePtr& n);
   std::string cppTypeOf(const NodePtr& n);
   std::string generateRecordType(const NodePtr& n);
+  vector<size_t> memberOrder(const NodePtr& n) const;
+  std::string viewTypeOf(const NodePtr& n);
+  void generateRecordView(const NodePtr& n);
+  void generateSchemaMembers();
+  std::string generateSchemaBuilder(const NodePtr& n, map<NodePtr, string>& built, set<NodePtr>& building);
+  void generateSchemaAccessor();
+  void generatePmrConstructors(const NodePtr& n, const std::string& name, const vector<string>& types);
   std::string unionName();
   std::string generateUnionType(const NodePtr& n);
   std::string generateType(const NodePtr& n);
   std::string generateDeclaration(const NodePtr& n);
+  std::string generateItemType(const NodePtr& n);
   std::string doGenerateType(const NodePtr& n);
   void generateEnumTraits(const NodePtr& n);
   void generateTraits(const NodePtr& n);
   void generateRecordTraits(const NodePtr& n);
+  void generateRecordViewTraits(const NodePtr& n);
+  void generateFieldTable(const NodePtr& n, const std::string& fn);
   void generateUnionTraits(const NodePtr& n);
+  void generateUnionEncodedSize(const NodePtr& n, const std::string& fn);
   void emitCopyright();
 public:
 
   CodeGen(std::ostream& os, const std::string& ns,
     const std::string& schemaFile, const std::string& headerFile,
     const std::string& guardString,
-    const std::string& includePrefix, bool noUnion) :
+    const std::string& includePrefix, bool noUnion,
+    bool views, bool pmr, bool reorderMembers,
+    const map<string, vector<string> >& hotFields) :
   unionNumber_(0), os_(os), inNamespace_(false), ns_(ns),
   schemaFile_(schemaFile), headerFile_(headerFile),
   includePrefix_(includePrefix), noUnion_(noUnion),
+  views_(views), pmr_(pmr), reorderMembers_(reorderMembers),
+  hotFields_(hotFields),
   guardString_(guardString),
-  random_(static_cast<uint32_t> (::time(0))) {
+  random_(static_cast<uint32_t> (::time(0))), fingerprint_(0) {
   }
   void generate(const ValidSchema& schema);
 };
@@ -141,9 +167,9 @@ string CodeGen::generateEnumType(const NodePtr& n) {
 string CodeGen::cppTypeOf(const NodePtr& n) {
   switch (n->type()) {
     case avro::Type::AVRO_STRING:
-      return "std::string";
+      return pmr_ ? "std::pmr::string" : "std::string";
     case avro::Type::AVRO_BYTES:
-      return "std::vector<uint8_t>";
+      return pmr_ ? "std::pmr::vector<uint8_t>" : "std::vector<uint8_t>";
     case avro::Type::AVRO_INT:
       return "int32_t";
     case avro::Type::AVRO_LONG:
@@ -159,6 +185,10 @@ string CodeGen::cppTypeOf(const NodePtr& n) {
       string nm = decorate(n->name());
       return inNamespace_ ? nm : fullname(nm);
     }
+    case avro::Type::AVRO_ARRAY:
+      return (pmr_ ? "std::pmr::vector<" : "std::vector<") + cppTypeOf(n->leafAt(0)) + " >";
+    case avro::Type::AVRO_MAP:
+      return (pmr_ ? "std::pmr::map<std::pmr::string, " : "std::map<std::string, ") + cppTypeOf(n->leafAt(1)) + " >";
     case avro::Type::AVRO_SYMBOLIC:
       return cppTypeOf(resolveSymbol(n));    
     case avro::Type::AVRO_NULL:
@@ -188,6 +218,10 @@ static string cppNameOf(const NodePtr& n) {
       return "bool";
     case avro::Type::AVRO_RECORD:
       return decorate(n->name());
+    case avro::Type::AVRO_ARRAY:
+      return "array";
+    case avro::Type::AVRO_MAP:
+      return "map";
     case avro::Type::AVRO_SYMBOLIC:
       return cppNameOf(resolveSymbol(n));
     default:
@@ -195,8 +229,383 @@ static string cppNameOf(const NodePtr& n) {
   }
 }
 
-string CodeGen::generateRecordType(const NodePtr& n) {  
-  return "TODO";
+/* The avro::Type enumerator of the given node, symbolic references resolved.*/
+static string avroTypeOf(const NodePtr& n) {
+  switch (n->type()) {
+    case avro::Type::AVRO_STRING:
+      return "avro::Type::AVRO_STRING";
+    case avro::Type::AVRO_BYTES:
+      return "avro::Type::AVRO_BYTES";
+    case avro::Type::AVRO_INT:
+      return "avro::Type::AVRO_INT";
+    case avro::Type::AVRO_LONG:
+      return "avro::Type::AVRO_LONG";
+    case avro::Type::AVRO_FLOAT:
+      return "avro::Type::AVRO_FLOAT";
+    case avro::Type::AVRO_DOUBLE:
+      return "avro::Type::AVRO_DOUBLE";
+    case avro::Type::AVRO_BOOL:
+      return "avro::Type::AVRO_BOOL";
+    case avro::Type::AVRO_NULL:
+      return "avro::Type::AVRO_NULL";
+    case avro::Type::AVRO_RECORD:
+      return "avro::Type::AVRO_RECORD";
+    case avro::Type::AVRO_ARRAY:
+      return "avro::Type::AVRO_ARRAY";
+    case avro::Type::AVRO_MAP:
+      return "avro::Type::AVRO_MAP";
+    case avro::Type::AVRO_SYMBOLIC:
+      return avroTypeOf(resolveSymbol(n));
+    default:
+      return "avro::Type::AVRO_UNKNOWN";
+  }
+}
+
+/* The alignment the generated C++ type of the given node has on the usual 64-bit targets.*/
+static size_t alignmentOf(const NodePtr& n) {
+  switch (n->type()) {
+    case avro::Type::AVRO_BOOL:
+    case avro::Type::AVRO_NULL:
+      return 1;
+    case avro::Type::AVRO_INT:
+    case avro::Type::AVRO_FLOAT:
+      return 4;
+    case avro::Type::AVRO_RECORD:
+    {
+      size_t result = 1;
+      for (size_t i = 0; i < n->leaves(); ++i) {
+        result = std::max(result, alignmentOf(n->leafAt(i)));
+      }
+      return result;
+    }
+    case avro::Type::AVRO_SYMBOLIC:
+      return alignmentOf(resolveSymbol(n));
+    default:
+      return 8;
+  }
+}
+
+/**
+ * Returns the order in which the members of a record are declared: the
+ * hot fields listed for the record first, then the others, by decreasing
+ * alignment if members are reordered so that no padding is needed between
+ * them. The codec traits still follow the schema order.
+ */
+vector<size_t> CodeGen::memberOrder(const NodePtr& n) const {
+  size_t c = n->leaves();
+  vector<size_t> order;
+  vector<bool> placed(c, false);
+
+  map<string, vector<string> >::const_iterator hot = hotFields_.find(decorate(n->name()));
+  if (hot != hotFields_.end()) {
+    for (vector<string>::const_iterator it = hot->second.begin(); it != hot->second.end(); ++it) {
+      size_t i;
+      if (!n->nameIndex(*it, i)) {
+        throw avro::Exception(boost::format("Unknown hot field %1%.%2%") % decorate(n->name()) % *it);
+      }
+      if (!placed[i]) {
+        order.push_back(i);
+        placed[i] = true;
+      }
+    }
+  }
+
+  size_t hotCount = order.size();
+  for (size_t i = 0; i < c; ++i) {
+    if (!placed[i]) {
+      order.push_back(i);
+    }
+  }
+  if (reorderMembers_) {
+    std::stable_sort(order.begin() + hotCount, order.end(), [&n](size_t a, size_t b) {
+      return alignmentOf(n->leafAt(a)) > alignmentOf(n->leafAt(b));
+    });
+  }
+  return order;
+}
+
+string CodeGen::generateRecordType(const NodePtr& n) {
+  size_t c = n->leaves();
+  size_t deferred = deferred_.size();
+  vector<string> types;
+  for (size_t i = 0; i < c; ++i) {
+    types.push_back(generateType(n->leafAt(i)));
+  }
+
+  map<NodePtr, string>::const_iterator it = done.find(n);
+  if (it != done.end()) {
+    return it->second;
+  }
+
+  const string name = decorate(n->name());
+  const vector<size_t> order = memberOrder(n);
+  os_ << "struct " << name << " {\n";
+  for (size_t k = 0; k < c; ++k) {
+    size_t i = order[k];
+    os_ << "    " << types[i] << ' ' << n->nameAt(i) << ";\n";
+  }
+
+  if (pmr_) {
+    generatePmrConstructors(n, name, types);
+  } else {
+    os_ << "    " << name << "()";
+    if (c > 0) {
+      os_ << " :";
+    }
+    os_ << "\n";
+    for (size_t k = 0; k < c; ++k) {
+      size_t i = order[k];
+      os_ << "        " << n->nameAt(i) << "(" << types[i] << "())";
+      if (k != (c - 1)) {
+        os_ << ',';
+      }
+      os_ << "\n";
+    }
+    os_ << "        { }\n";
+  }
+  if (n == root_) {
+    generateSchemaMembers();
+  }
+  os_ << "};\n\n";
+  if (views_) {
+    generateRecordView(n);
+  }
+
+  // the items may refer back to this record, which is complete now
+  done[n] = name;
+  for (size_t i = deferred; i < deferred_.size(); ++i) {
+    generateType(deferred_[i]);
+  }
+  deferred_.resize(deferred);
+  return name;
+}
+
+static string cppStringLiteral(const string& s) {
+  string result = "\"";
+  for (string::const_iterator it = s.begin(); it != s.end(); ++it) {
+    if (*it == '"' || *it == '\\') {
+      result += '\\';
+    }
+    result += *it;
+  }
+  return result + '"';
+}
+
+/* The root record carries the schema the header was generated from.*/
+void CodeGen::generateSchemaMembers() {
+  os_ << "    static constexpr const char schemaJson[] =\n"
+    << "        " << cppStringLiteral(canonicalJson_) << ";\n"
+    << "    static constexpr uint64_t schemaFingerprint = 0x" << std::hex
+    << fingerprint_ << std::dec << "ULL;\n"
+    << "    static const avro::ValidSchema& schema();\n";
+}
+
+/* Emits the statements building the given node with the Schema classes and returns the expression for it.  A reference to a record
+   whose fields are still being built is a symbolic link to it, as the compiler makes for recursive schemas.*/
+string CodeGen::generateSchemaBuilder(const NodePtr& n, map<NodePtr, string>& built, set<NodePtr>& building) {
+  switch (n->type()) {
+    case avro::Type::AVRO_STRING:
+      return "avro::StringSchema()";
+    case avro::Type::AVRO_BYTES:
+      return "avro::BytesSchema()";
+    case avro::Type::AVRO_INT:
+      return "avro::IntSchema()";
+    case avro::Type::AVRO_LONG:
+      return "avro::LongSchema()";
+    case avro::Type::AVRO_FLOAT:
+      return "avro::FloatSchema()";
+    case avro::Type::AVRO_DOUBLE:
+      return "avro::DoubleSchema()";
+    case avro::Type::AVRO_BOOL:
+      return "avro::BoolSchema()";
+    case avro::Type::AVRO_NULL:
+      return "avro::NullSchema()";
+    case avro::Type::AVRO_SYMBOLIC:
+    {
+      NodePtr record = resolveSymbol(n);
+      map<NodePtr, string>::const_iterator it = built.find(record);
+      if (it == built.end()) {
+        return generateSchemaBuilder(record, built, building);
+      }
+      if (building.find(record) != building.end()) {
+        return "avro::SymbolicSchema(avro::Name(\"" + record->name().fullname() + "\"), " + it->second + ".root())";
+      }
+      return it->second;
+    }
+    case avro::Type::AVRO_RECORD:
+    {
+      string var = "r" + lexical_cast<string>(built.size());
+      os_ << "        avro::RecordSchema " << var << "(\"" << n->name().fullname() << "\");\n";
+      built[n] = var;
+      building.insert(n);
+      vector<string> fields;
+      for (size_t i = 0; i < n->leaves(); ++i) {
+        fields.push_back(generateSchemaBuilder(n->leafAt(i), built, building));
+      }
+      for (size_t i = 0; i < fields.size(); ++i) {
+        os_ << "        " << var << ".addField(\"" << n->nameAt(i) << "\", " << fields[i];
+        switch (n->fieldOrderAt(i)) {
+          case avro::FieldOrder::DESCENDING:
+            os_ << ", avro::FieldOrder::DESCENDING";
+            break;
+          case avro::FieldOrder::IGNORE:
+            os_ << ", avro::FieldOrder::IGNORE";
+            break;
+          default:
+            break;
+        }
+        os_ << ");\n";
+      }
+      building.erase(n);
+      return var;
+    }
+    case avro::Type::AVRO_ARRAY:
+      return "avro::ArraySchema(" + generateSchemaBuilder(n->leafAt(0), built, building) + ")";
+    case avro::Type::AVRO_MAP:
+      return "avro::MapSchema(" + generateSchemaBuilder(n->leafAt(1), built, building) + ")";
+    default:
+      throw avro::Exception(boost::format("Cannot embed schema of type %1%") % n->type());
+  }
+}
+
+/**
+ * The schema is built with the Schema classes on first use, so that
+ * neither file access nor JSON parsing is needed at run time.
+ */
+void CodeGen::generateSchemaAccessor() {
+  string fn = cppTypeOf(root_);
+  map<NodePtr, string> built;
+  set<NodePtr> building;
+  os_ << "inline const avro::ValidSchema& " << fn << "::schema() {\n"
+    << "    static const avro::ValidSchema s([] {\n";
+  string root = generateSchemaBuilder(root_, built, building);
+  os_ << "        return avro::ValidSchema(" << root << ");\n"
+    << "    }());\n"
+    << "    return s;\n"
+    << "}\n\n";
+}
+
+/* Whether members of the given type take the allocator of the record that holds them.*/
+static bool usesAllocator(const NodePtr& n) {
+  switch (n->type()) {
+    case avro::Type::AVRO_STRING:
+    case avro::Type::AVRO_BYTES:
+    case avro::Type::AVRO_RECORD:
+    case avro::Type::AVRO_ARRAY:
+    case avro::Type::AVRO_MAP:
+      return true;
+    case avro::Type::AVRO_SYMBOLIC:
+      return usesAllocator(resolveSymbol(n));
+    default:
+      return false;
+  }
+}
+
+/**
+ * Makes a record allocator-aware: the constructors hand the record's
+ * polymorphic allocator to its string, bytes and record members, so that
+ * everything decoded into the record comes from the same memory resource.
+ */
+void CodeGen::generatePmrConstructors(const NodePtr& n, const string& name,
+  const vector<string>& types) {
+  size_t c = n->leaves();
+  const vector<size_t> order = memberOrder(n);
+  os_ << "    typedef std::pmr::polymorphic_allocator<char> allocator_type;\n"
+    << "    " << name << "() : " << name << "(allocator_type()) { }\n"
+    << "    explicit " << name << "(const allocator_type& alloc)";
+  if (c > 0) {
+    os_ << " :";
+  }
+  os_ << "\n";
+  for (size_t k = 0; k < c; ++k) {
+    size_t i = order[k];
+    os_ << "        " << n->nameAt(i) << "(";
+    if (usesAllocator(n->leafAt(i))) {
+      os_ << "alloc)";
+    } else {
+      os_ << types[i] << "())";
+    }
+    if (k != (c - 1)) {
+      os_ << ',';
+    }
+    os_ << "\n";
+  }
+  os_ << "        { }\n";
+
+  os_ << "    " << name << "(const " << name << "& other, const allocator_type& alloc)";
+  if (c > 0) {
+    os_ << " :";
+  }
+  os_ << "\n";
+  for (size_t k = 0; k < c; ++k) {
+    size_t i = order[k];
+    os_ << "        " << n->nameAt(i) << "(other." << n->nameAt(i);
+    if (usesAllocator(n->leafAt(i))) {
+      os_ << ", alloc";
+    }
+    os_ << ")";
+    if (k != (c - 1)) {
+      os_ << ',';
+    }
+    os_ << "\n";
+  }
+  os_ << "        { }\n";
+  os_ << "    " << name << "(const " << name << "&) = default;\n"
+    << "    " << name << "(" << name << "&&) = default;\n"
+    << "    " << name << "& operator=(const " << name << "&) = default;\n"
+    << "    " << name << "& operator=(" << name << "&&) = default;\n";
+}
+
+/* The type of a member of a view struct.  Strings and bytes are views of the decoded memory, records are their view structs.*/
+string CodeGen::viewTypeOf(const NodePtr& n) {
+  switch (n->type()) {
+    case avro::Type::AVRO_STRING:
+      return "std::string_view";
+    case avro::Type::AVRO_BYTES:
+      return "avro::BytesView";
+    case avro::Type::AVRO_RECORD:
+      return cppTypeOf(n) + "View";
+    case avro::Type::AVRO_ARRAY:
+      return "std::vector<" + viewTypeOf(n->leafAt(0)) + " >";
+    case avro::Type::AVRO_MAP:
+      return "std::map<std::string_view, " + viewTypeOf(n->leafAt(1)) + " >";
+    case avro::Type::AVRO_SYMBOLIC:
+      return viewTypeOf(resolveSymbol(n));
+    default:
+      return cppTypeOf(n);
+  }
+}
+
+/**
+ * Generates a read-only companion of a record whose string and bytes
+ * members point into the memory it is decoded from.
+ */
+void CodeGen::generateRecordView(const NodePtr& n) {
+  size_t c = n->leaves();
+  const string name = decorate(n->name()) + "View";
+  const vector<size_t> order = memberOrder(n);
+  os_ << "/* A view of " << decorate(n->name()) << " decoded in place, "
+    "valid only while the decoded memory is. */\n"
+    << "struct " << name << " {\n";
+  for (size_t k = 0; k < c; ++k) {
+    size_t i = order[k];
+    os_ << "    " << viewTypeOf(n->leafAt(i)) << ' ' << n->nameAt(i) << ";\n";
+  }
+  os_ << "    " << name << "()";
+  if (c > 0) {
+    os_ << " :";
+  }
+  os_ << "\n";
+  for (size_t k = 0; k < c; ++k) {
+    size_t i = order[k];
+    os_ << "        " << n->nameAt(i) << "(" << viewTypeOf(n->leafAt(i)) << "())";
+    if (k != (c - 1)) {
+      os_ << ',';
+    }
+    os_ << "\n";
+  }
+  os_ << "        { }\n";
+  os_ << "};\n\n";
 }
 
 void makeCanonical(string& s, bool foldCase) {
@@ -349,12 +758,30 @@ string CodeGen::doGenerateType(const NodePtr& n) {
       return cppTypeOf(n);    
     case avro::Type::AVRO_RECORD:
       return generateRecordType(n);
+    case avro::Type::AVRO_ARRAY:
+      return (pmr_ ? "std::pmr::vector<" : "std::vector<") + generateItemType(n->leafAt(0)) + " >";
+    case avro::Type::AVRO_MAP:
+      return (pmr_ ? "std::pmr::map<std::pmr::string, " : "std::map<std::string, ") + generateItemType(n->leafAt(1)) + " >";
     default:
       break;
   }
   return "$Undefuned$";
 }
 
+/* A record held in an array or a map is only declared here and defined after the record that holds the container, since it may refer
+   back to that record, or be it, and containers can hold types that are not complete yet.*/
+string CodeGen::generateItemType(const NodePtr& n) {
+  NodePtr nn = (n->type() == avro::Type::AVRO_SYMBOLIC) ? resolveSymbol(n) : n;
+  if (nn->type() != avro::Type::AVRO_RECORD || done.find(nn) != done.end()) {
+    return generateType(nn);
+  }
+  deferred_.push_back(nn);
+  if (views_) {
+    os_ << "struct " << cppTypeOf(nn) << "View;\n";
+  }
+  return generateDeclaration(nn);
+}
+
 string CodeGen::generateDeclaration(const NodePtr& n) {
   NodePtr nn = (n->type() == avro::Type::AVRO_SYMBOLIC) ? resolveSymbol(n) : n;
   switch (nn->type()) {
@@ -370,6 +797,10 @@ string CodeGen::generateDeclaration(const NodePtr& n) {
     case avro::Type::AVRO_RECORD:
       os_ << "struct " << cppTypeOf(nn) << ";\n";
       return cppTypeOf(nn);
+    case avro::Type::AVRO_ARRAY:
+    case avro::Type::AVRO_MAP:
+      generateDeclaration(nn->leafAt(nn->type() == avro::Type::AVRO_MAP ? 1 : 0));
+      return cppTypeOf(nn);
     default:
       break;
   }
@@ -455,8 +886,49 @@ void CodeGen::generateRecordTraits(const NodePtr& n) {
   }
   os_ << "        }\n";
 
+  os_ << "    }\n"
+    << "    static size_t encodedSize(const " << fn << "& v) {\n"
+    << "        return 0";
+  for (size_t i = 0; i < c; ++i) {
+    os_ << "\n            + avro::encodedSize(v." << n->nameAt(i) << ")";
+  }
+  os_ << ";\n"
+    << "    }\n"
+    << "};\n\n";
+  generateFieldTable(n, fn);
+
+  if (views_) {
+    generateRecordViewTraits(n);
+  }
+}
+
+/* The fields are listed in schema order, whatever order the members are declared in.*/
+void CodeGen::generateFieldTable(const NodePtr& n, const string& fn) {
+  size_t c = n->leaves();
+  os_ << "template<> struct record_traits<" << fn << "> {\n"
+    << "    static constexpr size_t fieldCount = " << c << ";\n"
+    << "    static constexpr auto fields = std::make_tuple(";
+  for (size_t i = 0; i < c; ++i) {
+    os_ << (i == 0 ? "\n" : ",\n")
+      << "        avro::makeField(\"" << n->nameAt(i) << "\", " << i << ", &" << fn << "::" << n->nameAt(i)
+      << ", " << avroTypeOf(n->leafAt(i)) << ")";
+  }
+  os_ << ");\n"
+    << "};\n\n";
+}
+
+/* Views are only read in the writer's field order, from a ViewDecoder.*/
+void CodeGen::generateRecordViewTraits(const NodePtr& n) {
+  size_t c = n->leaves();
+  string fn = fullname(decorate(n->name()) + "View");
+  os_ << "template<> struct view_traits<" << fn << "> {\n"
+    << "    static void decode(ViewDecoder& d, " << fn << "& v) {\n";
+  for (size_t i = 0; i < c; ++i) {
+    os_ << "        avro::decodeView(d, v." << n->nameAt(i) << ");\n";
+  }
   os_ << "    }\n"
     << "};\n\n";
+  generateFieldTable(n, fn);
 }
 
 void CodeGen::generateUnionTraits(const NodePtr& n) {
@@ -511,8 +983,28 @@ void CodeGen::generateUnionTraits(const NodePtr& n) {
     os_ << "            break;\n";
   }
   os_ << "        }\n"
-    << "    }\n"
-    << "};\n\n";
+    << "    }\n";
+  generateUnionEncodedSize(n, fn);
+  os_ << "};\n\n";
+}
+
+/* The union index is known for every branch, so its size is emitted as a constant.*/
+void CodeGen::generateUnionEncodedSize(const NodePtr& n, const string& fn) {
+  size_t c = n->leaves();
+  os_ << "    static size_t encodedSize(const " << fn << "& v) {\n"
+    << "        switch (v.idx()) {\n";
+  for (size_t i = 0; i < c; ++i) {
+    const NodePtr& nn = n->leafAt(i);
+    os_ << "        case " << i << ":\n"
+      << "            return " << avro::encodedInt64Size(i);
+    if (nn->type() != avro::Type::AVRO_NULL) {
+      os_ << " + avro::encodedSize(v.get_" << cppNameOf(nn) << "())";
+    }
+    os_ << ";\n";
+  }
+  os_ << "        }\n"
+    << "        return 0;\n"
+    << "    }\n";
 }
 
 void CodeGen::generateTraits(const NodePtr& n) {
@@ -529,6 +1021,12 @@ void CodeGen::generateTraits(const NodePtr& n) {
     case avro::Type::AVRO_RECORD:
       generateRecordTraits(n);
       break;
+    case avro::Type::AVRO_ARRAY:
+      generateTraits(n->leafAt(0));
+      break;
+    case avro::Type::AVRO_MAP:
+      generateTraits(n->leafAt(1));
+      break;
     default:
       break;
   }
@@ -573,12 +1071,23 @@ void CodeGen::generate(const ValidSchema& schema) {
   os_ << "#ifndef " << h << "\n";
   os_ << "#define " << h << "\n\n\n";
 
-  os_ << "#include <sstream>\n"
-    << "#include \"boost/any.hpp\"\n"
-    << "#include \"" << includePrefix_ << "Specific.hh\"\n"
+  os_ << "#include <sstream>\n";
+  if (views_) {
+    os_ << "#include <string_view>\n";
+  }
+  if (pmr_) {
+    os_ << "#include <memory_resource>\n";
+  }
+  os_ << "#include \"boost/any.hpp\"\n";
+  os_ << "#include \"" << includePrefix_ << "Specific.hh\"\n"
+    << "#include \"" << includePrefix_ << "RecordTraits.hh\"\n"
     << "#include \"" << includePrefix_ << "Encoder.hh\"\n"
     << "#include \"" << includePrefix_ << "Decoder.hh\"\n"
-    << "\n";
+    << "#include \"" << includePrefix_ << "Schema.hh\"\n";
+  if (views_) {
+    os_ << "#include \"" << includePrefix_ << "ViewDecoder.hh\"\n";
+  }
+  os_ << "\n";
 
   if (!ns_.empty()) {
     os_ << "namespace " << ns_ << " {\n";
@@ -586,7 +1095,14 @@ void CodeGen::generate(const ValidSchema& schema) {
   }
 
   const NodePtr& root = schema.root();
+  root_ = root;
+  canonicalJson_ = schema.toCanonicalJson();
+  fingerprint_ = schema.fingerprint();
   generateType(root);
+  // records declared as items of a container that is not inside a record
+  for (size_t i = 0; i < deferred_.size(); ++i) {
+    generateType(deferred_[i]);
+  }
 
   for (vector<PendingSetterGetter>::const_iterator it =
     pendingGettersAndSetters.begin();
@@ -602,6 +1118,10 @@ void CodeGen::generate(const ValidSchema& schema) {
       it->initMember, it->memberName);
   }
 
+  if (root->type() == avro::Type::AVRO_RECORD) {
+    generateSchemaAccessor();
+  }
+
   if (!ns_.empty()) {
     inNamespace_ = false;
     os_ << "}\n";
@@ -627,6 +1147,29 @@ static const string OUT("output");
 static const string IN("input");
 static const string INCLUDE_PREFIX("include-prefix");
 static const string NO_UNION_TYPEDEF("no-union-typedef");
+static const string VIEWS("views");
+static const string PMR("pmr");
+static const string REORDER_MEMBERS("reorder-members");
+static const string HOT_FIELDS("hot-fields");
+
+/* Parses Record.field,Record.field... into the hot fields of every record.*/
+static map<string, vector<string> > parseHotFields(const string& spec) {
+  map<string, vector<string> > result;
+  vector<string> items;
+  boost::algorithm::split(items, spec, boost::algorithm::is_any_of(","));
+  for (vector<string>::const_iterator it = items.begin(); it != items.end(); ++it) {
+    string item = boost::algorithm::trim_copy(*it);
+    if (item.empty()) {
+      continue;
+    }
+    string::size_type dot = item.find('.');
+    if (dot == string::npos || dot == 0 || dot == item.size() - 1) {
+      throw avro::Exception(boost::format("Hot field %1% is not of the form Record.field") % item);
+    }
+    result[item.substr(0, dot)].push_back(item.substr(dot + 1));
+  }
+  return result;
+}
 
 static string readGuard(const string& filename) {
   std::ifstream ifs(filename.c_str());
@@ -656,6 +1199,10 @@ int main(int argc, char** argv) {
     ("include-prefix,p", po::value<string>()->default_value("avro"),
     "prefix for include headers, - for none, default: avro")
     ("no-union-typedef,U", "do not generate typedefs for unions in records")
+    ("views", "also generate read-only view structs of records, decoded in place from contiguous memory")
+    ("pmr", "use std::pmr strings and bytes in records and make records allocator-aware")
+    ("reorder-members", "declare record members by decreasing alignment to avoid padding, encoding order is unchanged")
+    ("hot-fields", po::value<string>(), "comma separated Record.field list of members to declare first, in that order")
     ("namespace,n", po::value<string>(), "set namespace for generated code")
     ("input,i", po::value<string>(), "input file")
     ("output,o", po::value<string>(), "output file to generate");
@@ -675,6 +1222,10 @@ int main(int argc, char** argv) {
   string inf = vm.count(IN) > 0 ? vm[IN].as<string>() : string();
   string incPrefix = vm[INCLUDE_PREFIX].as<string>();
   bool noUnion = vm.count(NO_UNION_TYPEDEF) != 0;
+  bool views = vm.count(VIEWS) != 0;
+  bool pmr = vm.count(PMR) != 0;
+  bool reorderMembers = vm.count(REORDER_MEMBERS) != 0;
+  string hotFields = vm.count(HOT_FIELDS) > 0 ? vm[HOT_FIELDS].as<string>() : string();
   if (incPrefix == "-") {
     incPrefix.clear();
   } else if (*incPrefix.rbegin() != '/') {
@@ -682,6 +1233,7 @@ int main(int argc, char** argv) {
   }
 
   try {
+    const map<string, vector<string> > hot = parseHotFields(hotFields);
     ValidSchema schema;
 
     if (!inf.empty()) {
@@ -694,10 +1246,11 @@ int main(int argc, char** argv) {
     if (!outf.empty()) {
       string g = readGuard(outf);
       ofstream out(outf.c_str());
-      CodeGen(out, ns, inf, outf, g, incPrefix, noUnion).generate(schema);
+      CodeGen(out, ns, inf, outf, g, incPrefix, noUnion, views, pmr,
+        reorderMembers, hot).generate(schema);
     } else {
-      CodeGen(std::cout, ns, inf, outf, "", incPrefix, noUnion).
-        generate(schema);
+      CodeGen(std::cout, ns, inf, outf, "", incPrefix, noUnion,
+        views, pmr, reorderMembers, hot).generate(schema);
     }
     return 0;
   } catch (std::exception &e) {
@@ -76,6 +76,8 @@ namespace avro {
         case Type::AVRO_STRING:
         case Type::AVRO_BYTES:
         case Type::AVRO_SYMBOLIC:
+        case Type::AVRO_ARRAY:
+        case Type::AVRO_MAP:
           return ValidatingGrammarGenerator::doGenerate(n, m);
         case Type::AVRO_RECORD:
         {
@@ -152,6 +154,12 @@ namespace avro {
       void skipString();
       void decodeBytes(vector<uint8_t>& value);
       void skipBytes();
+      size_t arrayStart();
+      size_t arrayNext();
+      size_t skipArray();
+      size_t mapStart();
+      size_t mapNext();
+      size_t skipMap();
 
       void expect(JsonParser::Token tk);
       void skipComposite();
@@ -252,7 +260,68 @@ namespace avro {
     void JsonDecoder<P>::skipBytes() {
       parser_.advance(Symbol::sBytes);
       expect(JsonParser::tkString);
-    }   
+    }
+
+    template <typename P>
+    size_t JsonDecoder<P>::arrayStart() {
+      parser_.advance(Symbol::sArrayStart);
+      expect(JsonParser::tkArrayStart);
+      return arrayNext();
+    }
+
+    /* JSON does not say how many items an array has, so they are handed out one at a time.*/
+    template <typename P>
+    size_t JsonDecoder<P>::arrayNext() {
+      parser_.processImplicitActions();
+      if (in_.peek() == JsonParser::tkArrayEnd) {
+        in_.advance();
+        parser_.popRepeater();
+        parser_.advance(Symbol::sArrayEnd);
+        return 0;
+      }
+      parser_.setRepeatCount(1);
+      return 1;
+    }
+
+    template <typename P>
+    size_t JsonDecoder<P>::skipArray() {
+      parser_.advance(Symbol::sArrayStart);
+      parser_.pop();
+      parser_.advance(Symbol::sArrayEnd);
+      expect(JsonParser::tkArrayStart);
+      skipComposite();
+      return 0;
+    }
+
+    template <typename P>
+    size_t JsonDecoder<P>::mapStart() {
+      parser_.advance(Symbol::sMapStart);
+      expect(JsonParser::tkObjectStart);
+      return mapNext();
+    }
+
+    template <typename P>
+    size_t JsonDecoder<P>::mapNext() {
+      parser_.processImplicitActions();
+      if (in_.peek() == JsonParser::tkObjectEnd) {
+        in_.advance();
+        parser_.popRepeater();
+        parser_.advance(Symbol::sMapEnd);
+        return 0;
+      }
+      parser_.setRepeatCount(1);
+      return 1;
+    }
+
+    template <typename P>
+    size_t JsonDecoder<P>::skipMap() {
+      parser_.advance(Symbol::sMapStart);
+      parser_.pop();
+      parser_.advance(Symbol::sMapEnd);
+      expect(JsonParser::tkObjectStart);
+      skipComposite();
+      return 0;
+    }
 
     template<typename P>
     void JsonDecoder<P>::skipComposite() {
@@ -317,7 +386,11 @@ namespace avro {
       void encodeFloat(float f);
       void encodeDouble(double d);
       void encodeString(const std::string& s);
-      void encodeBytes(const uint8_t *bytes, size_t len);      
+      void encodeBytes(const uint8_t *bytes, size_t len);
+      void arrayStart();
+      void arrayEnd();
+      void mapStart();
+      void mapEnd();
       void setItemCount(size_t count);
       void startItem();
     public:
@@ -401,7 +474,33 @@ namespace avro {
     void JsonEncoder<P, F>::encodeBytes(const uint8_t *bytes, size_t len) {
       parser_.advance(Symbol::sBytes);
       out_.encodeBinary(bytes, len);
-    }    
+    }
+
+    template<typename P, typename F>
+    void JsonEncoder<P, F>::arrayStart() {
+      parser_.advance(Symbol::sArrayStart);
+      out_.arrayStart();
+    }
+
+    template<typename P, typename F>
+    void JsonEncoder<P, F>::arrayEnd() {
+      parser_.popRepeater();
+      parser_.advance(Symbol::sArrayEnd);
+      out_.arrayEnd();
+    }
+
+    template<typename P, typename F>
+    void JsonEncoder<P, F>::mapStart() {
+      parser_.advance(Symbol::sMapStart);
+      out_.objectStart();
+    }
+
+    template<typename P, typename F>
+    void JsonEncoder<P, F>::mapEnd() {
+      parser_.popRepeater();
+      parser_.advance(Symbol::sMapEnd);
+      out_.objectEnd();
+    }
 
     template<typename P, typename F>
     void JsonEncoder<P, F>::setItemCount(size_t count) {
@@ -306,6 +306,34 @@ namespace avro {
               return result;
             }
             break;
+          case Type::AVRO_ARRAY:
+          {
+            const NodePtr& wl0 = writer->leafAt(0);
+            const NodePtr& rl0 = reader->leafAt(0);
+            ProductionPtr p = getWriterProduction(wl0, m2);
+            ProductionPtr p2 = doGenerate2(wl0, rl0, m, m2);
+            ProductionPtr result = std::make_shared<Production>();
+            result->push_back(Symbol::arrayEndSymbol());
+            result->push_back(Symbol::repeater(p2, p, true));
+            result->push_back(Symbol::arrayStartSymbol());
+            return result;
+          }
+          case Type::AVRO_MAP:
+          {
+            ProductionPtr pp = doGenerate2(writer->leafAt(1), reader->leafAt(1), m, m2);
+            ProductionPtr v(new Production(*pp));
+            v->push_back(Symbol::stringSymbol());
+
+            ProductionPtr pp2 = getWriterProduction(writer->leafAt(1), m2);
+            ProductionPtr v2(new Production(*pp2));
+            v2->push_back(Symbol::stringSymbol());
+
+            ProductionPtr result = std::make_shared<Production>();
+            result->push_back(Symbol::mapEndSymbol());
+            result->push_back(Symbol::repeater(v, v2, false));
+            result->push_back(Symbol::mapStartSymbol());
+            return result;
+          }
           default:
             throw Exception("Unknown node type");
         }
@@ -340,6 +368,8 @@ namespace avro {
           case Type::AVRO_STRING:
           case Type::AVRO_BYTES:
           case Type::AVRO_RECORD:
+          case Type::AVRO_ARRAY:
+          case Type::AVRO_MAP:
             break;
           default:
             throw Exception("Unknown node type");
@@ -400,9 +430,17 @@ namespace avro {
       float decodeFloat();
       double decodeDouble();
       void decodeString(string& value);
+      void decodeString(std::pmr::string& value);
       void skipString();
       void decodeBytes(vector<uint8_t>& value);
+      void decodeBytes(std::pmr::vector<uint8_t>& value);
       void skipBytes();
+      size_t arrayStart();
+      size_t arrayNext();
+      size_t skipArray();
+      size_t mapStart();
+      size_t mapNext();
+      size_t skipMap();
       const vector<size_t>& fieldOrder();
     public:
 
@@ -469,6 +507,12 @@ namespace avro {
       base_->decodeString(value);
     }
 
+    template <typename P>
+    void ResolvingDecoderImpl<P>::decodeString(std::pmr::string& value) {
+      parser_.advance(Symbol::sString);
+      base_->decodeString(value);
+    }
+
     template <typename P>
     void ResolvingDecoderImpl<P>::skipString() {
       parser_.advance(Symbol::sString);
@@ -481,12 +525,98 @@ namespace avro {
       base_->decodeBytes(value);
     }
 
+    template <typename P>
+    void ResolvingDecoderImpl<P>::decodeBytes(std::pmr::vector<uint8_t>& value) {
+      parser_.advance(Symbol::sBytes);
+      base_->decodeBytes(value);
+    }
+
     template <typename P>
     void ResolvingDecoderImpl<P>::skipBytes() {
       parser_.advance(Symbol::sBytes);
       base_->skipBytes();
     }
-   
+
+    template <typename P>
+    size_t ResolvingDecoderImpl<P>::arrayStart() {
+      parser_.advance(Symbol::sArrayStart);
+      size_t result = base_->arrayStart();
+      if (result == 0) {
+        parser_.popRepeater();
+        parser_.advance(Symbol::sArrayEnd);
+      } else {
+        parser_.setRepeatCount(result);
+      }
+      return result;
+    }
+
+    template <typename P>
+    size_t ResolvingDecoderImpl<P>::arrayNext() {
+      parser_.processImplicitActions();
+      size_t result = base_->arrayNext();
+      if (result == 0) {
+        parser_.popRepeater();
+        parser_.advance(Symbol::sArrayEnd);
+      } else {
+        parser_.setRepeatCount(result);
+      }
+      return result;
+    }
+
+    template <typename P>
+    size_t ResolvingDecoderImpl<P>::skipArray() {
+      parser_.advance(Symbol::sArrayStart);
+      size_t n = base_->skipArray();
+      if (n == 0) {
+        parser_.pop();
+      } else {
+        parser_.setRepeatCount(n);
+        parser_.skip(*base_);
+      }
+      parser_.advance(Symbol::sArrayEnd);
+      return 0;
+    }
+
+    template <typename P>
+    size_t ResolvingDecoderImpl<P>::mapStart() {
+      parser_.advance(Symbol::sMapStart);
+      size_t result = base_->mapStart();
+      if (result == 0) {
+        parser_.popRepeater();
+        parser_.advance(Symbol::sMapEnd);
+      } else {
+        parser_.setRepeatCount(result);
+      }
+      return result;
+    }
+
+    template <typename P>
+    size_t ResolvingDecoderImpl<P>::mapNext() {
+      parser_.processImplicitActions();
+      size_t result = base_->mapNext();
+      if (result == 0) {
+        parser_.popRepeater();
+        parser_.advance(Symbol::sMapEnd);
+      } else {
+        parser_.setRepeatCount(result);
+      }
+      return result;
+    }
+
+    template <typename P>
+    size_t ResolvingDecoderImpl<P>::skipMap() {
+      parser_.advance(Symbol::sMapStart);
+      size_t n = base_->skipMap();
+      if (n == 0) {
+        parser_.pop();
+      } else {
+        parser_.setRepeatCount(n);
+        parser_.skip(*base_);
+      }
+      parser_.advance(Symbol::sMapEnd);
+      return 0;
+    }
+
     template <typename P>
     const vector<size_t>& ResolvingDecoderImpl<P>::fieldOrder() {
       parser_.advance(Symbol::sRecord);
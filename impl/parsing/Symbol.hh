@@ -444,6 +444,9 @@ namespace avro {
               case Symbol::sRepeater:
               {
                 RepeaterInfo *p = s.extrap<RepeaterInfo>();
+                if (boost::tuples::get<0>(*p) == 0) {
+                  throw Exception("Array or map item count is exhausted");
+                }
                 --boost::tuples::get<0>(*p);
                 append(boost::tuples::get<2>(*p));
               }
@@ -514,8 +517,52 @@ namespace avro {
               break;
             case Symbol::sBytes:
               d.skipBytes();
-              break;            
-            case Symbol::sRepeater:            
+              break;
+            case Symbol::sArrayStart:
+            {
+              parsingStack.pop();
+              size_t n = d.skipArray();
+              processImplicitActions();
+              assertMatch(Symbol::sRepeater, parsingStack.top().kind());
+              if (n == 0) {
+                break;
+              }
+              Symbol& t = parsingStack.top();
+              RepeaterInfo *p = t.extrap<RepeaterInfo>();
+              boost::tuples::get<0>(*p) = n;
+              continue;
+            }
+            case Symbol::sArrayEnd:
+              break;
+            case Symbol::sMapStart:
+            {
+              parsingStack.pop();
+              size_t n = d.skipMap();
+              processImplicitActions();
+              assertMatch(Symbol::sRepeater, parsingStack.top().kind());
+              if (n == 0) {
+                break;
+              }
+              Symbol& t = parsingStack.top();
+              RepeaterInfo *p = t.extrap<RepeaterInfo>();
+              boost::tuples::get<0>(*p) = n;
+              continue;
+            }
+            case Symbol::sMapEnd:
+              break;
+            case Symbol::sRepeater:
+            {
+              RepeaterInfo *p = t.extrap<RepeaterInfo>();
+              size_t& nn = boost::tuples::get<0>(*p);
+              if (nn == 0) {
+                nn = boost::tuples::get<1>(*p) ? d.arrayNext() : d.mapNext();
+              }
+              if (nn != 0) {
+                --nn;
+                append(boost::tuples::get<3>(*p));
+                continue;
+              }
+            }
               break;
             case Symbol::sIndirect:
             {
@@ -92,6 +92,26 @@ namespace avro {
           m[n] = result;
           return result;
         }
+        case Type::AVRO_ARRAY:
+        {
+          ProductionPtr p = doGenerate(n->leafAt(0), m);
+          ProductionPtr result = std::make_shared<Production>();
+          result->push_back(Symbol::arrayEndSymbol());
+          result->push_back(Symbol::repeater(p, p, true));
+          result->push_back(Symbol::arrayStartSymbol());
+          return result;
+        }
+        case Type::AVRO_MAP:
+        {
+          ProductionPtr pp = doGenerate(n->leafAt(1), m);
+          ProductionPtr v(new Production(*pp));
+          v->push_back(Symbol::stringSymbol());
+          ProductionPtr result = std::make_shared<Production>();
+          result->push_back(Symbol::mapEndSymbol());
+          result->push_back(Symbol::repeater(v, v, false));
+          result->push_back(Symbol::mapStartSymbol());
+          return result;
+        }
         case Type::AVRO_SYMBOLIC:
         {
           std::shared_ptr<NodeSymbolic> ns = static_pointer_cast<NodeSymbolic>(n);
@@ -131,9 +151,17 @@ namespace avro {
       float decodeFloat();
       double decodeDouble();
       void decodeString(string& value);
+      void decodeString(std::pmr::string& value);
       void skipString();
       void decodeBytes(vector<uint8_t>& value);
+      void decodeBytes(std::pmr::vector<uint8_t>& value);
       void skipBytes();
+      size_t arrayStart();
+      size_t arrayNext();
+      size_t skipArray();
+      size_t mapStart();
+      size_t mapNext();
+      size_t skipMap();
 
     public:
 
@@ -191,6 +219,12 @@ namespace avro {
       base->decodeString(value);
     }
 
+    template <typename P>
+    void ValidatingDecoder<P>::decodeString(std::pmr::string& value) {
+      parser.advance(Symbol::sString);
+      base->decodeString(value);
+    }
+
     template <typename P>
     void ValidatingDecoder<P>::skipString() {
       parser.advance(Symbol::sString);
@@ -203,12 +237,96 @@ namespace avro {
       base->decodeBytes(value);
     }
 
+    template <typename P>
+    void ValidatingDecoder<P>::decodeBytes(std::pmr::vector<uint8_t>& value) {
+      parser.advance(Symbol::sBytes);
+      base->decodeBytes(value);
+    }
+
     template <typename P>
     void ValidatingDecoder<P>::skipBytes() {
       parser.advance(Symbol::sBytes);
       base->skipBytes();
     }
 
+    template <typename P>
+    size_t ValidatingDecoder<P>::arrayStart() {
+      parser.advance(Symbol::sArrayStart);
+      size_t result = base->arrayStart();
+      if (result == 0) {
+        parser.popRepeater();
+        parser.advance(Symbol::sArrayEnd);
+      } else {
+        parser.setRepeatCount(result);
+      }
+      return result;
+    }
+
+    template <typename P>
+    size_t ValidatingDecoder<P>::arrayNext() {
+      size_t result = base->arrayNext();
+      if (result == 0) {
+        parser.popRepeater();
+        parser.advance(Symbol::sArrayEnd);
+      } else {
+        parser.setRepeatCount(result);
+      }
+      return result;
+    }
+
+    template <typename P>
+    size_t ValidatingDecoder<P>::skipArray() {
+      parser.advance(Symbol::sArrayStart);
+      size_t n = base->skipArray();
+      if (n == 0) {
+        parser.pop();
+      } else {
+        parser.setRepeatCount(n);
+        parser.skip(*base);
+      }
+      parser.advance(Symbol::sArrayEnd);
+      return 0;
+    }
+
+    template <typename P>
+    size_t ValidatingDecoder<P>::mapStart() {
+      parser.advance(Symbol::sMapStart);
+      size_t result = base->mapStart();
+      if (result == 0) {
+        parser.popRepeater();
+        parser.advance(Symbol::sMapEnd);
+      } else {
+        parser.setRepeatCount(result);
+      }
+      return result;
+    }
+
+    template <typename P>
+    size_t ValidatingDecoder<P>::mapNext() {
+      size_t result = base->mapNext();
+      if (result == 0) {
+        parser.popRepeater();
+        parser.advance(Symbol::sMapEnd);
+      } else {
+        parser.setRepeatCount(result);
+      }
+      return result;
+    }
+
+    template <typename P>
+    size_t ValidatingDecoder<P>::skipMap() {
+      parser.advance(Symbol::sMapStart);
+      size_t n = base->skipMap();
+      if (n == 0) {
+        parser.pop();
+      } else {
+        parser.setRepeatCount(n);
+        parser.skip(*base);
+      }
+      parser.advance(Symbol::sMapEnd);
+      return 0;
+    }
+
     template <typename P>
     class ValidatingEncoder : public Encoder {
       DummyHandler handler_;
@@ -224,7 +342,12 @@ namespace avro {
       void encodeFloat(float f);
       void encodeDouble(double d);
       void encodeString(const std::string& s);
+      void encodeString(const char* s, size_t len);
       void encodeBytes(const uint8_t *bytes, size_t len);
+      void arrayStart();
+      void arrayEnd();
+      void mapStart();
+      void mapEnd();
       void setItemCount(size_t count);
       void startItem();
     public:
@@ -287,11 +410,43 @@ namespace avro {
       base_->encodeString(s);
     }
 
+    template<typename P>
+    void ValidatingEncoder<P>::encodeString(const char* s, size_t len) {
+      parser_.advance(Symbol::sString);
+      base_->encodeString(s, len);
+    }
+
     template<typename P>
     void ValidatingEncoder<P>::encodeBytes(const uint8_t *bytes, size_t len) {
       parser_.advance(Symbol::sBytes);
       base_->encodeBytes(bytes, len);
-    }  
+    }
+
+    template<typename P>
+    void ValidatingEncoder<P>::arrayStart() {
+      parser_.advance(Symbol::sArrayStart);
+      base_->arrayStart();
+    }
+
+    template<typename P>
+    void ValidatingEncoder<P>::arrayEnd() {
+      parser_.popRepeater();
+      parser_.advance(Symbol::sArrayEnd);
+      base_->arrayEnd();
+    }
+
+    template<typename P>
+    void ValidatingEncoder<P>::mapStart() {
+      parser_.advance(Symbol::sMapStart);
+      base_->mapStart();
+    }
+
+    template<typename P>
+    void ValidatingEncoder<P>::mapEnd() {
+      parser_.popRepeater();
+      parser_.advance(Symbol::sMapEnd);
+      base_->mapEnd();
+    }
 
     template<typename P>
     void ValidatingEncoder<P>::setItemCount(size_t count) {
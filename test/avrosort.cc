@@ -0,0 +1,76 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <iostream>
+#include <fstream>
+#include <boost/algorithm/string.hpp>
+#include <boost/program_options.hpp>
+
+#include "Compiler.hh"
+#include "ExternalSort.hh"
+
+namespace po = boost::program_options;
+
+/* Sorts a file of binary encoded datums, written one after the other, by the sort order of their schema or by some of its fields.*/
+int main(int argc, char** argv) {
+  po::options_description desc("Allowed options");
+  desc.add_options()
+    ("help,h", "produce help message")
+    ("schema,s", po::value<std::string>(), "schema file")
+    ("key,k", po::value<std::string>(), "comma separated fields of the record to sort by, default: the whole record")
+    ("run-size,r", po::value<size_t>()->default_value(64), "megabytes of input sorted in memory at a time")
+    ("threads,t", po::value<size_t>()->default_value(0), "threads to sort and merge on, default: one per core")
+    ("temp-dir,d", po::value<std::string>()->default_value(""), "directory of the temporary files, default: TMPDIR or /tmp")
+    ("input,i", po::value<std::string>(), "input file, default: standard input")
+    ("output,o", po::value<std::string>(), "output file, default: standard output");
+
+  po::variables_map vm;
+  po::store(po::parse_command_line(argc, argv, desc), vm);
+  po::notify(vm);
+
+  if (vm.count("help") || vm.count("schema") == 0) {
+    std::cout << desc << std::endl;
+    return 1;
+  }
+
+  try {
+    avro::ValidSchema schema;
+    std::ifstream schemaFile(vm["schema"].as<std::string>().c_str());
+    avro::compileJsonSchema(schemaFile, schema);
+
+    std::vector<std::string> keys;
+    if (vm.count("key")) {
+      boost::algorithm::split(keys, vm["key"].as<std::string>(), boost::algorithm::is_any_of(","));
+    }
+    avro::CompiledSchema compiled = keys.empty() ? avro::CompiledSchema(schema) : avro::CompiledSchema(schema, keys);
+    avro::ExternalSorter sorter(compiled, vm["run-size"].as<size_t>() * 1024 * 1024, vm["threads"].as<size_t>(),
+      vm["temp-dir"].as<std::string>());
+
+    std::shared_ptr<avro::InputStream> in = vm.count("input") ?
+      avro::fileInputStream(vm["input"].as<std::string>().c_str(), 64 * 1024) : avro::istreamInputStream(std::cin, 64 * 1024);
+    std::shared_ptr<avro::OutputStream> out = vm.count("output") ?
+      avro::fileOutputStream(vm["output"].as<std::string>().c_str(), 64 * 1024) : avro::ostreamOutputStream(std::cout, 64 * 1024);
+    size_t count = sorter.sort(*in, *out);
+    std::cerr << "Sorted " << count << " datums in " << sorter.spilledRuns() << " runs" << std::endl;
+  } catch (std::exception &e) {
+    std::cerr << "Failed to sort: " << e.what() << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,167 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <catch.hpp>
+#include "AsyncStream.hh"
+#include "Compiler.hh"
+#include "Encoder.hh"
+#include "gen/primitivetypes.hh"
+#include "unistd.h"
+#include "sys/socket.h"
+
+#ifndef AVRO_HAS_COROUTINES
+#error "The coroutine tests need a compiler with C++20 coroutines"
+#endif
+
+namespace avro {
+  namespace coroutine {
+
+    static const char schemaJson[] = "{\"name\": \"TestPrimitiveTypes\", \"type\": \"record\", \"fields\": ["
+      "{ \"name\": \"Null\", \"type\": \"null\" },"
+      "{ \"name\": \"Boolean\", \"type\": \"boolean\" },"
+      "{ \"name\": \"Int\", \"type\": \"int\" },"
+      "{ \"name\": \"Long\", \"type\": \"long\" },"
+      "{ \"name\": \"Float\", \"type\": \"float\" },"
+      "{ \"name\": \"Double\", \"type\": \"double\" },"
+      "{ \"name\": \"Bytes\", \"type\": \"bytes\" },"
+      "{ \"name\": \"String\", \"type\": \"string\" },"
+      "{ \"name\": \"SecondNull\", \"type\": \"null\" }"
+      "]}";
+
+    pt::TestPrimitiveTypes makeRecord(int i) {
+      pt::TestPrimitiveTypes r;
+      r.Boolean = (i % 2 == 0);
+      r.Int = -i;
+      r.Long = static_cast<int64_t> (i) << 40;
+      r.Float = i / 2.0f;
+      r.Double = i * 1.5;
+      r.Bytes.assign(i % 50 * 7, static_cast<uint8_t> (i));
+      r.String.assign(i % 50 * 13, 'a' + i % 26);
+      return r;
+    }
+
+    /* A coroutine that runs on its own from the start and is not waited for.*/
+    struct Detached {
+
+      struct promise_type {
+
+        Detached get_return_object() {
+          return Detached();
+        }
+
+        std::suspend_never initial_suspend() {
+          return std::suspend_never();
+        }
+
+        std::suspend_never final_suspend() noexcept {
+          return std::suspend_never();
+        }
+
+        void return_void() { }
+
+        void unhandled_exception() {
+          std::terminate();
+        }
+      };
+    };
+
+    struct Progress {
+      int received;
+      int chunks;
+      bool inOrder;
+      bool ended;
+      std::string error;
+    };
+
+    /* Decodes the records of in as its chunks are co_awaited, the way AsyncDatumReader does from callbacks.*/
+    Detached readRecords(AsyncInputStream& in, const ValidSchema& schema, Progress& progress) {
+      try {
+        ResumableDecoder decoder(schema);
+        pt::TestPrimitiveTypes r;
+        for (;;) {
+          std::pair<const uint8_t*, size_t> chunk = co_await in.next();
+          ++progress.chunks;
+          if (chunk.second == 0) {
+            if (decoder.partialBytes() != 0) {
+              progress.error = "The stream ended within a datum";
+            }
+            progress.ended = true;
+            co_return;
+          }
+          while (chunk.second > 0) {
+            size_t consumed;
+            if (decoder.decode(chunk.first, chunk.second, consumed, r) == DecodeStatus::DATUM_READY) {
+              pt::TestPrimitiveTypes expected = makeRecord(progress.received++);
+              progress.inOrder = progress.inOrder && r.Int == expected.Int && r.Long == expected.Long &&
+                r.Bytes == expected.Bytes && r.String == expected.String;
+            }
+            chunk.first += consumed;
+            chunk.second -= consumed;
+          }
+        }
+      } catch (std::exception& e) {
+        progress.error = e.what();
+        progress.ended = true;
+      }
+    }
+
+    TEST_CASE("Async coroutines: testCoAwait", "[testCoAwait]") {
+      ValidSchema schema = compileJsonSchemaFromString(schemaJson);
+      const int count = 300;
+      size_t chunkSizes[] = {7, 1000, 64 * 1024};
+      for (size_t chunkSize : chunkSizes) {
+        EpollReactor reactor;
+        int fds[2];
+        REQUIRE(::socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, fds) == 0);
+        Progress progress = {0, 0, true, false, ""};
+        {
+          AsyncInputStream in(reactor, fds[1], chunkSize);
+          // nothing has been written yet, so the first co_await suspends until the reactor finds the socket readable
+          readRecords(in, schema, progress);
+          REQUIRE(progress.chunks == 0);
+          REQUIRE(reactor.contains(fds[1]));
+
+          {
+            AsyncOutputStream out(reactor, fds[0]);
+            EncoderPtr e = binaryEncoder();
+            e->init(out);
+            for (int i = 0; i < count; ++i) {
+              avro::encode(*e, makeRecord(i));
+              if (i % 10 == 9) {
+                e->flush();
+              }
+            }
+            e->flush();
+            while (out.pendingBytes() > 0) {
+              reactor.poll();
+            }
+          }
+          ::close(fds[0]);
+          while (!progress.ended) {
+            reactor.poll();
+          }
+        }
+        ::close(fds[1]);
+        REQUIRE(progress.error == "");
+        REQUIRE(progress.received == count);
+        REQUIRE(progress.inOrder);
+        REQUIRE(progress.chunks > 1);
+      }
+    }
+
+  }
+}
@@ -0,0 +1,115 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef ORDERED_HH_2542349456__H_
+#define ORDERED_HH_2542349456__H_
+
+
+#include <sstream>
+#include "boost/any.hpp"
+#include "Specific.hh"
+#include "RecordTraits.hh"
+#include "Encoder.hh"
+#include "Decoder.hh"
+#include "Schema.hh"
+
+namespace ord {
+
+  struct Ordered {
+    int32_t k;
+    std::string v;
+    int64_t w;
+
+    Ordered() :
+    k(int32_t()),
+    v(std::string()),
+    w(int64_t()) { }
+    static constexpr const char schemaJson[] =
+      "{\"name\":\"Ordered\",\"type\":\"record\",\"fields\":[{\"name\":\"k\",\"type\":\"int\"},{\"name\":\"v\",\"type\":\"string\"},{\"name\":\"w\",\"type\":\"long\"}]}";
+    static constexpr uint64_t schemaFingerprint = 0x639997a1dc063b9dULL;
+    static const avro::ValidSchema& schema();
+  };
+
+  inline const avro::ValidSchema& Ordered::schema() {
+    static const avro::ValidSchema s([] {
+      avro::RecordSchema r0("Ordered");
+      r0.addField("k", avro::IntSchema(), avro::FieldOrder::DESCENDING);
+      r0.addField("v", avro::StringSchema(), avro::FieldOrder::IGNORE);
+      r0.addField("w", avro::LongSchema());
+      return avro::ValidSchema(r0);
+    }());
+    return s;
+  }
+
+}
+namespace avro {
+
+  template<> struct codec_traits<ord::Ordered> {
+
+    static void encode(Encoder& e, const ord::Ordered& v) {
+      avro::encode(e, v.k);
+      avro::encode(e, v.v);
+      avro::encode(e, v.w);
+    }
+
+    static void decode(Decoder& d, ord::Ordered& v) {
+      if (avro::ResolvingDecoder * rd =
+        dynamic_cast<avro::ResolvingDecoder *> (&d)) {
+        const std::vector<size_t> fo = rd->fieldOrder();
+        for (std::vector<size_t>::const_iterator it = fo.begin();
+          it != fo.end(); ++it) {
+          switch (*it) {
+            case 0:
+              avro::decode(d, v.k);
+              break;
+            case 1:
+              avro::decode(d, v.v);
+              break;
+            case 2:
+              avro::decode(d, v.w);
+              break;
+            default:
+              break;
+          }
+        }
+      } else {
+        avro::decode(d, v.k);
+        avro::decode(d, v.v);
+        avro::decode(d, v.w);
+      }
+    }
+
+    static size_t encodedSize(const ord::Ordered& v) {
+      return 0
+        + avro::encodedSize(v.k)
+        + avro::encodedSize(v.v)
+        + avro::encodedSize(v.w);
+    }
+  };
+
+  template<> struct record_traits<ord::Ordered> {
+    static constexpr size_t fieldCount = 3;
+    static constexpr auto fields = std::make_tuple(
+      avro::makeField("k", 0, &ord::Ordered::k, avro::Type::AVRO_INT),
+      avro::makeField("v", 1, &ord::Ordered::v, avro::Type::AVRO_STRING),
+      avro::makeField("w", 2, &ord::Ordered::w, avro::Type::AVRO_LONG));
+  };
+
+}
+#endif
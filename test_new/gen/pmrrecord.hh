@@ -0,0 +1,224 @@
+/**
+* Licensed to the Apache Software Foundation (ASF) under one
+* or more contributor license agreements.  See the NOTICE file
+* distributed with this work for additional information
+* regarding copyright ownership.  The ASF licenses this file
+* to you under the Apache License, Version 2.0 (the
+* "License"); you may not use this file except in compliance
+* with the License.  You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+
+#ifndef PMRRECORD_HH_2080807734__H_
+#define PMRRECORD_HH_2080807734__H_
+
+
+#include <sstream>
+#include <memory_resource>
+#include "boost/any.hpp"
+#include "Specific.hh"
+#include "RecordTraits.hh"
+#include "Encoder.hh"
+#include "Decoder.hh"
+#include "Schema.hh"
+
+namespace pm {
+
+  struct Sender {
+    std::pmr::string name;
+    std::pmr::vector<uint8_t> avatar;
+
+    typedef std::pmr::polymorphic_allocator<char> allocator_type;
+    Sender() : Sender(allocator_type()) { }
+    explicit Sender(const allocator_type& alloc) :
+      name(alloc),
+      avatar(alloc) { }
+    Sender(const Sender& other, const allocator_type& alloc) :
+      name(other.name, alloc),
+      avatar(other.avatar, alloc) { }
+    Sender(const Sender&) = default;
+    Sender(Sender&&) = default;
+    Sender& operator=(const Sender&) = default;
+    Sender& operator=(Sender&&) = default;
+  };
+
+  struct Message {
+    int64_t id;
+    std::pmr::string text;
+    std::pmr::vector<uint8_t> payload;
+    Sender sender;
+    std::pmr::vector<std::pmr::string > tags;
+    std::pmr::map<std::pmr::string, std::pmr::vector<uint8_t> > headers;
+
+    typedef std::pmr::polymorphic_allocator<char> allocator_type;
+    Message() : Message(allocator_type()) { }
+    explicit Message(const allocator_type& alloc) :
+      id(int64_t()),
+      text(alloc),
+      payload(alloc),
+      sender(alloc),
+      tags(alloc),
+      headers(alloc) { }
+    Message(const Message& other, const allocator_type& alloc) :
+      id(other.id),
+      text(other.text, alloc),
+      payload(other.payload, alloc),
+      sender(other.sender, alloc),
+      tags(other.tags, alloc),
+      headers(other.headers, alloc) { }
+    Message(const Message&) = default;
+    Message(Message&&) = default;
+    Message& operator=(const Message&) = default;
+    Message& operator=(Message&&) = default;
+    static constexpr const char schemaJson[] =
+      "{\"name\":\"Message\",\"type\":\"record\",\"fields\":[{\"name\":\"id\",\"type\":\"long\"},{\"name\":\"text\",\"type\":\"string\"},{\"name\":\"payload\",\"type\":\"bytes\"},{\"name\":\"sender\",\"type\":{\"name\":\"Sender\",\"type\":\"record\",\"fields\":[{\"name\":\"name\",\"type\":\"string\"},{\"name\":\"avatar\",\"type\":\"bytes\"}]}},{\"name\":\"tags\",\"type\":{\"type\":\"array\",\"items\":\"string\"}},{\"name\":\"headers\",\"type\":{\"type\":\"map\",\"values\":\"bytes\"}}]}";
+    static constexpr uint64_t schemaFingerprint = 0xe2190e9a8818efa0ULL;
+    static const avro::ValidSchema& schema();
+  };
+
+  inline const avro::ValidSchema& Message::schema() {
+    static const avro::ValidSchema s([] {
+      avro::RecordSchema r0("Message");
+      avro::RecordSchema r1("Sender");
+      r1.addField("name", avro::StringSchema());
+      r1.addField("avatar", avro::BytesSchema());
+      r0.addField("id", avro::LongSchema());
+      r0.addField("text", avro::StringSchema());
+      r0.addField("payload", avro::BytesSchema());
+      r0.addField("sender", r1);
+      r0.addField("tags", avro::ArraySchema(avro::StringSchema()));
+      r0.addField("headers", avro::MapSchema(avro::BytesSchema()));
+      return avro::ValidSchema(r0);
+    }());
+    return s;
+  }
+
+}
+namespace avro {
+
+  template<> struct codec_traits<pm::Sender> {
+
+    static void encode(Encoder& e, const pm::Sender& v) {
+      avro::encode(e, v.name);
+      avro::encode(e, v.avatar);
+    }
+
+    static void decode(Decoder& d, pm::Sender& v) {
+      if (avro::ResolvingDecoder * rd =
+        dynamic_cast<avro::ResolvingDecoder *> (&d)) {
+        const std::vector<size_t> fo = rd->fieldOrder();
+        for (std::vector<size_t>::const_iterator it = fo.begin();
+          it != fo.end(); ++it) {
+          switch (*it) {
+            case 0:
+              avro::decode(d, v.name);
+              break;
+            case 1:
+              avro::decode(d, v.avatar);
+              break;
+            default:
+              break;
+          }
+        }
+      } else {
+        avro::decode(d, v.name);
+        avro::decode(d, v.avatar);
+      }
+    }
+
+    static size_t encodedSize(const pm::Sender& v) {
+      return 0
+        + avro::encodedSize(v.name)
+        + avro::encodedSize(v.avatar);
+    }
+  };
+
+  template<> struct record_traits<pm::Sender> {
+    static constexpr size_t fieldCount = 2;
+    static constexpr auto fields = std::make_tuple(
+      avro::makeField("name", 0, &pm::Sender::name, avro::Type::AVRO_STRING),
+      avro::makeField("avatar", 1, &pm::Sender::avatar, avro::Type::AVRO_BYTES));
+  };
+
+  template<> struct codec_traits<pm::Message> {
+
+    static void encode(Encoder& e, const pm::Message& v) {
+      avro::encode(e, v.id);
+      avro::encode(e, v.text);
+      avro::encode(e, v.payload);
+      avro::encode(e, v.sender);
+      avro::encode(e, v.tags);
+      avro::encode(e, v.headers);
+    }
+
+    static void decode(Decoder& d, pm::Message& v) {
+      if (avro::ResolvingDecoder * rd =
+        dynamic_cast<avro::ResolvingDecoder *> (&d)) {
+        const std::vector<size_t> fo = rd->fieldOrder();
+        for (std::vector<size_t>::const_iterator it = fo.begin();
+          it != fo.end(); ++it) {
+          switch (*it) {
+            case 0:
+              avro::decode(d, v.id);
+              break;
+            case 1:
+              avro::decode(d, v.text);
+              break;
+            case 2:
+              avro::decode(d, v.payload);
+              break;
+            case 3:
+              avro::decode(d, v.sender);
+              break;
+            case 4:
+              avro::decode(d, v.tags);
+              break;
+            case 5:
+              avro::decode(d, v.headers);
+              break;
+            default:
+              break;
+          }
+        }
+      } else {
+        avro::decode(d, v.id);
+        avro::decode(d, v.text);
+        avro::decode(d, v.payload);
+        avro::decode(d, v.sender);
+        avro::decode(d, v.tags);
+        avro::decode(d, v.headers);
+      }
+    }
+
+    static size_t encodedSize(const pm::Message& v) {
+      return 0
+        + avro::encodedSize(v.id)
+        + avro::encodedSize(v.text)
+        + avro::encodedSize(v.payload)
+        + avro::encodedSize(v.sender)
+        + avro::encodedSize(v.tags)
+        + avro::encodedSize(v.headers);
+    }
+  };
+
+  template<> struct record_traits<pm::Message> {
+    static constexpr size_t fieldCount = 6;
+    static constexpr auto fields = std::make_tuple(
+      avro::makeField("id", 0, &pm::Message::id, avro::Type::AVRO_LONG),
+      avro::makeField("text", 1, &pm::Message::text, avro::Type::AVRO_STRING),
+      avro::makeField("payload", 2, &pm::Message::payload, avro::Type::AVRO_BYTES),
+      avro::makeField("sender", 3, &pm::Message::sender, avro::Type::AVRO_RECORD),
+      avro::makeField("tags", 4, &pm::Message::tags, avro::Type::AVRO_ARRAY),
+      avro::makeField("headers", 5, &pm::Message::headers, avro::Type::AVRO_MAP));
+  };
+
+}
+#endif
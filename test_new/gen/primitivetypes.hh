@@ -22,10 +22,14 @@
 
 
 #include <sstream>
+#include <string_view>
 #include "boost/any.hpp"
 #include "Specific.hh"
+#include "RecordTraits.hh"
 #include "Encoder.hh"
 #include "Decoder.hh"
+#include "Schema.hh"
+#include "ViewDecoder.hh"
 
 namespace pt {
 
@@ -50,8 +54,53 @@ namespace pt {
     Bytes(std::vector<uint8_t>()),
     String(std::string()),
     SecondNull(avro::null()) { }
+    static constexpr const char schemaJson[] =
+      "{\"name\":\"TestPrimitiveTypes\",\"type\":\"record\",\"fields\":[{\"name\":\"Null\",\"type\":\"null\"},{\"name\":\"Boolean\",\"type\":\"boolean\"},{\"name\":\"Int\",\"type\":\"int\"},{\"name\":\"Long\",\"type\":\"long\"},{\"name\":\"Float\",\"type\":\"float\"},{\"name\":\"Double\",\"type\":\"double\"},{\"name\":\"Bytes\",\"type\":\"bytes\"},{\"name\":\"String\",\"type\":\"string\"},{\"name\":\"SecondNull\",\"type\":\"null\"}]}";
+    static constexpr uint64_t schemaFingerprint = 0x7524cd77314d3cc1ULL;
+    static const avro::ValidSchema& schema();
   };
 
+  /* A view of TestPrimitiveTypes decoded in place, valid only while the decoded memory is. */
+  struct TestPrimitiveTypesView {
+    avro::null Null;
+    bool Boolean;
+    int32_t Int;
+    int64_t Long;
+    float Float;
+    double Double;
+    avro::BytesView Bytes;
+    std::string_view String;
+    avro::null SecondNull;
+
+    TestPrimitiveTypesView() :
+    Null(avro::null()),
+    Boolean(bool()),
+    Int(int32_t()),
+    Long(int64_t()),
+    Float(float()),
+    Double(double()),
+    Bytes(avro::BytesView()),
+    String(std::string_view()),
+    SecondNull(avro::null()) { }
+  };
+
+  inline const avro::ValidSchema& TestPrimitiveTypes::schema() {
+    static const avro::ValidSchema s([] {
+      avro::RecordSchema r0("TestPrimitiveTypes");
+      r0.addField("Null", avro::NullSchema());
+      r0.addField("Boolean", avro::BoolSchema());
+      r0.addField("Int", avro::IntSchema());
+      r0.addField("Long", avro::LongSchema());
+      r0.addField("Float", avro::FloatSchema());
+      r0.addField("Double", avro::DoubleSchema());
+      r0.addField("Bytes", avro::BytesSchema());
+      r0.addField("String", avro::StringSchema());
+      r0.addField("SecondNull", avro::NullSchema());
+      return avro::ValidSchema(r0);
+    }());
+    return s;
+  }
+
 }
 namespace avro {
 
@@ -119,6 +168,62 @@ namespace avro {
         avro::decode(d, v.SecondNull);
       }
     }
+
+    static size_t encodedSize(const pt::TestPrimitiveTypes& v) {
+      return 0
+        + avro::encodedSize(v.Null)
+        + avro::encodedSize(v.Boolean)
+        + avro::encodedSize(v.Int)
+        + avro::encodedSize(v.Long)
+        + avro::encodedSize(v.Float)
+        + avro::encodedSize(v.Double)
+        + avro::encodedSize(v.Bytes)
+        + avro::encodedSize(v.String)
+        + avro::encodedSize(v.SecondNull);
+    }
+  };
+
+  template<> struct record_traits<pt::TestPrimitiveTypes> {
+    static constexpr size_t fieldCount = 9;
+    static constexpr auto fields = std::make_tuple(
+      avro::makeField("Null", 0, &pt::TestPrimitiveTypes::Null, avro::Type::AVRO_NULL),
+      avro::makeField("Boolean", 1, &pt::TestPrimitiveTypes::Boolean, avro::Type::AVRO_BOOL),
+      avro::makeField("Int", 2, &pt::TestPrimitiveTypes::Int, avro::Type::AVRO_INT),
+      avro::makeField("Long", 3, &pt::TestPrimitiveTypes::Long, avro::Type::AVRO_LONG),
+      avro::makeField("Float", 4, &pt::TestPrimitiveTypes::Float, avro::Type::AVRO_FLOAT),
+      avro::makeField("Double", 5, &pt::TestPrimitiveTypes::Double, avro::Type::AVRO_DOUBLE),
+      avro::makeField("Bytes", 6, &pt::TestPrimitiveTypes::Bytes, avro::Type::AVRO_BYTES),
+      avro::makeField("String", 7, &pt::TestPrimitiveTypes::String, avro::Type::AVRO_STRING),
+      avro::makeField("SecondNull", 8, &pt::TestPrimitiveTypes::SecondNull, avro::Type::AVRO_NULL));
+  };
+
+  template<> struct view_traits<pt::TestPrimitiveTypesView> {
+
+    static void decode(ViewDecoder& d, pt::TestPrimitiveTypesView& v) {
+      avro::decodeView(d, v.Null);
+      avro::decodeView(d, v.Boolean);
+      avro::decodeView(d, v.Int);
+      avro::decodeView(d, v.Long);
+      avro::decodeView(d, v.Float);
+      avro::decodeView(d, v.Double);
+      avro::decodeView(d, v.Bytes);
+      avro::decodeView(d, v.String);
+      avro::decodeView(d, v.SecondNull);
+    }
+  };
+
+  template<> struct record_traits<pt::TestPrimitiveTypesView> {
+    static constexpr size_t fieldCount = 9;
+    static constexpr auto fields = std::make_tuple(
+      avro::makeField("Null", 0, &pt::TestPrimitiveTypesView::Null, avro::Type::AVRO_NULL),
+      avro::makeField("Boolean", 1, &pt::TestPrimitiveTypesView::Boolean, avro::Type::AVRO_BOOL),
+      avro::makeField("Int", 2, &pt::TestPrimitiveTypesView::Int, avro::Type::AVRO_INT),
+      avro::makeField("Long", 3, &pt::TestPrimitiveTypesView::Long, avro::Type::AVRO_LONG),
+      avro::makeField("Float", 4, &pt::TestPrimitiveTypesView::Float, avro::Type::AVRO_FLOAT),
+      avro::makeField("Double", 5, &pt::TestPrimitiveTypesView::Double, avro::Type::AVRO_DOUBLE),
+      avro::makeField("Bytes", 6, &pt::TestPrimitiveTypesView::Bytes, avro::Type::AVRO_BYTES),
+      avro::makeField("String", 7, &pt::TestPrimitiveTypesView::String, avro::Type::AVRO_STRING),
+      avro::makeField("SecondNull", 8, &pt::TestPrimitiveTypesView::SecondNull, avro::Type::AVRO_NULL));
   };
 
 }
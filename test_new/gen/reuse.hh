@@ -24,8 +24,10 @@
 #include <sstream>
 #include "boost/any.hpp"
 #include "Specific.hh"
+#include "RecordTraits.hh"
 #include "Encoder.hh"
 #include "Decoder.hh"
+#include "Schema.hh"
 
 namespace ru {
 
@@ -45,8 +47,25 @@ namespace ru {
     outer() :
     f1(F()),
     f2(F()) { }
+    static constexpr const char schemaJson[] =
+      "{\"name\":\"outer\",\"type\":\"record\",\"fields\":[{\"name\":\"f1\",\"type\":{\"name\":\"F\",\"type\":\"record\",\"fields\":[{\"name\":\"g1\",\"type\":\"boolean\"},{\"name\":\"g2\",\"type\":\"int\"}]}},{\"name\":\"f2\",\"type\":\"F\"}]}";
+    static constexpr uint64_t schemaFingerprint = 0x2767f6b6d34a190fULL;
+    static const avro::ValidSchema& schema();
   };
 
+  inline const avro::ValidSchema& outer::schema() {
+    static const avro::ValidSchema s([] {
+      avro::RecordSchema r0("outer");
+      avro::RecordSchema r1("F");
+      r1.addField("g1", avro::BoolSchema());
+      r1.addField("g2", avro::IntSchema());
+      r0.addField("f1", r1);
+      r0.addField("f2", r1);
+      return avro::ValidSchema(r0);
+    }());
+    return s;
+  }
+
 }
 namespace avro {
 
@@ -79,6 +98,19 @@ namespace avro {
         avro::decode(d, v.g2);
       }
     }
+
+    static size_t encodedSize(const ru::F& v) {
+      return 0
+        + avro::encodedSize(v.g1)
+        + avro::encodedSize(v.g2);
+    }
+  };
+
+  template<> struct record_traits<ru::F> {
+    static constexpr size_t fieldCount = 2;
+    static constexpr auto fields = std::make_tuple(
+      avro::makeField("g1", 0, &ru::F::g1, avro::Type::AVRO_BOOL),
+      avro::makeField("g2", 1, &ru::F::g2, avro::Type::AVRO_INT));
   };
 
   template<> struct codec_traits<ru::outer> {
@@ -110,6 +142,19 @@ namespace avro {
         avro::decode(d, v.f2);
       }
     }
+
+    static size_t encodedSize(const ru::outer& v) {
+      return 0
+        + avro::encodedSize(v.f1)
+        + avro::encodedSize(v.f2);
+    }
+  };
+
+  template<> struct record_traits<ru::outer> {
+    static constexpr size_t fieldCount = 2;
+    static constexpr auto fields = std::make_tuple(
+      avro::makeField("f1", 0, &ru::outer::f1, avro::Type::AVRO_RECORD),
+      avro::makeField("f2", 1, &ru::outer::f2, avro::Type::AVRO_RECORD));
   };
 
 }
@@ -24,8 +24,10 @@
 #include <sstream>
 #include "boost/any.hpp"
 #include "Specific.hh"
+#include "RecordTraits.hh"
 #include "Encoder.hh"
 #include "Decoder.hh"
+#include "Schema.hh"
 
 namespace tr1 {
   struct Edge;
@@ -37,6 +39,10 @@ namespace tr1 {
     Node() :
     payload(int32_t()),
     edges(std::vector<Edge >()) { }
+    static constexpr const char schemaJson[] =
+      "{\"name\":\"Node\",\"type\":\"record\",\"fields\":[{\"name\":\"payload\",\"type\":\"int\"},{\"name\":\"edges\",\"type\":{\"type\":\"array\",\"items\":{\"name\":\"Edge\",\"type\":\"record\",\"fields\":[{\"name\":\"child\",\"type\":\"Node\"},{\"name\":\"label\",\"type\":\"string\"}]}}}]}";
+    static constexpr uint64_t schemaFingerprint = 0x923fd2ce43b6a04aULL;
+    static const avro::ValidSchema& schema();
   };
 
   struct Edge {
@@ -48,6 +54,19 @@ namespace tr1 {
     label(std::string()) { }
   };
 
+  inline const avro::ValidSchema& Node::schema() {
+    static const avro::ValidSchema s([] {
+      avro::RecordSchema r0("Node");
+      avro::RecordSchema r1("Edge");
+      r1.addField("child", avro::SymbolicSchema(avro::Name("Node"), r0.root()));
+      r1.addField("label", avro::StringSchema());
+      r0.addField("payload", avro::IntSchema());
+      r0.addField("edges", avro::ArraySchema(r1));
+      return avro::ValidSchema(r0);
+    }());
+    return s;
+  }
+
 }
 namespace avro {
 
@@ -80,6 +99,19 @@ namespace avro {
         avro::decode(d, v.label);
       }
     }
+
+    static size_t encodedSize(const tr1::Edge& v) {
+      return 0
+        + avro::encodedSize(v.child)
+        + avro::encodedSize(v.label);
+    }
+  };
+
+  template<> struct record_traits<tr1::Edge> {
+    static constexpr size_t fieldCount = 2;
+    static constexpr auto fields = std::make_tuple(
+      avro::makeField("child", 0, &tr1::Edge::child, avro::Type::AVRO_RECORD),
+      avro::makeField("label", 1, &tr1::Edge::label, avro::Type::AVRO_STRING));
   };
 
   template<> struct codec_traits<tr1::Node> {
@@ -111,6 +143,19 @@ namespace avro {
         avro::decode(d, v.edges);
       }
     }
+
+    static size_t encodedSize(const tr1::Node& v) {
+      return 0
+        + avro::encodedSize(v.payload)
+        + avro::encodedSize(v.edges);
+    }
+  };
+
+  template<> struct record_traits<tr1::Node> {
+    static constexpr size_t fieldCount = 2;
+    static constexpr auto fields = std::make_tuple(
+      avro::makeField("payload", 0, &tr1::Node::payload, avro::Type::AVRO_INT),
+      avro::makeField("edges", 1, &tr1::Node::edges, avro::Type::AVRO_ARRAY));
   };
 
 }
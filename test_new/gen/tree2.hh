@@ -24,8 +24,10 @@
 #include <sstream>
 #include "boost/any.hpp"
 #include "Specific.hh"
+#include "RecordTraits.hh"
 #include "Encoder.hh"
 #include "Decoder.hh"
+#include "Schema.hh"
 
 namespace tr2 {
   struct Node;
@@ -37,8 +39,22 @@ namespace tr2 {
     Node() :
     payload(int32_t()),
     edges(std::map<std::string, Node >()) { }
+    static constexpr const char schemaJson[] =
+      "{\"name\":\"Node\",\"type\":\"record\",\"fields\":[{\"name\":\"payload\",\"type\":\"int\"},{\"name\":\"edges\",\"type\":{\"type\":\"map\",\"values\":\"Node\"}}]}";
+    static constexpr uint64_t schemaFingerprint = 0xbfbeb536974cedcbULL;
+    static const avro::ValidSchema& schema();
   };
 
+  inline const avro::ValidSchema& Node::schema() {
+    static const avro::ValidSchema s([] {
+      avro::RecordSchema r0("Node");
+      r0.addField("payload", avro::IntSchema());
+      r0.addField("edges", avro::MapSchema(avro::SymbolicSchema(avro::Name("Node"), r0.root())));
+      return avro::ValidSchema(r0);
+    }());
+    return s;
+  }
+
 }
 namespace avro {
 
@@ -71,6 +87,19 @@ namespace avro {
         avro::decode(d, v.edges);
       }
     }
+
+    static size_t encodedSize(const tr2::Node& v) {
+      return 0
+        + avro::encodedSize(v.payload)
+        + avro::encodedSize(v.edges);
+    }
+  };
+
+  template<> struct record_traits<tr2::Node> {
+    static constexpr size_t fieldCount = 2;
+    static constexpr auto fields = std::make_tuple(
+      avro::makeField("payload", 0, &tr2::Node::payload, avro::Type::AVRO_INT),
+      avro::makeField("edges", 1, &tr2::Node::edges, avro::Type::AVRO_MAP));
   };
 
 }
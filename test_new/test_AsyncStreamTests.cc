@@ -0,0 +1,229 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <catch.hpp>
+#include "AsyncStream.hh"
+#include "Compiler.hh"
+#include "Encoder.hh"
+#include "gen/primitivetypes.hh"
+#include "unistd.h"
+#include "fcntl.h"
+#include "sys/socket.h"
+
+namespace avro {
+  namespace async {
+
+    static const char schemaJson[] = "{\"name\": \"TestPrimitiveTypes\", \"type\": \"record\", \"fields\": ["
+      "{ \"name\": \"Null\", \"type\": \"null\" },"
+      "{ \"name\": \"Boolean\", \"type\": \"boolean\" },"
+      "{ \"name\": \"Int\", \"type\": \"int\" },"
+      "{ \"name\": \"Long\", \"type\": \"long\" },"
+      "{ \"name\": \"Float\", \"type\": \"float\" },"
+      "{ \"name\": \"Double\", \"type\": \"double\" },"
+      "{ \"name\": \"Bytes\", \"type\": \"bytes\" },"
+      "{ \"name\": \"String\", \"type\": \"string\" },"
+      "{ \"name\": \"SecondNull\", \"type\": \"null\" }"
+      "]}";
+
+    pt::TestPrimitiveTypes makeRecord(int i) {
+      pt::TestPrimitiveTypes r;
+      r.Boolean = (i % 2 == 0);
+      r.Int = -i;
+      r.Long = static_cast<int64_t> (i) << 40;
+      r.Float = i / 2.0f;
+      r.Double = i * 1.5;
+      r.Bytes.assign(i % 50 * 7, static_cast<uint8_t> (i));
+      r.String.assign(i % 50 * 13, 'a' + i % 26);
+      return r;
+    }
+
+    /* One stream of records from a writing socket to a reading socket, both served by the same reactor.*/
+    struct Connection {
+      int fds[2];
+      int received;
+      int ended;
+      bool inOrder;
+      std::unique_ptr<AsyncOutputStream> out;
+      std::unique_ptr<AsyncDatumReader<pt::TestPrimitiveTypes> > reader;
+
+      Connection(EpollReactor& reactor, const ValidSchema& schema, size_t chunkSize) : received(0), ended(0), inOrder(true) {
+        REQUIRE(::socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, fds) == 0);
+        out.reset(new AsyncOutputStream(reactor, fds[0]));
+        reader.reset(new AsyncDatumReader<pt::TestPrimitiveTypes>(reactor, fds[1], schema,
+          [this](pt::TestPrimitiveTypes & r) {
+            pt::TestPrimitiveTypes expected = makeRecord(received++);
+            inOrder = inOrder && r.Int == expected.Int && r.Long == expected.Long && r.Bytes == expected.Bytes &&
+              r.String == expected.String;
+          },
+        [this]() {
+          ++ended;
+        }, pt::TestPrimitiveTypes(), chunkSize));
+        reader->start();
+      }
+
+      ~Connection() {
+        reader.reset();
+        out.reset();
+        ::close(fds[1]);
+        if (fds[0] >= 0) {
+          ::close(fds[0]);
+        }
+      }
+
+      /* Writes the records and closes the writing end once they are all out.*/
+      void send(int count) {
+        EncoderPtr e = binaryEncoder();
+        e->init(*out);
+        for (int i = 0; i < count; ++i) {
+          avro::encode(*e, makeRecord(i));
+          if (i % 10 == 9) {
+            e->flush();
+          }
+        }
+        e->flush();
+        if (out->pendingBytes() == 0) {
+          closeWriter();
+        } else {
+          out->onDrained([this]() {
+            closeWriter();
+          });
+        }
+      }
+
+      void closeWriter() {
+        ::close(fds[0]);
+        fds[0] = -1;
+      }
+    };
+
+    TEST_CASE("Async streams: testManyStreams", "[testManyStreams]") {
+      ValidSchema schema = compileJsonSchemaFromString(schemaJson);
+      EpollReactor reactor;
+      const int streams = 64;
+      const int count = 200;
+      std::vector<std::unique_ptr<Connection> > connections;
+      for (int i = 0; i < streams; ++i) {
+        // small chunks cut most datums in pieces
+        connections.emplace_back(new Connection(reactor, schema, i % 2 ? 7 : 4096));
+        connections.back()->send(count);
+      }
+      reactor.run();
+
+      for (const std::unique_ptr<Connection>& c : connections) {
+        REQUIRE(c->received == count);
+        REQUIRE(c->reader->count() == static_cast<size_t> (count));
+        REQUIRE(c->ended == 1);
+        REQUIRE(c->inOrder);
+      }
+      REQUIRE(reactor.size() == 0);
+    }
+
+    TEST_CASE("Async streams: testBackPressure", "[testBackPressure]") {
+      ValidSchema schema = compileJsonSchemaFromString(schemaJson);
+      EpollReactor reactor;
+      // far more than a socket buffer holds, so the writer has to wait for the reader
+      const int count = 5000;
+      Connection c(reactor, schema, 64 * 1024);
+      c.send(count);
+      REQUIRE(c.out->pendingBytes() > 0);
+      REQUIRE(c.fds[0] >= 0);
+      reactor.run();
+
+      REQUIRE(c.fds[0] == -1);
+      REQUIRE(c.received == count);
+      REQUIRE(c.ended == 1);
+      REQUIRE(c.inOrder);
+    }
+
+    TEST_CASE("Async streams: testInputStream", "[testInputStream]") {
+      EpollReactor reactor;
+      int fds[2];
+      REQUIRE(::pipe2(fds, O_NONBLOCK) == 0);
+      AsyncInputStream in(reactor, fds[0], 4);
+
+      const uint8_t* data;
+      size_t len;
+      REQUIRE_FALSE(in.tryNext(&data, &len));
+
+      std::string received;
+      int chunks = 0;
+      bool eof = false;
+      AsyncInputStream::ChunkHandler handler = [&](const uint8_t* d, size_t n) {
+        if (n == 0) {
+          eof = true;
+        } else {
+          received.append(reinterpret_cast<const char*> (d), n);
+          ++chunks;
+          in.next(handler);
+        }
+      };
+      in.next(handler);
+      REQUIRE(reactor.poll(0) == 0);
+
+      REQUIRE(::write(fds[1], "0123456789", 10) == 10);
+      // the handler is only called from the reactor
+      REQUIRE(chunks == 0);
+      for (int i = 0; i < 3; ++i) {
+        REQUIRE(reactor.poll(0) == 1);
+      }
+      REQUIRE(received == "0123456789");
+      REQUIRE(chunks == 3);
+      REQUIRE(in.byteCount() == 10);
+
+      ::close(fds[1]);
+      REQUIRE(reactor.poll(0) == 1);
+      REQUIRE(eof);
+      REQUIRE(in.eof());
+      REQUIRE(in.tryNext(&data, &len));
+      REQUIRE(len == 0);
+
+      // nobody waits anymore, the descriptor is let go on the next event
+      REQUIRE(reactor.size() == 1);
+      reactor.poll(0);
+      REQUIRE(reactor.size() == 0);
+      ::close(fds[0]);
+    }
+
+    TEST_CASE("Async streams: testTruncated", "[testTruncated]") {
+      ValidSchema schema = compileJsonSchemaFromString(schemaJson);
+      EpollReactor reactor;
+      int fds[2];
+      REQUIRE(::pipe2(fds, O_NONBLOCK) == 0);
+      bool ended = false;
+      AsyncDatumReader<pt::TestPrimitiveTypes> reader(reactor, fds[0], schema,
+        [](pt::TestPrimitiveTypes&) {
+        }, [&ended]() {
+          ended = true;
+        });
+      reader.start();
+
+      std::shared_ptr<OutputStream> os = memoryOutputStream();
+      EncoderPtr e = binaryEncoder();
+      e->init(*os);
+      avro::encode(*e, makeRecord(7));
+      e->flush();
+      std::vector<uint8_t> bytes = *snapshot(*os);
+      REQUIRE(::write(fds[1], &bytes[0], bytes.size() - 1) == static_cast<ssize_t> (bytes.size() - 1));
+      ::close(fds[1]);
+
+      REQUIRE_THROWS_AS(reactor.run(), Exception);
+      REQUIRE_FALSE(ended);
+      ::close(fds[0]);
+    }
+
+  }
+}
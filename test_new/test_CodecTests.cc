@@ -31,6 +31,7 @@
 #include "ValidSchema.hh"
 #include "Generic.hh"
 #include "Specific.hh"
+#include "BufferStreamAdapter.hh"
 
 #include <boost/bind.hpp>
 #include <boost/random/mersenne_twister.hpp>
@@ -1013,6 +1014,245 @@ namespace avro {
 
   }
 
+  TEST_CASE("Avro C++ unit tests for codecs: testBufferEncoderForeign", "[testBufferEncoderForeign]") {
+    std::string small = "small";
+    std::string large(1000, 'x');
+    std::vector<uint8_t> blob(2000, 7);
+
+    OutputBuffer ob;
+    {
+      std::shared_ptr<OutputStream> os = bufferOutputStream(ob);
+      EncoderPtr e = bufferEncoder(100);
+      e->init(*os);
+      e->encodeString(small);
+      e->encodeString(large);
+      e->encodeInt(42);
+      e->encodeBytes(&blob[0], blob.size());
+      e->encodeLong(-1);
+      e->flush();
+      REQUIRE(os->byteCount() == ob.size());
+    }
+
+    // the large values are referenced in place, between chunks holding the inline bytes
+    InputBuffer ib = ob;
+    REQUIRE(ib.numChunks() == 5);
+    InputBuffer::const_iterator it = ib.begin();
+    ++it;
+    REQUIRE(it->data() == large.data());
+    ++it;
+    ++it;
+    REQUIRE(it->data() == reinterpret_cast<const char*> (&blob[0]));
+
+    std::shared_ptr<InputStream> is = bufferInputStream(ib);
+    DecoderPtr d = binaryDecoder();
+    d->init(*is);
+    REQUIRE(d->decodeString() == small);
+    REQUIRE(d->decodeString() == large);
+    REQUIRE(d->decodeInt() == 42);
+    std::vector<uint8_t> b;
+    d->decodeBytes(b);
+    REQUIRE(b == blob);
+    REQUIRE(d->decodeLong() == -1);
+  }
+
+  TEST_CASE("Avro C++ unit tests for codecs: testGenericEncodedSize", "[testGenericEncodedSize]") {
+    ValidSchema schema = compileJsonSchemaFromString(
+      "{\"type\":\"record\",\"name\":\"r\",\"fields\":["
+      "{\"name\":\"n\", \"type\":\"null\"},"
+      "{\"name\":\"l\", \"type\":\"long\"},"
+      "{\"name\":\"s\", \"type\":\"string\"},"
+      "{\"name\":\"inner\", \"type\":{\"type\":\"record\",\"name\":\"i\",\"fields\":["
+      "{\"name\":\"b\", \"type\":\"bytes\"},"
+      "{\"name\":\"d\", \"type\":\"double\"}]}}]}");
+
+    GenericDatum datum(schema);
+    GenericRecord& r = datum.value<GenericRecord>();
+    r.field("l").value<int64_t>() = -1234567890123LL;
+    r.field("s").value<std::string>() = std::string(150, 's');
+    r.field("inner").value<GenericRecord>().field("b").value<std::vector<uint8_t> >().assign(20, 1);
+
+    std::shared_ptr<OutputStream> os = memoryOutputStream();
+    EncoderPtr e = binaryEncoder();
+    e->init(*os);
+    avro::encode(*e, datum);
+    e->flush();
+    REQUIRE(avro::encodedSize(datum) == os->byteCount());
+  }
+
+  static const char arraySchema[] =
+    "{\"type\":\"record\",\"name\":\"r\",\"fields\":["
+    "{\"name\":\"a\", \"type\":{\"type\":\"array\",\"items\":\"long\"}},"
+    "{\"name\":\"m\", \"type\":{\"type\":\"map\",\"values\":\"string\"}},"
+    "{\"name\":\"n\", \"type\":{\"type\":\"array\",\"items\":{\"type\":\"array\",\"items\":\"int\"}}},"
+    "{\"name\":\"e\", \"type\":{\"type\":\"array\",\"items\":\"double\"}},"
+    "{\"name\":\"l\", \"type\":\"long\"}]}";
+
+  static GenericDatum makeArrayDatum(const ValidSchema& schema) {
+    GenericDatum datum(schema);
+    GenericRecord& r = datum.value<GenericRecord>();
+    GenericArray& a = r.field("a").value<GenericArray>();
+    for (int64_t i = 0; i < 100; ++i) {
+      a.value().push_back(GenericDatum(i * i));
+    }
+    GenericMap& m = r.field("m").value<GenericMap>();
+    m.value().push_back(std::make_pair(std::string("k1"), GenericDatum(std::string("v1"))));
+    m.value().push_back(std::make_pair(std::string("k2"), GenericDatum(std::string(300, 'v'))));
+    GenericArray& n = r.field("n").value<GenericArray>();
+    for (int32_t i = 0; i < 3; ++i) {
+      GenericDatum inner(n.schema()->leafAt(0));
+      for (int32_t j = 0; j < i; ++j) {
+        inner.value<GenericArray>().value().push_back(GenericDatum(j));
+      }
+      n.value().push_back(inner);
+    }
+    r.field("l").value<int64_t>() = -5;
+    return datum;
+  }
+
+  static void checkArrayDatum(const GenericDatum& datum) {
+    const GenericRecord& r = datum.value<GenericRecord>();
+    const GenericArray::Value& a = r.field("a").value<GenericArray>().value();
+    REQUIRE(a.size() == 100U);
+    for (size_t i = 0; i < a.size(); ++i) {
+      REQUIRE(a[i].value<int64_t>() == static_cast<int64_t> (i * i));
+    }
+    const GenericMap::Value& m = r.field("m").value<GenericMap>().value();
+    REQUIRE(m.size() == 2U);
+    REQUIRE(m[0].first == "k1");
+    REQUIRE(m[0].second.value<std::string>() == "v1");
+    REQUIRE(m[1].first == "k2");
+    REQUIRE(m[1].second.value<std::string>() == std::string(300, 'v'));
+    const GenericArray::Value& n = r.field("n").value<GenericArray>().value();
+    REQUIRE(n.size() == 3U);
+    for (size_t i = 0; i < n.size(); ++i) {
+      const GenericArray::Value& inner = n[i].value<GenericArray>().value();
+      REQUIRE(inner.size() == i);
+      for (size_t j = 0; j < i; ++j) {
+        REQUIRE(inner[j].value<int32_t>() == static_cast<int32_t> (j));
+      }
+    }
+    REQUIRE(r.field("e").value<GenericArray>().value().empty());
+    REQUIRE(r.field("l").value<int64_t>() == -5);
+  }
+
+  static void testArrayRoundTrip(const ValidSchema& schema, const EncoderPtr& e, const DecoderPtr& d) {
+    std::shared_ptr<OutputStream> os = memoryOutputStream();
+    e->init(*os);
+    avro::encode(*e, makeArrayDatum(schema));
+    e->flush();
+
+    std::shared_ptr<InputStream> is = memoryInputStream(*os);
+    d->init(*is);
+    GenericDatum datum(schema);
+    avro::decode(*d, datum);
+    checkArrayDatum(datum);
+  }
+
+  TEST_CASE("Avro C++ unit tests for codecs: testArraysAndMaps", "[testArraysAndMaps]") {
+    ValidSchema schema = compileJsonSchemaFromString(arraySchema);
+    testArrayRoundTrip(schema, binaryEncoder(), binaryDecoder());
+    testArrayRoundTrip(schema, blockingBinaryEncoder(), binaryDecoder());
+    testArrayRoundTrip(schema, validatingEncoder(schema, blockingBinaryEncoder()), validatingDecoder(schema, binaryDecoder()));
+    testArrayRoundTrip(schema, jsonEncoder(schema), jsonDecoder(schema));
+    testArrayRoundTrip(schema, blockingBinaryEncoder(), resolvingDecoder(schema, schema, binaryDecoder()));
+
+    // a validating encoder rejects items beyond the count it was given
+    std::shared_ptr<OutputStream> os = memoryOutputStream();
+    EncoderPtr e = validatingEncoder(compileJsonSchemaFromString("{\"type\":\"array\",\"items\":\"int\"}"), binaryEncoder());
+    e->init(*os);
+    e->arrayStart();
+    e->setItemCount(1);
+    e->startItem();
+    e->encodeInt(1);
+    REQUIRE_THROWS_AS(e->encodeInt(2), Exception);
+  }
+
+  TEST_CASE("Avro C++ unit tests for codecs: testBlockingEncoder", "[testBlockingEncoder]") {
+    ValidSchema schema = compileJsonSchemaFromString(arraySchema);
+    GenericDatum datum = makeArrayDatum(schema);
+
+    std::shared_ptr<OutputStream> plain = memoryOutputStream();
+    EncoderPtr e = binaryEncoder();
+    e->init(*plain);
+    avro::encode(*e, datum);
+    e->flush();
+
+    std::shared_ptr<OutputStream> blocked = memoryOutputStream();
+    e = blockingBinaryEncoder();
+    e->init(*blocked);
+    avro::encode(*e, datum);
+    e->flush();
+
+    // every non-empty array or map costs a block size
+    REQUIRE(blocked->byteCount() > plain->byteCount());
+    REQUIRE(blocked->byteCount() <= plain->byteCount() + 5 * 2);
+
+    // the binary decoder skips sized blocks without looking at the items and hands unsized ones back
+    DecoderPtr d = binaryDecoder();
+    std::shared_ptr<InputStream> is = memoryInputStream(*blocked);
+    d->init(*is);
+    REQUIRE(d->skipArray() == 0U);
+    REQUIRE(d->skipMap() == 0U);
+    REQUIRE(d->skipArray() == 0U);
+    REQUIRE(d->skipArray() == 0U);
+    REQUIRE(d->decodeLong() == -5);
+
+    is = memoryInputStream(*plain);
+    d->init(*is);
+    REQUIRE(d->skipArray() == 100U);
+
+    // a reader without the arrays skips them
+    ValidSchema reader = compileJsonSchemaFromString(
+      "{\"type\":\"record\",\"name\":\"r\",\"fields\":[{\"name\":\"l\", \"type\":\"long\"}]}");
+    for (int i = 0; i < 2; ++i) {
+      is = memoryInputStream(i == 0 ? *blocked : *plain);
+      ResolvingDecoderPtr rd = resolvingDecoder(schema, reader, binaryDecoder());
+      rd->init(*is);
+      GenericDatum result(reader);
+      avro::decode(*rd, result);
+      REQUIRE(result.value<GenericRecord>().field("l").value<int64_t>() == -5);
+    }
+  }
+
+  TEST_CASE("Avro C++ unit tests for codecs: testGenericArrayReuse", "[testGenericArrayReuse]") {
+    ValidSchema schema = compileJsonSchemaFromString(arraySchema);
+    std::shared_ptr<OutputStream> os = memoryOutputStream();
+    EncoderPtr e = binaryEncoder();
+    e->init(*os);
+    avro::encode(*e, makeArrayDatum(schema));
+    e->flush();
+
+    GenericDatum datum(schema);
+    const void* item = 0;
+    const char* value = 0;
+    for (int i = 0; i < 2; ++i) {
+      std::shared_ptr<InputStream> is = memoryInputStream(*os);
+      DecoderPtr d = binaryDecoder();
+      d->init(*is);
+      avro::decode(*d, datum);
+      checkArrayDatum(datum);
+      const GenericRecord& r = datum.value<GenericRecord>();
+      if (i > 0) {
+        REQUIRE(&r.field("a").value<GenericArray>().value()[0] == item);
+        REQUIRE(r.field("m").value<GenericMap>().value()[1].second.value<std::string>().data() == value);
+      }
+      item = &r.field("a").value<GenericArray>().value()[0];
+      value = r.field("m").value<GenericMap>().value()[1].second.value<std::string>().data();
+    }
+  }
+
+  TEST_CASE("Avro C++ unit tests for codecs: testGenericArrayEncodedSize", "[testGenericArrayEncodedSize]") {
+    ValidSchema schema = compileJsonSchemaFromString(arraySchema);
+    GenericDatum datum = makeArrayDatum(schema);
+
+    std::shared_ptr<OutputStream> os = memoryOutputStream();
+    EncoderPtr e = binaryEncoder();
+    e->init(*os);
+    avro::encode(*e, datum);
+    e->flush();
+    REQUIRE(avro::encodedSize(datum) == os->byteCount());
+  }
+
   static void testLimits(const EncoderPtr& e, const DecoderPtr& d) {
     std::shared_ptr<OutputStream> s1 = memoryOutputStream();
     {
@@ -0,0 +1,285 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <catch.hpp>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <sstream>
+#include "BinaryCompare.hh"
+#include "Compiler.hh"
+#include "Encoder.hh"
+#include "Schema.hh"
+#include "Specific.hh"
+#include "Zigzag.hh"
+#include "gen/ordered.hh"
+#include <boost/random/mersenne_twister.hpp>
+
+namespace avro {
+  namespace compare {
+
+    static const char schemaJson[] = "{\"type\":\"record\",\"name\":\"Row\",\"fields\":["
+      "{\"name\":\"key\",\"type\":\"string\"},"
+      "{\"name\":\"ts\",\"type\":\"long\",\"order\":\"descending\"},"
+      "{\"name\":\"note\",\"type\":\"string\",\"order\":\"ignore\"},"
+      "{\"name\":\"score\",\"type\":\"double\"},"
+      "{\"name\":\"tags\",\"type\":{\"type\":\"array\",\"items\":\"int\"}},"
+      "{\"name\":\"extra\",\"type\":{\"type\":\"map\",\"values\":\"int\"},\"order\":\"ignore\"}"
+      "]}";
+
+    struct Row {
+      std::string key;
+      int64_t ts;
+      std::string note;
+      double score;
+      std::vector<int32_t> tags;
+      std::map<std::string, int32_t> extra;
+    };
+
+    /* The order the schema defines, worked out on the values.*/
+    int expected(const Row& a, const Row& b) {
+      if (a.key != b.key) {
+        return a.key < b.key ? -1 : 1;
+      }
+      if (a.ts != b.ts) {
+        return a.ts > b.ts ? -1 : 1;
+      }
+      if (a.score != b.score) {
+        return a.score < b.score ? -1 : 1;
+      }
+      if (a.tags != b.tags) {
+        return a.tags < b.tags ? -1 : 1;
+      }
+      return 0;
+    }
+
+    std::vector<uint8_t> encodeRow(const Row& r, bool blocking) {
+      std::shared_ptr<OutputStream> os = memoryOutputStream();
+      EncoderPtr e = blocking ? blockingBinaryEncoder() : binaryEncoder();
+      e->init(*os);
+      avro::encode(*e, r.key);
+      avro::encode(*e, r.ts);
+      avro::encode(*e, r.note);
+      avro::encode(*e, r.score);
+      avro::encode(*e, r.tags);
+      avro::encode(*e, r.extra);
+      e->flush();
+      return *snapshot(*os);
+    }
+
+    int sign(int c) {
+      return c < 0 ? -1 : (c > 0 ? 1 : 0);
+    }
+
+    TEST_CASE("Binary compare: testRecords", "[testRecords]") {
+      CompiledSchema schema(compileJsonSchemaFromString(schemaJson));
+      boost::mt19937 rnd(7);
+      // small domains, so that many rows tie on their leading fields
+      const char* keys[] = {"", "a", "ab", "b", "\xc3\xa9"};
+      std::vector<Row> rows;
+      std::vector<std::vector<uint8_t> > encoded;
+      for (int i = 0; i < 150; ++i) {
+        Row r;
+        r.key = keys[rnd() % 5];
+        r.ts = static_cast<int64_t> (rnd() % 5) - 2;
+        r.note = std::string(rnd() % 3, 'n');
+        r.score = (rnd() % 3) * 0.5 - 0.5;
+        for (size_t k = rnd() % 4; k > 0; --k) {
+          r.tags.push_back(static_cast<int32_t> (rnd() % 3) - 1);
+        }
+        r.extra["x"] = rnd() % 2;
+        rows.push_back(r);
+        encoded.push_back(encodeRow(r, i % 2 == 0));
+      }
+      for (size_t i = 0; i < rows.size(); ++i) {
+        for (size_t j = 0; j < rows.size(); ++j) {
+          int c = compareBinary(schema, &encoded[i][0], encoded[i].size(), &encoded[j][0], encoded[j].size());
+          REQUIRE(sign(c) == expected(rows[i], rows[j]));
+        }
+      }
+    }
+
+    template <typename T>
+    std::vector<uint8_t> encodeValue(const T& t) {
+      std::shared_ptr<OutputStream> os = memoryOutputStream();
+      EncoderPtr e = binaryEncoder();
+      e->init(*os);
+      avro::encode(*e, t);
+      e->flush();
+      return *snapshot(*os);
+    }
+
+    template <typename T>
+    int compareValues(const ValidSchema& schema, const T& a, const T& b) {
+      std::vector<uint8_t> ea = encodeValue(a);
+      std::vector<uint8_t> eb = encodeValue(b);
+      return sign(compareBinary(schema, &ea[0], ea.size(), &eb[0], eb.size()));
+    }
+
+    template <typename T>
+    int compareValues(const char* type, const T& a, const T& b) {
+      return compareValues(compileJsonSchemaFromString(std::string("\"") + type + "\""), a, b);
+    }
+
+    TEST_CASE("Binary compare: testPrimitives", "[testPrimitives]") {
+      REQUIRE(compareValues<int32_t>("int", -1, 1) == -1);
+      REQUIRE(compareValues<int32_t>("int", -64, 63) == -1);
+      REQUIRE(compareValues<int64_t>("long", 1LL << 40, -(1LL << 40)) == 1);
+      REQUIRE(compareValues<bool>("boolean", false, true) == -1);
+      REQUIRE(compareValues<float>("float", -0.0f, 0.0f) == -1);
+      REQUIRE(compareValues<double>("double", std::nan(""), std::numeric_limits<double>::infinity()) == 1);
+      REQUIRE(compareValues<double>("double", std::nan(""), std::nan("")) == 0);
+      REQUIRE(compareValues<std::string>("string", "ab", "abc") == -1);
+      REQUIRE(compareValues<std::string>("string", "\xff", "a") == 1);
+      REQUIRE(compareValues<std::vector<uint8_t> >("bytes", std::vector<uint8_t>(2, 1), std::vector<uint8_t>(1, 2)) == -1);
+    }
+
+    TEST_CASE("Binary compare: testErrors", "[testErrors]") {
+      ValidSchema schema = compileJsonSchemaFromString("{\"type\":\"map\",\"values\":\"int\"}");
+      const uint8_t empty[] = {0};
+      REQUIRE_THROWS_AS(compareBinary(schema, empty, 1, empty, 1), Exception);
+
+      // a difference before the truncation is enough, otherwise the truncation is found
+      ValidSchema pair = compileJsonSchemaFromString("{\"type\":\"record\",\"name\":\"P\",\"fields\":["
+        "{\"name\":\"a\",\"type\":\"int\"},{\"name\":\"b\",\"type\":\"string\"}]}");
+      const uint8_t a[] = {2, 8, 'x'};
+      const uint8_t b[] = {4};
+      REQUIRE(compareBinary(pair, a, sizeof (a), b, sizeof (b)) < 0);
+      REQUIRE_THROWS_AS(compareBinary(pair, a, sizeof (a), a, sizeof (a)), Exception);
+    }
+
+    TEST_CASE("Binary compare: testHash", "[testHash]") {
+      ValidSchema valid = compileJsonSchemaFromString(schemaJson);
+      CompiledSchema schema(valid);
+      CompiledSchema key(valid, std::vector<std::string>(1, "key"));
+      boost::mt19937 rnd(13);
+      std::vector<Row> rows;
+      for (int i = 0; i < 150; ++i) {
+        Row r;
+        r.key = std::string(rnd() % 3, 'k');
+        r.ts = rnd() % 3;
+        r.note = std::string(rnd() % 3, 'n');
+        r.score = rnd() % 2;
+        r.tags.resize(rnd() % 3, 1);
+        r.extra["x"] = rnd() % 2;
+        rows.push_back(r);
+      }
+      for (size_t i = 0; i < rows.size(); ++i) {
+        std::vector<uint8_t> a = encodeRow(rows[i], false);
+        // the blocks of the arrays do not matter
+        std::vector<uint8_t> blocked = encodeRow(rows[i], true);
+        REQUIRE(hashBinary(schema, &a[0], a.size()) == hashBinary(schema, &blocked[0], blocked.size()));
+        for (size_t j = 0; j < rows.size(); ++j) {
+          std::vector<uint8_t> b = encodeRow(rows[j], j % 2 == 0);
+          bool same = expected(rows[i], rows[j]) == 0;
+          REQUIRE((hashBinary(schema, &a[0], a.size()) == hashBinary(schema, &b[0], b.size())) == same);
+          bool sameKey = rows[i].key == rows[j].key;
+          REQUIRE((hashBinary(key, &a[0], a.size()) == hashBinary(key, &b[0], b.size())) == sameKey);
+        }
+      }
+      std::vector<uint8_t> a = encodeRow(rows[0], false);
+      REQUIRE(hashBinary(schema, &a[0], a.size(), 1) != hashBinary(schema, &a[0], a.size(), 2));
+      REQUIRE_THROWS_AS(hashBinary(schema, &a[0], a.size() - 1), Exception);
+    }
+
+    TEST_CASE("Binary compare: testHashMap", "[testHashMap]") {
+      ValidSchema schema = compileJsonSchemaFromString("{\"type\":\"map\",\"values\":\"double\"}");
+      // the same map with its entries in either order, and with another NaN
+      const uint8_t ab[] = {4, 2, 'a', 0, 0, 0, 0, 0, 0, 0xf0, 0x3f, 2, 'b', 0, 0, 0, 0, 0, 0, 0xf8, 0x7f, 0};
+      const uint8_t ba[] = {4, 2, 'b', 1, 0, 0, 0, 0, 0, 0xf8, 0x7f, 2, 'a', 0, 0, 0, 0, 0, 0, 0xf0, 0x3f, 0};
+      const uint8_t aa[] = {4, 2, 'a', 0, 0, 0, 0, 0, 0, 0xf0, 0x3f, 2, 'a', 0, 0, 0, 0, 0, 0, 0xf8, 0x7f, 0};
+      REQUIRE(hashBinary(schema, ab, sizeof (ab)) == hashBinary(schema, ba, sizeof (ba)));
+      REQUIRE(hashBinary(schema, ab, sizeof (ab)) != hashBinary(schema, aa, sizeof (aa)));
+    }
+
+    TEST_CASE("Binary compare: testHashSpread", "[testHashSpread]") {
+      CompiledSchema schema(compileJsonSchemaFromString("\"long\""));
+      const size_t count = 100000;
+      const size_t buckets = 16;
+      std::vector<uint64_t> hashes;
+      std::vector<size_t> sizes(buckets);
+      for (size_t i = 0; i < count; ++i) {
+        boost::array<uint8_t, 10> buf;
+        size_t len = encodeInt64(static_cast<int64_t> (i), buf);
+        uint64_t h = hashBinary(schema, buf.data(), len);
+        hashes.push_back(h);
+        ++sizes[h % buckets];
+      }
+      std::sort(hashes.begin(), hashes.end());
+      REQUIRE(std::adjacent_find(hashes.begin(), hashes.end()) == hashes.end());
+      for (size_t i = 0; i < buckets; ++i) {
+        REQUIRE(sizes[i] > count / buckets * 9 / 10);
+        REQUIRE(sizes[i] < count / buckets * 11 / 10);
+      }
+    }
+
+    TEST_CASE("Binary compare: testFieldOrder", "[testFieldOrder]") {
+      ValidSchema schema = compileJsonSchemaFromString(schemaJson);
+      const NodePtr& root = schema.root();
+      REQUIRE(root->fieldOrderAt(0) == FieldOrder::ASCENDING);
+      REQUIRE(root->fieldOrderAt(1) == FieldOrder::DESCENDING);
+      REQUIRE(root->fieldOrderAt(2) == FieldOrder::IGNORE);
+
+      // the order survives printing the schema
+      std::ostringstream oss;
+      schema.toJson(oss);
+      ValidSchema reparsed = compileJsonSchemaFromString(oss.str());
+      for (size_t i = 0; i < root->leaves(); ++i) {
+        REQUIRE(reparsed.root()->fieldOrderAt(i) == root->fieldOrderAt(i));
+      }
+
+      // nested orders combine
+      RecordSchema inner("Inner");
+      inner.addField("x", IntSchema(), FieldOrder::DESCENDING);
+      inner.addField("y", IntSchema(), FieldOrder::IGNORE);
+      RecordSchema outer("Outer");
+      outer.addField("i", inner, FieldOrder::DESCENDING);
+      CompiledSchema compiled((ValidSchema(outer)));
+      REQUIRE(compiled.ops()[0].order == FieldOrder::ASCENDING);
+      REQUIRE(compiled.ops()[1].order == FieldOrder::IGNORE);
+
+      REQUIRE_THROWS_AS(compileJsonSchemaFromString("{\"type\":\"record\",\"name\":\"R\",\"fields\":["
+        "{\"name\":\"a\",\"type\":\"int\",\"order\":\"sideways\"}]}"), Exception);
+    }
+
+    TEST_CASE("Binary compare: testGeneratedFieldOrder", "[testGeneratedFieldOrder]") {
+      ValidSchema parsed = compileJsonSchemaFromString("{\"type\":\"record\",\"name\":\"Ordered\",\"fields\":["
+        "{\"name\":\"k\",\"type\":\"int\",\"order\":\"descending\"},"
+        "{\"name\":\"v\",\"type\":\"string\",\"order\":\"ignore\"},"
+        "{\"name\":\"w\",\"type\":\"long\"}]}");
+      const ValidSchema& embedded = ord::Ordered::schema();
+      REQUIRE(embedded.root()->fieldOrderAt(0) == FieldOrder::DESCENDING);
+      REQUIRE(embedded.root()->fieldOrderAt(1) == FieldOrder::IGNORE);
+      REQUIRE(embedded.root()->fieldOrderAt(2) == FieldOrder::ASCENDING);
+
+      ord::Ordered a;
+      a.k = 1;
+      a.v = "b";
+      ord::Ordered b;
+      b.k = 2;
+      b.v = "a";
+      REQUIRE(compareValues(parsed, a, b) == 1);
+      REQUIRE(compareValues(embedded, a, b) == 1);
+      b.k = 1;
+      REQUIRE(compareValues(parsed, a, b) == 0);
+      REQUIRE(compareValues(embedded, a, b) == 0);
+      b.w = 1;
+      REQUIRE(compareValues(embedded, a, b) == -1);
+    }
+
+  }
+}
@@ -0,0 +1,150 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <catch.hpp>
+#include <algorithm>
+#include <cstdlib>
+#include <boost/filesystem.hpp>
+#include <boost/random/mersenne_twister.hpp>
+#include "Compiler.hh"
+#include "Decoder.hh"
+#include "Encoder.hh"
+#include "ExternalSort.hh"
+
+namespace avro {
+  namespace externalsort {
+
+    static const char schemaJson[] = "{\"type\":\"record\",\"name\":\"Log\",\"fields\":["
+      "{\"name\":\"user\",\"type\":\"string\"},"
+      "{\"name\":\"ts\",\"type\":\"long\"},"
+      "{\"name\":\"events\",\"type\":{\"type\":\"array\",\"items\":\"int\"}}"
+      "]}";
+
+    struct Log {
+      std::string user;
+      int64_t ts;
+      std::vector<int32_t> events;
+    };
+
+    bool userLess(const Log& a, const Log& b) {
+      return a.user < b.user;
+    }
+
+    std::vector<Log> makeLogs(size_t count) {
+      boost::mt19937 rnd(11);
+      std::vector<Log> logs(count);
+      for (size_t i = 0; i < count; ++i) {
+        logs[i].user = "user" + std::to_string(rnd() % 500);
+        logs[i].ts = i;
+        logs[i].events.resize(rnd() % 4, static_cast<int32_t> (i));
+      }
+      return logs;
+    }
+
+    std::shared_ptr<OutputStream> encodeLogs(const std::vector<Log>& logs) {
+      std::shared_ptr<OutputStream> os = memoryOutputStream();
+      EncoderPtr e = binaryEncoder();
+      e->init(*os);
+      for (size_t i = 0; i < logs.size(); ++i) {
+        e->encodeString(logs[i].user);
+        e->encodeLong(logs[i].ts);
+        e->arrayStart();
+        if (!logs[i].events.empty()) {
+          e->setItemCount(logs[i].events.size());
+        }
+        for (size_t k = 0; k < logs[i].events.size(); ++k) {
+          e->startItem();
+          e->encodeInt(logs[i].events[k]);
+        }
+        e->arrayEnd();
+      }
+      e->flush();
+      return os;
+    }
+
+    /* Checks that out holds the logs in the order of expected, ties in input order.*/
+    void checkSorted(const OutputStream& out, std::vector<Log> expected) {
+      std::stable_sort(expected.begin(), expected.end(), userLess);
+      std::shared_ptr<InputStream> in = memoryInputStream(out);
+      DecoderPtr d = binaryDecoder();
+      d->init(*in);
+      for (size_t i = 0; i < expected.size(); ++i) {
+        REQUIRE(d->decodeString() == expected[i].user);
+        REQUIRE(d->decodeLong() == expected[i].ts);
+        std::vector<int32_t> events;
+        for (size_t n = d->arrayStart(); n != 0; n = d->arrayNext()) {
+          for (size_t k = 0; k < n; ++k) {
+            events.push_back(d->decodeInt());
+          }
+        }
+        REQUIRE(events == expected[i].events);
+      }
+      const uint8_t* data = 0;
+      size_t len = 0;
+      REQUIRE_FALSE(in->next(&data, &len));
+    }
+
+    TEST_CASE("External sort: testInMemory", "[testInMemory]") {
+      ValidSchema schema = compileJsonSchemaFromString(schemaJson);
+      std::vector<Log> logs = makeLogs(20000);
+      std::shared_ptr<OutputStream> input = encodeLogs(logs);
+
+      ExternalSorter sorter(CompiledSchema(schema, std::vector<std::string>(1, "user")), 64 * 1024 * 1024, 4);
+      std::shared_ptr<InputStream> in = memoryInputStream(*input);
+      std::shared_ptr<OutputStream> out = memoryOutputStream();
+      REQUIRE(sorter.sort(*in, *out) == logs.size());
+      REQUIRE(sorter.spilledRuns() == 0);
+      checkSorted(*out, logs);
+    }
+
+    TEST_CASE("External sort: testSpilled", "[testSpilled]") {
+      ValidSchema schema = compileJsonSchemaFromString(schemaJson);
+      std::vector<Log> logs = makeLogs(20000);
+      std::shared_ptr<OutputStream> input = encodeLogs(logs);
+
+      boost::filesystem::path dir = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+      boost::filesystem::create_directory(dir);
+      {
+        // a few kilobytes a run and four runs a merge, so the runs are merged twice over
+        ExternalSorter sorter(CompiledSchema(schema, std::vector<std::string>(1, "user")), 8 * 1024, 3, dir.string());
+        sorter.setMaxFanIn(4);
+        std::shared_ptr<InputStream> in = memoryInputStream(*input);
+        std::shared_ptr<OutputStream> out = memoryOutputStream();
+        REQUIRE(sorter.sort(*in, *out) == logs.size());
+        REQUIRE(sorter.spilledRuns() > 16);
+        checkSorted(*out, logs);
+      }
+      // no temporary file is left behind
+      REQUIRE(boost::filesystem::is_empty(dir));
+      boost::filesystem::remove(dir);
+    }
+
+    TEST_CASE("External sort: testErrors", "[testErrors]") {
+      ValidSchema schema = compileJsonSchemaFromString(schemaJson);
+      REQUIRE_THROWS_AS(CompiledSchema(schema, std::vector<std::string>(1, "nobody")), Exception);
+      REQUIRE_THROWS_AS(CompiledSchema(compileJsonSchemaFromString("\"long\""), std::vector<std::string>(1, "user")), Exception);
+
+      ExternalSorter sorter((CompiledSchema(schema)));
+      REQUIRE_THROWS_AS(sorter.setMaxFanIn(1), Exception);
+      const uint8_t truncated[] = {4, 'a', 'b', 2};
+      std::shared_ptr<InputStream> in = memoryInputStream(truncated, sizeof (truncated));
+      std::shared_ptr<OutputStream> out = memoryOutputStream();
+      REQUIRE_THROWS_AS(sorter.sort(*in, *out), Exception);
+    }
+
+  }
+}
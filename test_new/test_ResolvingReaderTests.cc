@@ -0,0 +1,195 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <catch.hpp>
+#include <cstddef>
+#include <memory>
+#include "Compiler.hh"
+#include "Encoder.hh"
+#include "Layout.hh"
+#include "Resolver.hh"
+#include "ResolverSchema.hh"
+#include "ResolvingReader.hh"
+#include "BufferStreamAdapter.hh"
+
+namespace avro {
+  namespace resolving {
+
+    static const char writerJson[] = "{\"type\":\"record\",\"name\":\"W\",\"fields\":["
+      "{\"name\":\"a\",\"type\":\"int\"},"
+      "{\"name\":\"b\",\"type\":\"long\"},"
+      "{\"name\":\"c\",\"type\":\"string\"},"
+      "{\"name\":\"d\",\"type\":\"double\"},"
+      "{\"name\":\"e\",\"type\":\"float\"},"
+      "{\"name\":\"f\",\"type\":\"boolean\"},"
+      "{\"name\":\"g\",\"type\":\"int\"},"
+      "{\"name\":\"h\",\"type\":\"long\"},"
+      "{\"name\":\"i\",\"type\":\"int\"},"
+      "{\"name\":\"s\",\"type\":\"string\"},"
+      "{\"name\":\"t\",\"type\":\"bytes\"},"
+      "{\"name\":\"n\",\"type\":{\"type\":\"record\",\"name\":\"In\",\"fields\":["
+      "{\"name\":\"x\",\"type\":\"int\"},{\"name\":\"y\",\"type\":\"string\"}]}},"
+      "{\"name\":\"z\",\"type\":\"float\"}"
+      "]}";
+
+    static const char readerJson[] = "{\"type\":\"record\",\"name\":\"W\",\"fields\":["
+      "{\"name\":\"a\",\"type\":\"long\"},"
+      "{\"name\":\"b\",\"type\":\"double\"},"
+      "{\"name\":\"g\",\"type\":\"int\"},"
+      "{\"name\":\"t\",\"type\":\"bytes\"},"
+      "{\"name\":\"n\",\"type\":{\"type\":\"record\",\"name\":\"In\",\"fields\":["
+      "{\"name\":\"x\",\"type\":\"int\"}]}},"
+      "{\"name\":\"z\",\"type\":\"double\"}"
+      "]}";
+
+    struct In {
+      int32_t x;
+    };
+
+    struct R {
+      int64_t a;
+      double b;
+      int32_t g;
+      std::vector<uint8_t> t;
+      In n;
+      double z;
+    };
+
+    /* The offsets of the layout are all relative to R, nested records included.*/
+    void makeLayout(CompoundLayout& layout) {
+      layout.add(new PrimitiveLayout(offsetof(R, a)));
+      layout.add(new PrimitiveLayout(offsetof(R, b)));
+      layout.add(new PrimitiveLayout(offsetof(R, g)));
+      layout.add(new PrimitiveLayout(offsetof(R, t)));
+      CompoundLayout* n = new CompoundLayout(offsetof(R, n));
+      n->add(new PrimitiveLayout(offsetof(R, n) + offsetof(In, x)));
+      layout.add(n);
+      layout.add(new PrimitiveLayout(offsetof(R, z)));
+    }
+
+    void encodeRecord(Encoder& e, int i) {
+      e.encodeInt(i);
+      e.encodeLong(static_cast<int64_t> (i) << 33);
+      e.encodeString(std::string(i, 'c'));
+      e.encodeDouble(i * 0.5);
+      e.encodeFloat(i * 0.25f);
+      e.encodeBool(i % 2 == 0);
+      e.encodeInt(-i);
+      e.encodeLong(i * 1000);
+      e.encodeInt(i * 7);
+      e.encodeString("skipped");
+      std::vector<uint8_t> t(i, static_cast<uint8_t> (i));
+      e.encodeBytes(t);
+      e.encodeInt(i + 100);
+      e.encodeString("nested");
+      e.encodeFloat(i * 1.5f);
+    }
+
+    TEST_CASE("Resolving reader: testProgram", "[testProgram]") {
+      ValidSchema writer = compileJsonSchemaFromString(writerJson);
+      ValidSchema reader = compileJsonSchemaFromString(readerJson);
+      CompoundLayout layout;
+      makeLayout(layout);
+
+      std::unique_ptr<Resolver> resolver(constructResolver(writer, reader, layout));
+      ResolverProgram program(*resolver);
+
+      typedef ResolverProgram::Opcode Op;
+      const std::pair<Op, size_t> expected[] = {
+        {Op::INT_TO_LONG, offsetof(R, a)},
+        {Op::LONG_TO_DOUBLE, offsetof(R, b)},
+        {Op::SKIP_LENGTH_PREFIXED, 1}, // c
+        {Op::SKIP_BYTES, 8 + 4 + 1}, // d, e and f
+        {Op::READ_INT, offsetof(R, g)},
+        {Op::SKIP_VARINTS, 2}, // h and i
+        {Op::SKIP_LENGTH_PREFIXED, 1}, // s
+        {Op::READ_BYTES, offsetof(R, t)},
+        {Op::READ_INT, offsetof(R, n) + offsetof(In, x)},
+        {Op::SKIP_LENGTH_PREFIXED, 1}, // n.y
+        {Op::FLOAT_TO_DOUBLE, offsetof(R, z)}
+      };
+      const std::vector<ResolverProgram::Op>& ops = program.ops();
+      REQUIRE(ops.size() == sizeof (expected) / sizeof (expected[0]));
+      for (size_t i = 0; i < ops.size(); ++i) {
+        REQUIRE(ops[i].opcode == expected[i].first);
+        REQUIRE(ops[i].offset == expected[i].second);
+      }
+    }
+
+    void checkRecord(const R& r, int i) {
+      REQUIRE(r.a == i);
+      REQUIRE(r.b == static_cast<double> (static_cast<int64_t> (i) << 33));
+      REQUIRE(r.g == -i);
+      REQUIRE(r.t == std::vector<uint8_t>(i, static_cast<uint8_t> (i)));
+      REQUIRE(r.n.x == i + 100);
+      REQUIRE(r.z == i * 1.5);
+    }
+
+    void encodeRecords(OutputBuffer& ob, int count) {
+      std::shared_ptr<OutputStream> os = bufferOutputStream(ob);
+      EncoderPtr e = binaryEncoder();
+      e->init(*os);
+      for (int i = 0; i < count; ++i) {
+        encodeRecord(*e, i);
+      }
+      e->flush();
+    }
+
+    TEST_CASE("Resolving reader: testParse", "[testParse]") {
+      ValidSchema writer = compileJsonSchemaFromString(writerJson);
+      ValidSchema reader = compileJsonSchemaFromString(readerJson);
+      CompoundLayout layout;
+      makeLayout(layout);
+      ResolverSchema schema(writer, reader, layout);
+
+      const int count = 20;
+      OutputBuffer ob;
+      encodeRecords(ob, count);
+
+      ResolvingReader rr(schema, ob);
+      for (int i = 0; i < count; ++i) {
+        R r;
+        rr.parse(r);
+        checkRecord(r, i);
+      }
+    }
+
+    TEST_CASE("Resolving reader: testParseBatch", "[testParseBatch]") {
+      ValidSchema writer = compileJsonSchemaFromString(writerJson);
+      ValidSchema reader = compileJsonSchemaFromString(readerJson);
+      CompoundLayout layout;
+      makeLayout(layout);
+      ResolverSchema schema(writer, reader, layout);
+
+      const int count = 50;
+      OutputBuffer ob;
+      encodeRecords(ob, count);
+
+      // batches and single objects mix freely
+      ResolvingReader rr(schema, ob);
+      std::vector<R> records(count);
+      rr.parseBatch(&records[0], 30);
+      rr.parse(records[30]);
+      rr.parseBatch(&records[31], 0);
+      rr.parseBatch(&records[31], count - 31);
+      for (int i = 0; i < count; ++i) {
+        checkRecord(records[i], i);
+      }
+    }
+
+  }
+}
@@ -0,0 +1,316 @@
+/**
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <catch.hpp>
+#include "ResumableDecoder.hh"
+#include "Compiler.hh"
+#include "Generic.hh"
+#include "gen/primitivetypes.hh"
+#include "gen/pmrrecord.hh"
+
+namespace avro {
+  namespace resumable {
+
+    static const char schemaJson[] = "{\"name\": \"TestPrimitiveTypes\", \"type\": \"record\", \"fields\": ["
+      "{ \"name\": \"Null\", \"type\": \"null\" },"
+      "{ \"name\": \"Boolean\", \"type\": \"boolean\" },"
+      "{ \"name\": \"Int\", \"type\": \"int\" },"
+      "{ \"name\": \"Long\", \"type\": \"long\" },"
+      "{ \"name\": \"Float\", \"type\": \"float\" },"
+      "{ \"name\": \"Double\", \"type\": \"double\" },"
+      "{ \"name\": \"Bytes\", \"type\": \"bytes\" },"
+      "{ \"name\": \"String\", \"type\": \"string\" },"
+      "{ \"name\": \"SecondNull\", \"type\": \"null\" }"
+      "]}";
+
+    pt::TestPrimitiveTypes makeRecord(int i) {
+      pt::TestPrimitiveTypes r;
+      r.Boolean = (i % 2 == 0);
+      r.Int = -i;
+      r.Long = static_cast<int64_t> (i) << 40;
+      r.Float = i / 2.0f;
+      r.Double = i * 1.5;
+      r.Bytes.assign(i * 7, static_cast<uint8_t> (i));
+      r.String.assign(i * 13, 'a' + i % 26);
+      return r;
+    }
+
+    bool sameRecord(const pt::TestPrimitiveTypes& a, const pt::TestPrimitiveTypes& b) {
+      return a.Boolean == b.Boolean && a.Int == b.Int && a.Long == b.Long && a.Float == b.Float &&
+        a.Double == b.Double && a.Bytes == b.Bytes && a.String == b.String;
+    }
+
+    std::vector<uint8_t> encodeRecords(int count) {
+      std::shared_ptr<OutputStream> os = memoryOutputStream();
+      EncoderPtr e = binaryEncoder();
+      e->init(*os);
+      for (int i = 0; i < count; ++i) {
+        avro::encode(*e, makeRecord(i));
+      }
+      e->flush();
+      return *snapshot(*os);
+    }
+
+    /* Feeds the encoded records in pieces of the given size and checks every datum that comes out.*/
+    void testPieces(size_t pieceSize) {
+      const int count = 40;
+      std::vector<uint8_t> data = encodeRecords(count);
+      ResumableDecoder decoder(compileJsonSchemaFromString(schemaJson));
+
+      int decoded = 0;
+      pt::TestPrimitiveTypes r;
+      for (size_t pos = 0; pos < data.size(); pos += pieceSize) {
+        const uint8_t* piece = &data[pos];
+        size_t len = std::min(pieceSize, data.size() - pos);
+        while (len > 0) {
+          size_t consumed;
+          if (decoder.decode(piece, len, consumed, r) == DecodeStatus::DATUM_READY) {
+            REQUIRE(sameRecord(r, makeRecord(decoded)));
+            ++decoded;
+          } else {
+            REQUIRE(consumed == len);
+          }
+          piece += consumed;
+          len -= consumed;
+        }
+      }
+      REQUIRE(decoded == count);
+      REQUIRE(decoder.partialBytes() == 0U);
+    }
+
+    TEST_CASE("Resumable decoder: testPieces", "[testPieces]") {
+      size_t sizes[] = {1, 2, 3, 7, 64, 1000, 100000};
+      for (size_t size : sizes) {
+        testPieces(size);
+      }
+    }
+
+    TEST_CASE("Resumable decoder: testGeneric", "[testGeneric]") {
+      ValidSchema schema = compileJsonSchemaFromString(schemaJson);
+      std::vector<uint8_t> data = encodeRecords(3);
+      ResumableDecoder decoder(schema);
+
+      size_t consumed;
+      GenericDatum datum(schema);
+      REQUIRE(decoder.decode(&data[0], 5, consumed, datum) == DecodeStatus::NEED_MORE_DATA);
+      REQUIRE(decoder.partialBytes() == 5U);
+      size_t pos = consumed;
+      for (int i = 0; i < 3; ++i) {
+        REQUIRE(decoder.decode(&data[pos], data.size() - pos, consumed, datum) == DecodeStatus::DATUM_READY);
+        pos += consumed;
+        const GenericRecord& r = datum.value<GenericRecord>();
+        REQUIRE(r.field("Int").value<int32_t>() == -i);
+        REQUIRE(r.field("String").value<std::string>() == makeRecord(i).String);
+      }
+      REQUIRE(pos == data.size());
+    }
+
+    TEST_CASE("Resumable decoder: testArrays", "[testArrays]") {
+      typedef std::map<std::string, std::vector<std::vector<int32_t> > > Value;
+      ValidSchema schema = compileJsonSchemaFromString("{\"type\":\"map\",\"values\":"
+        "{\"type\":\"array\",\"items\":{\"type\":\"array\",\"items\":\"int\"}}}");
+      std::vector<Value> values(6);
+      for (size_t i = 0; i < values.size(); ++i) {
+        for (size_t j = 0; j < i; ++j) {
+          values[i][std::string(j + 1, 'k')].assign(j, std::vector<int32_t>(i, -static_cast<int32_t> (j)));
+        }
+      }
+
+      // with and without the block sizes
+      for (int blocking = 0; blocking < 2; ++blocking) {
+        std::shared_ptr<OutputStream> os = memoryOutputStream();
+        EncoderPtr e = blocking ? blockingBinaryEncoder() : binaryEncoder();
+        e->init(*os);
+        for (size_t i = 0; i < values.size(); ++i) {
+          avro::encode(*e, values[i]);
+        }
+        e->flush();
+        std::vector<uint8_t> data = *snapshot(*os);
+
+        ResumableDecoder decoder(schema);
+        size_t decoded = 0;
+        Value v;
+        for (size_t pos = 0; pos < data.size(); ++pos) {
+          size_t consumed;
+          if (decoder.decode(&data[pos], 1, consumed, v) == DecodeStatus::DATUM_READY) {
+            REQUIRE(v == values[decoded]);
+            ++decoded;
+          }
+          REQUIRE(consumed == 1U);
+        }
+        REQUIRE(decoded == values.size());
+        REQUIRE(decoder.partialBytes() == 0U);
+      }
+    }
+
+    TEST_CASE("Resumable decoder: testIncremental", "[testIncremental]") {
+      pt::TestPrimitiveTypes big = makeRecord(1);
+      big.String.assign(4 << 20, 'x');
+      for (size_t i = 0; i < big.String.size(); i += 4096) {
+        big.String[i] = 'a' + i % 26;
+      }
+      std::shared_ptr<OutputStream> os = memoryOutputStream();
+      EncoderPtr e = binaryEncoder();
+      e->init(*os);
+      avro::encode(*e, big);
+      e->flush();
+      std::vector<uint8_t> data = *snapshot(*os);
+
+      // the string is filled in as its bytes arrive, not once the datum is complete
+      ResumableDecoder decoder(compileJsonSchemaFromString(schemaJson));
+      pt::TestPrimitiveTypes r;
+      size_t half = data.size() / 2;
+      size_t consumed;
+      REQUIRE(decoder.decode(&data[0], half, consumed, r) == DecodeStatus::NEED_MORE_DATA);
+      REQUIRE(consumed == half);
+      REQUIRE(r.Int == big.Int);
+      REQUIRE(r.Bytes == big.Bytes);
+      size_t done = half - (data.size() - big.String.size());
+      REQUIRE(r.String.size() >= done);
+      REQUIRE(r.String.size() < big.String.size());
+      REQUIRE(r.String.compare(0, done, big.String, 0, done) == 0);
+
+      // another value cannot take over half way
+      pt::TestPrimitiveTypes other;
+      REQUIRE_THROWS_AS(decoder.decode(&data[half], 1, consumed, other), Exception);
+      REQUIRE(decoder.partialBytes() == half);
+
+      REQUIRE(decoder.decode(&data[half], data.size() - half, consumed, r) == DecodeStatus::DATUM_READY);
+      REQUIRE(consumed == data.size() - half);
+      REQUIRE(sameRecord(r, big));
+    }
+
+    TEST_CASE("Resumable decoder: testHugeLength", "[testHugeLength]") {
+      // a string that claims a terabyte is not made room for before its bytes arrive
+      ResumableDecoder decoder(compileJsonSchemaFromString("\"string\""));
+      std::shared_ptr<OutputStream> os = memoryOutputStream();
+      EncoderPtr e = binaryEncoder();
+      e->init(*os);
+      e->encodeLong(static_cast<int64_t> (1) << 40);
+      e->flush();
+      std::vector<uint8_t> data = *snapshot(*os);
+      data.resize(data.size() + 100, 'z');
+
+      std::string s;
+      size_t consumed;
+      REQUIRE(decoder.decode(&data[0], data.size(), consumed, s) == DecodeStatus::NEED_MORE_DATA);
+      REQUIRE(consumed == data.size());
+      REQUIRE(s.capacity() <= 2 * detail::kMaxPresizeBytes);
+      REQUIRE(s.compare(0, 100, std::string(100, 'z')) == 0);
+    }
+
+    /* Makes the given resource the default one for as long as it lives.*/
+    class DefaultResource {
+      std::pmr::memory_resource* old_;
+
+    public:
+
+      explicit DefaultResource(std::pmr::memory_resource* r) : old_(std::pmr::set_default_resource(r)) {
+      }
+
+      ~DefaultResource() {
+        std::pmr::set_default_resource(old_);
+      }
+    };
+
+    TEST_CASE("Resumable decoder: testNested", "[testNested]") {
+      std::vector<pm::Message> messages(4);
+      for (size_t i = 0; i < messages.size(); ++i) {
+        messages[i].id = i;
+        messages[i].text.assign(i * 30, 't');
+        messages[i].sender.name = "sender" + std::to_string(i);
+        messages[i].sender.avatar.assign(i, 1);
+        for (size_t j = 0; j < i; ++j) {
+          messages[i].tags.emplace_back(std::string(j * 20, 'g'));
+          messages[i].headers[std::pmr::string(j * 20 + 1, 'h')].assign(j, 2);
+        }
+      }
+      std::shared_ptr<OutputStream> os = memoryOutputStream();
+      EncoderPtr e = blockingBinaryEncoder();
+      e->init(*os);
+      for (size_t i = 0; i < messages.size(); ++i) {
+        avro::encode(*e, messages[i]);
+      }
+      e->flush();
+      std::vector<uint8_t> data = *snapshot(*os);
+
+      // nested records, array items and map entries are decoded in place, from the arena of the message, map keys included
+      std::pmr::monotonic_buffer_resource arena;
+      pm::Message m(&arena);
+      ResumableDecoder decoder(pm::Message::schema());
+      DefaultResource none(std::pmr::null_memory_resource());
+      size_t decoded = 0;
+      for (size_t pos = 0; pos < data.size(); pos += 3) {
+        const uint8_t* piece = &data[pos];
+        size_t len = std::min<size_t>(3, data.size() - pos);
+        while (len > 0) {
+          size_t consumed;
+          if (decoder.decode(piece, len, consumed, m) == DecodeStatus::DATUM_READY) {
+            const pm::Message& expected = messages[decoded++];
+            REQUIRE(m.id == expected.id);
+            REQUIRE(m.text == expected.text);
+            REQUIRE(m.sender.name == expected.sender.name);
+            REQUIRE(m.sender.avatar == expected.sender.avatar);
+            REQUIRE(m.tags == expected.tags);
+            REQUIRE(m.headers == expected.headers);
+            for (const std::pmr::string& tag : m.tags) {
+              REQUIRE(tag.get_allocator().resource() == &arena);
+            }
+            for (const auto& header : m.headers) {
+              REQUIRE(header.first.get_allocator().resource() == &arena);
+              REQUIRE(header.second.get_allocator().resource() == &arena);
+            }
+          }
+          piece += consumed;
+          len -= consumed;
+        }
+      }
+      REQUIRE(decoded == messages.size());
+    }
+
+    TEST_CASE("Resumable decoder: testMismatch", "[testMismatch]") {
+      ValidSchema schema = compileJsonSchemaFromString(schemaJson);
+      std::vector<uint8_t> data = encodeRecords(1);
+      size_t consumed;
+
+      ResumableDecoder decoder(schema);
+      std::map<std::string, int32_t> m;
+      REQUIRE_THROWS_AS(decoder.decode(&data[0], data.size(), consumed, m), Exception);
+      GenericDatum datum;
+      REQUIRE_THROWS_AS(decoder.decode(&data[0], data.size(), consumed, datum), Exception);
+      ResumableDecoder longs(compileJsonSchemaFromString("{\"type\":\"array\",\"items\":\"long\"}"));
+      std::vector<int32_t> ints;
+      REQUIRE_THROWS_AS(longs.decode(&data[0], data.size(), consumed, ints), Exception);
+
+      // the decoder is still good for the right type
+      pt::TestPrimitiveTypes r;
+      REQUIRE(decoder.decode(&data[0], data.size(), consumed, r) == DecodeStatus::DATUM_READY);
+      REQUIRE(sameRecord(r, makeRecord(0)));
+    }
+
+    TEST_CASE("Resumable decoder: testScanner", "[testScanner]") {
+      DatumScanner scanner(compileJsonSchemaFromString(schemaJson));
+      // an invalid varint in the Int field
+      const uint8_t bad[] = {0x01, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff};
+      REQUIRE_THROWS_AS(scanner.scan(bad, sizeof (bad)), Exception);
+
+      DatumScanner empty(compileJsonSchemaFromString("{\"type\":\"record\",\"name\":\"E\",\"fields\":[]}"));
+      REQUIRE(empty.scan(bad, sizeof (bad)) == 0U);
+      REQUIRE(empty.complete());
+    }
+  }
+}
@@ -20,6 +20,7 @@
 #include <string>
 #include "Compiler.hh"
 #include "ValidSchema.hh"
+#include "gen/primitivetypes.hh"
 
 namespace avro {
   namespace schema {
@@ -207,5 +208,37 @@ namespace avro {
       REQUIRE(result == std::string(schema));
     }
 
+    TEST_CASE("Schema tests: testCanonicalForm", "[testCanonicalForm]") {
+      // fingerprints published with the Avro specification
+      REQUIRE(compileJsonSchemaFromString("\"null\"").fingerprint() == 7195948357588979594ULL);
+      REQUIRE(compileJsonSchemaFromString("{\"type\": \"int\"}").fingerprint() == 8247732601305521295ULL);
+      REQUIRE(compileJsonSchemaFromString("\"string\"").fingerprint() == static_cast<uint64_t> (-8142146995180207161LL));
+
+      ValidSchema s = compileJsonSchemaFromString(
+        "{\"type\": \"record\", \"namespace\": \"a.b\", \"name\": \"R\", \"doc\": \"ignored\", \"fields\": ["
+        "{\"name\": \"x\", \"type\": {\"type\": \"record\", \"name\": \"P\", \"fields\": [{\"name\": \"v\", \"type\": \"long\"}]}},"
+        "{\"name\": \"y\", \"type\": \"P\"}]}");
+      REQUIRE(s.toCanonicalJson() ==
+        "{\"name\":\"a.b.R\",\"type\":\"record\",\"fields\":["
+        "{\"name\":\"x\",\"type\":{\"name\":\"a.b.P\",\"type\":\"record\",\"fields\":[{\"name\":\"v\",\"type\":\"long\"}]}},"
+        "{\"name\":\"y\",\"type\":\"a.b.P\"}]}");
+      REQUIRE(compileJsonSchemaFromString(s.toCanonicalJson()).fingerprint() == s.fingerprint());
+
+      ValidSchema c = compileJsonSchemaFromString(
+        "{\"type\": \"map\", \"values\": {\"type\": \"array\", \"items\": \"string\", \"doc\": \"ignored\"}}");
+      REQUIRE(c.toCanonicalJson() == "{\"type\":\"map\",\"values\":{\"type\":\"array\",\"items\":\"string\"}}");
+      std::ostringstream json;
+      c.toJson(json);
+      REQUIRE(compileJsonSchemaFromString(json.str()).fingerprint() == c.fingerprint());
+
+      // generated code embeds both, and builds the same schema without parsing
+      const ValidSchema& embedded = pt::TestPrimitiveTypes::schema();
+      REQUIRE(&embedded == &pt::TestPrimitiveTypes::schema());
+      REQUIRE(embedded.toCanonicalJson() == pt::TestPrimitiveTypes::schemaJson);
+      REQUIRE(embedded.fingerprint() == pt::TestPrimitiveTypes::schemaFingerprint);
+      REQUIRE(compileJsonSchemaFromString(pt::TestPrimitiveTypes::schemaJson).fingerprint() ==
+        pt::TestPrimitiveTypes::schemaFingerprint);
+    }
+
   }
 }
\ No newline at end of file
@@ -19,6 +19,12 @@
 #include <memory>
 #include "Specific.hh"
 #include "Stream.hh"
+#include "Compiler.hh"
+#include "gen/primitivetypes.hh"
+#include "gen/reuse.hh"
+#include "gen/pmrrecord.hh"
+#include "gen/tree1.hh"
+#include "gen/tree2.hh"
 
 using std::string;
 using std::vector;
@@ -89,6 +95,10 @@ namespace avro {
         e->flush();
       }
 
+      const std::shared_ptr<OutputStream>& output() const {
+        return os;
+      }
+
       template <typename T> void decode(T& t) {
         std::shared_ptr<InputStream> is = memoryInputStream(*os);
         d->init(*is);
@@ -96,6 +106,16 @@ namespace avro {
       }
     };
 
+    /* Checks that encodedSize() tells exactly how many bytes encoding the value writes.*/
+    template <typename T> void checkEncodedSize(const T& t) {
+      std::shared_ptr<OutputStream> os = memoryOutputStream();
+      EncoderPtr e = binaryEncoder();
+      e->init(*os);
+      avro::encode(*e, t);
+      e->flush();
+      REQUIRE(avro::encodedSize(t) == os->byteCount());
+    }
+
     template <typename T> T encodeAndDecode(const T& t) {
       Test tst;
 
@@ -156,5 +176,400 @@ namespace avro {
       REQUIRE(b == n);
     }
 
+    /* Counts the bytes allocated from it.*/
+    class CountingResource : public std::pmr::memory_resource {
+      size_t allocated_;
+
+      void* do_allocate(size_t bytes, size_t alignment) override {
+        allocated_ += bytes;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+      }
+
+      void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+        std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+      }
+
+      bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+      }
+
+    public:
+
+      CountingResource() : allocated_(0) {
+      }
+
+      size_t allocated() const {
+        return allocated_;
+      }
+    };
+
+    /* Makes the given resource the default one for as long as it lives.*/
+    class DefaultResource {
+      std::pmr::memory_resource* old_;
+
+    public:
+
+      explicit DefaultResource(std::pmr::memory_resource* r) : old_(std::pmr::set_default_resource(r)) {
+      }
+
+      ~DefaultResource() {
+        std::pmr::set_default_resource(old_);
+      }
+    };
+
+    TEST_CASE("Specific tests: testPmr", "[testPmr]") {
+      std::string str(100, 'p');
+      vector<uint8_t> bytes(200, 5);
+
+      Test tst;
+      tst.encode(str);
+      tst.encode(bytes);
+
+      CountingResource resource;
+      std::pmr::string s(&resource);
+      std::pmr::vector<uint8_t> b(&resource);
+      std::shared_ptr<InputStream> is = memoryInputStream(*tst.output());
+      DecoderPtr d = binaryDecoder();
+      d->init(*is);
+      avro::decode(*d, s);
+      avro::decode(*d, b);
+      REQUIRE(std::string(s.begin(), s.end()) == str);
+      REQUIRE(vector<uint8_t>(b.begin(), b.end()) == bytes);
+      REQUIRE(resource.allocated() >= str.size() + bytes.size());
+
+      // and back, through a validating encoder which must not lose the string type
+      ValidSchema schema = compileJsonSchemaFromString("\"string\"");
+      std::shared_ptr<OutputStream> os = memoryOutputStream();
+      EncoderPtr e = validatingEncoder(schema, binaryEncoder());
+      e->init(*os);
+      avro::encode(*e, s);
+      e->flush();
+      REQUIRE(os->byteCount() == avro::encodedSize(s));
+    }
+
+    TEST_CASE("Specific tests: testPmrRecord", "[testPmrRecord]") {
+      pm::Message m;
+      m.id = 42;
+      m.text = "hello";
+      m.payload.assign(100, 7);
+      m.sender.name = "sender";
+      m.sender.avatar.assign(50, 3);
+      m.tags.emplace_back("a tag that is too long for the small string buffer");
+      m.headers["key"].assign(10, 1);
+
+      Test tst;
+      tst.encode(m);
+      REQUIRE(avro::encodedSize(m) == tst.output()->byteCount());
+
+      // everything decoded comes from the arena of the record, nested records and container items included
+      std::pmr::monotonic_buffer_resource arena;
+      pm::Message decoded(&arena);
+      tst.decode(decoded);
+      REQUIRE(decoded.id == 42);
+      REQUIRE(decoded.text == m.text);
+      REQUIRE(decoded.payload == m.payload);
+      REQUIRE(decoded.sender.name == m.sender.name);
+      REQUIRE(decoded.sender.avatar == m.sender.avatar);
+      REQUIRE(decoded.tags == m.tags);
+      REQUIRE(decoded.headers == m.headers);
+      REQUIRE(decoded.text.get_allocator().resource() == &arena);
+      REQUIRE(decoded.payload.get_allocator().resource() == &arena);
+      REQUIRE(decoded.sender.name.get_allocator().resource() == &arena);
+      REQUIRE(decoded.sender.avatar.get_allocator().resource() == &arena);
+      REQUIRE(decoded.tags.get_allocator().resource() == &arena);
+      REQUIRE(decoded.tags[0].get_allocator().resource() == &arena);
+      REQUIRE(decoded.headers.get_allocator().resource() == &arena);
+      REQUIRE(decoded.headers.begin()->first.get_allocator().resource() == &arena);
+      REQUIRE(decoded.headers.begin()->second.get_allocator().resource() == &arena);
+
+      // copies into another arena move over to it
+      std::pmr::monotonic_buffer_resource other;
+      pm::Message copy(decoded, &other);
+      REQUIRE(copy.sender.name.get_allocator().resource() == &other);
+      REQUIRE(copy.tags[0].get_allocator().resource() == &other);
+    }
+
+    TEST_CASE("Specific tests: testArray", "[testArray]") {
+      vector<int32_t> n;
+      for (int32_t i = 0; i < 10; ++i) {
+        n.push_back(i * 17);
+      }
+      REQUIRE(encodeAndDecode(n) == n);
+      REQUIRE(encodeAndDecode(vector<int32_t>()).empty());
+
+      vector<vector<string> > nested(3, vector<string>(2, "s"));
+      nested[1].clear();
+      REQUIRE(encodeAndDecode(nested) == nested);
+    }
+
+    TEST_CASE("Specific tests: testMap", "[testMap]") {
+      map<string, int64_t> m;
+      m["one"] = 1;
+      m["two"] = 2;
+      REQUIRE(encodeAndDecode(m) == m);
+
+      std::pmr::monotonic_buffer_resource pool;
+      std::pmr::map<std::pmr::string, std::pmr::vector<std::pmr::string> > pm(&pool);
+      pm[std::pmr::string("k")].push_back(std::pmr::string(40, 'x'));
+      Test tst;
+      tst.encode(pm);
+      std::pmr::map<std::pmr::string, std::pmr::vector<std::pmr::string> > actual(&pool);
+      tst.decode(actual);
+      REQUIRE(actual == pm);
+      REQUIRE(actual.begin()->second.front().get_allocator().resource() == &pool);
+
+      // keys are decoded on the memory of the map, never on the default resource
+      std::pmr::map<std::pmr::string, int32_t> keyed(&pool);
+      keyed[std::pmr::string(40, 'a')] = 1;
+      keyed[std::pmr::string(50, 'b')] = 2;
+      Test keys;
+      keys.encode(keyed);
+      std::pmr::map<std::pmr::string, int32_t> decoded(&pool);
+      {
+        DefaultResource none(std::pmr::null_memory_resource());
+        keys.decode(decoded);
+      }
+      REQUIRE(decoded == keyed);
+      REQUIRE(decoded.begin()->first.get_allocator().resource() == &pool);
+    }
+
+    TEST_CASE("Specific tests: testContainerReuse", "[testContainerReuse]") {
+      typedef std::pmr::vector<std::pmr::string> Strings;
+      typedef std::pmr::map<std::pmr::string, std::pmr::vector<int64_t> > Lists;
+      Strings strings(5, std::pmr::string(50, 's'));
+      Lists lists;
+      lists[std::pmr::string(30, 'a')].assign(10, 1);
+      lists[std::pmr::string(30, 'b')].assign(20, 2);
+
+      Test tst;
+      tst.encode(strings);
+      tst.encode(lists);
+      tst.encode(vector<bool>(3, true));
+
+      CountingResource resource;
+      Strings s(&resource);
+      Lists l(&resource);
+      vector<bool> b;
+      for (int i = 0; i < 3; ++i) {
+        std::shared_ptr<InputStream> is = memoryInputStream(*tst.output());
+        DecoderPtr d = binaryDecoder();
+        d->init(*is);
+        size_t before = resource.allocated();
+        avro::decode(*d, s);
+        avro::decode(*d, l);
+        avro::decode(*d, b);
+        REQUIRE(s == strings);
+        REQUIRE(l == lists);
+        REQUIRE(b == vector<bool>(3, true));
+        if (i > 0) {
+          // the items and nodes of the previous decode are reused
+          REQUIRE(resource.allocated() == before);
+        }
+      }
+
+      // fewer items than before
+      Test shorter;
+      shorter.encode(Strings(2, std::pmr::string("x")));
+      shorter.decode(s);
+      REQUIRE(s == Strings(2, std::pmr::string("x")));
+
+      // a corrupt count runs out of input before it runs out of memory
+      const uint8_t corrupt[] = {0xfe, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x7f, 0x02, 'x'};
+      std::shared_ptr<InputStream> is = memoryInputStream(corrupt, sizeof (corrupt));
+      DecoderPtr d = binaryDecoder();
+      d->init(*is);
+      vector<string> v;
+      REQUIRE_THROWS_AS(avro::decode(*d, v), Exception);
+      REQUIRE(v.capacity() < 100000U);
+    }
+
+    TEST_CASE("Specific tests: testEncodedSize", "[testEncodedSize]") {
+      int32_t ints[] = {0, 1, -1, 63, -64, 64, -65, 8191, 8192, 1 << 20, std::numeric_limits<int32_t>::max(),
+        std::numeric_limits<int32_t>::min()};
+      for (int32_t i : ints) {
+        checkEncodedSize(i);
+        checkEncodedSize(static_cast<int64_t> (i) * 65536);
+      }
+      checkEncodedSize(std::numeric_limits<int64_t>::max());
+      checkEncodedSize(std::numeric_limits<int64_t>::min());
+      checkEncodedSize(true);
+      checkEncodedSize(1.5f);
+      checkEncodedSize(2.5);
+      checkEncodedSize(avro::null());
+      checkEncodedSize(string());
+      checkEncodedSize(string(200, 'a'));
+      checkEncodedSize(vector<uint8_t>(70000, 1));
+      checkEncodedSize(vector<int32_t>());
+      checkEncodedSize(vector<string>(200, "item"));
+      map<string, vector<int64_t> > m;
+      checkEncodedSize(m);
+      m["a"].assign(3, 1LL << 40);
+      m["b"];
+      checkEncodedSize(m);
+
+      pt::TestPrimitiveTypes r;
+      checkEncodedSize(r);
+      r.Int = -100000;
+      r.Long = 1LL << 40;
+      r.Bytes.assign(300, 9);
+      r.String = "a string";
+      checkEncodedSize(r);
+
+      // nested records add up their fields
+      ru::outer o;
+      checkEncodedSize(o);
+      o.f1.g2 = -100000;
+      o.f2.g1 = true;
+      checkEncodedSize(o);
+      REQUIRE(avro::encodedSize(o) == avro::encodedSize(o.f1) + avro::encodedSize(o.f2));
+      REQUIRE(ru::outer::schema().fingerprint() == ru::outer::schemaFingerprint);
+    }
+
+    TEST_CASE("Specific tests: testRecursive", "[testRecursive]") {
+      tr1::Node n;
+      n.payload = 1;
+      n.edges.resize(2);
+      n.edges[0].label = "left";
+      n.edges[0].child.payload = 2;
+      n.edges[1].label = "right";
+      n.edges[1].child.payload = 3;
+      n.edges[1].child.edges.resize(1);
+      n.edges[1].child.edges[0].child.payload = 4;
+
+      Test tst;
+      tst.encode(n);
+      REQUIRE(avro::encodedSize(n) == tst.output()->byteCount());
+      tr1::Node t1;
+      tst.decode(t1);
+      REQUIRE(t1.payload == 1);
+      REQUIRE(t1.edges.size() == 2);
+      REQUIRE(t1.edges[0].label == "left");
+      REQUIRE(t1.edges[1].child.payload == 3);
+      REQUIRE(t1.edges[1].child.edges[0].child.payload == 4);
+
+      // the embedded schemas link back to the records they are nested in
+      REQUIRE(tr1::Node::schema().toCanonicalJson() == tr1::Node::schemaJson);
+      REQUIRE(tr1::Node::schema().fingerprint() == tr1::Node::schemaFingerprint);
+      REQUIRE(tr2::Node::schema().toCanonicalJson() == tr2::Node::schemaJson);
+      REQUIRE(tr2::Node::schema().fingerprint() == tr2::Node::schemaFingerprint);
+
+      tr2::Node m;
+      m.edges["a"].payload = 5;
+      m.edges["a"].edges["b"].payload = 6;
+      Test tst2;
+      tst2.encode(m);
+      tr2::Node t2;
+      tst2.decode(t2);
+      REQUIRE(t2.edges["a"].payload == 5);
+      REQUIRE(t2.edges["a"].edges["b"].payload == 6);
+    }
+
+    TEST_CASE("Specific tests: testView", "[testView]") {
+      pt::TestPrimitiveTypes r;
+      r.Boolean = true;
+      r.Int = -7;
+      r.Long = 1LL << 50;
+      r.Float = 1.25f;
+      r.Double = -3.5;
+      r.Bytes.assign(100, 3);
+      r.String = "in place";
+
+      MemoryOutputStream os;
+      EncoderPtr e = binaryEncoder();
+      e->init(os);
+      avro::encode(*e, r);
+      e->flush();
+      size_t len;
+      std::unique_ptr<uint8_t[]> data = os.releaseContiguous(&len);
+
+      pt::TestPrimitiveTypesView v;
+      ViewDecoder d(data.get(), len);
+      avro::decodeView(d, v);
+      REQUIRE(d.remaining() == 0);
+      REQUIRE(v.Boolean == r.Boolean);
+      REQUIRE(v.Int == r.Int);
+      REQUIRE(v.Long == r.Long);
+      REQUIRE(v.Float == r.Float);
+      REQUIRE(v.Double == r.Double);
+      REQUIRE(vector<uint8_t>(v.Bytes.begin(), v.Bytes.end()) == r.Bytes);
+      REQUIRE(v.String == r.String);
+
+      // the variable length members point into the decoded memory
+      REQUIRE(v.String.data() > reinterpret_cast<const char*> (data.get()));
+      REQUIRE(v.String.data() < reinterpret_cast<const char*> (data.get() + len));
+
+      pt::TestPrimitiveTypesView truncated;
+      REQUIRE_THROWS_AS(avro::decodeView(data.get(), len - 1, truncated), Exception);
+    }
+
+
+    /* Counts the leaf fields of a record, descending into nested records.*/
+    struct LeafCounter {
+      size_t count;
+
+      template <typename D, typename V> void operator()(const D&, const V& v) {
+        if constexpr (is_record<V>::value) {
+          visit_fields(v, *this);
+        } else {
+          ++count;
+        }
+      }
+    };
+
+    TEST_CASE("Specific tests: testFieldVisitor", "[testFieldVisitor]") {
+      typedef record_traits<pt::TestPrimitiveTypes> Traits;
+      static_assert(Traits::fieldCount == 9, "one descriptor per field");
+      static_assert(std::get<2>(Traits::fields).index == 2, "fields in schema order");
+      static_assert(std::get<2>(Traits::fields).type == Type::AVRO_INT, "Avro type of the field");
+      static_assert(is_record<pt::TestPrimitiveTypes>::value && !is_record<int32_t>::value, "generated records have traits");
+
+      // the table agrees with the schema
+      const NodePtr& root = pt::TestPrimitiveTypes::schema().root();
+      size_t n = 0;
+      visit_field_descriptors<pt::TestPrimitiveTypes>([&root, &n](const auto& field) {
+        REQUIRE(field.index == n);
+        REQUIRE(root->nameAt(n) == field.name);
+        REQUIRE(root->leafAt(n)->type() == field.type);
+        ++n;
+      });
+      REQUIRE(n == root->leaves());
+
+      pt::TestPrimitiveTypes a;
+      a.Int = 5;
+      a.String = "five";
+      a.Bytes.assign(5, 5);
+
+      // comparison, field by field
+      pt::TestPrimitiveTypes b = a;
+      b.Long = 6;
+      b.String = "six";
+      vector<string> differing;
+      visit_fields(a, b, [&differing](const auto& field, const auto& x, const auto& y) {
+        if (!(x == y)) {
+          differing.push_back(field.name);
+        }
+      });
+      REQUIRE(differing == vector<string>({"Long", "String"}));
+
+      // projection of some fields into another record
+      pt::TestPrimitiveTypes projected;
+      visit_fields(projected, [&a](const auto& field, auto& value) {
+        if (field.type == Type::AVRO_STRING || field.type == Type::AVRO_INT) {
+          value = field.get(a);
+        }
+      });
+      REQUIRE(projected.Int == 5);
+      REQUIRE(projected.String == "five");
+      REQUIRE(projected.Bytes.empty());
+
+      // views carry the same table
+      static_assert(record_traits<pt::TestPrimitiveTypesView>::fieldCount == Traits::fieldCount, "view fields");
+
+      LeafCounter counter = {0};
+      ru::outer o;
+      visit_fields(o, counter);
+      REQUIRE(counter.count == 4);
+    }
+
   }
 }
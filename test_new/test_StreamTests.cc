@@ -18,6 +18,15 @@
 #include <catch.hpp>
 #include "boost/filesystem.hpp"
 #include "Stream.hh"
+#include "BufferStreamAdapter.hh"
+#include "ChunkPipe.hh"
+#include "ShmRing.hh"
+#include "FramedStream.hh"
+#include "Encoder.hh"
+#include "Decoder.hh"
+#include "sys/wait.h"
+#include <thread>
+#include "unistd.h"
 #include "Exception.hh"
 
 namespace avro {
@@ -123,6 +132,75 @@ namespace avro {
       V()(*is, td.dataSize);
     }
 
+    template <typename F, typename V>
+    void testNonEmpty_growingMemoryStream(const TestData& td) {
+      std::shared_ptr<OutputStream> os = memoryOutputStream(td.chunkSize, 4 * td.chunkSize);
+      F()(*os, td.dataSize);
+
+      std::shared_ptr<InputStream> is = memoryInputStream(*os);
+      V()(*is, td.dataSize);
+      REQUIRE(snapshot(*os)->size() == td.dataSize);
+    }
+
+    void testMemoryStreamContiguous() {
+      std::shared_ptr<OutputStream> os = memoryOutputStream(100, 800);
+      reserve(*os, 1000);
+      Fill1()(*os, 1000);
+      const uint8_t* d;
+      size_t n;
+      std::shared_ptr<InputStream> is = memoryInputStream(*os);
+      REQUIRE(is->next(&d, &n));
+      REQUIRE(n == 1000U);
+
+      size_t len;
+      std::unique_ptr<uint8_t[]> b = releaseContiguous(*os, &len);
+      REQUIRE(len == 1000U);
+      REQUIRE(b.get() == d);
+      REQUIRE(os->byteCount() == 0U);
+
+      // spread over several chunks, so the contents are gathered
+      Fill1()(*os, 1000);
+      b = releaseContiguous(*os, &len);
+      REQUIRE(len == 1000U);
+      for (size_t i = 0; i < len; ++i) {
+        REQUIRE(b[i] == i % 10 + '0');
+      }
+
+      b = releaseContiguous(*os, &len);
+      REQUIRE(len == 0U);
+    }
+
+    void testMemoryStreamReuse() {
+      MemoryOutputStream os(100, 400);
+      MemoryInputStream is;
+      for (size_t size = 1000; size > 0; size /= 3) {
+        os.reset();
+        Fill2()(os, size);
+        REQUIRE(os.byteCount() == size);
+
+        std::shared_ptr<std::vector<uint8_t> > v = snapshot(os);
+        is.reset(v->empty() ? 0 : &(*v)[0], v->size());
+        Verify1()(is, size);
+
+        std::shared_ptr<InputStream> in = memoryInputStream(os);
+        Verify2()(*in, size);
+      }
+
+      // the chunks allocated for the first message are enough for the others
+      os.reset();
+      uint8_t* first;
+      size_t n;
+      os.next(&first, &n);
+      for (int i = 0; i < 3; ++i) {
+        os.reset();
+        Fill1()(os, 1000);
+        os.reset();
+        uint8_t* b;
+        os.next(&b, &n);
+        REQUIRE(b == first);
+      }
+    }
+
     void testNonEmpty2(const TestData& td) {
       std::vector<uint8_t> v;
       for (size_t i = 0; i < td.dataSize; ++i) {
@@ -134,6 +212,210 @@ namespace avro {
       Verify1()(*is, td.dataSize);
     }
 
+    template <typename V>
+    void testEmpty_bufferStream() {
+      OutputBuffer ob;
+      {
+        std::shared_ptr<OutputStream> os = bufferOutputStream(ob);
+      }
+      std::shared_ptr<InputStream> is = bufferInputStream(ob);
+      V()(*is);
+    }
+
+    template <typename F, typename V>
+    void testNonEmpty_bufferStream(const TestData& td) {
+      OutputBuffer ob;
+      {
+        std::shared_ptr<OutputStream> os = bufferOutputStream(ob, td.chunkSize);
+        F()(*os, td.dataSize);
+        REQUIRE(os->byteCount() == td.dataSize);
+      }
+      REQUIRE(ob.size() == td.dataSize);
+
+      std::shared_ptr<InputStream> is = bufferInputStream(ob);
+      V()(*is, td.dataSize);
+    }
+
+    void testBufferStreamNoCopy() {
+      OutputBuffer ob;
+      std::shared_ptr<OutputStream> os = bufferOutputStream(ob);
+      Fill1()(*os, 1000);
+
+      InputBuffer ib = ob;
+      std::shared_ptr<InputStream> is = bufferInputStream(ib);
+      const uint8_t* d;
+      size_t n;
+      REQUIRE(is->next(&d, &n));
+      REQUIRE(n == 1000U);
+      REQUIRE(reinterpret_cast<const char*> (d) == ib.begin()->data());
+
+      is->backup(500);
+      is->skip(100);
+      REQUIRE(is->byteCount() == 600U);
+      REQUIRE(is->next(&d, &n));
+      REQUIRE(n == 400U);
+      REQUIRE(*d == '0');
+      REQUIRE(!is->next(&d, &n));
+    }
+
+    template <typename F, typename V>
+    void testNonEmpty_chunkPipe(const TestData& td) {
+      ChunkPipe pipe(4, td.chunkSize);
+      std::thread producer([&pipe, &td]() {
+        F()(pipe.output(), td.dataSize);
+        pipe.close();
+      });
+      V()(pipe.input(), td.dataSize);
+      producer.join();
+    }
+
+    void testChunkPipeDrain() {
+      int fds[2];
+      REQUIRE(::pipe(fds) == 0);
+
+      const size_t dataSize = 100000;
+      ChunkPipe pipe(3, 1024);
+      std::thread producer([&pipe, dataSize]() {
+        StreamWriter w(pipe.output());
+        for (size_t i = 0; i < dataSize; ++i) {
+          w.write(i % 10 + '0');
+          if (i % 777 == 0) {
+            w.flush();
+          }
+        }
+        w.flush();
+        pipe.close();
+      });
+
+      size_t written = 0;
+      std::thread drainer([&pipe, &written, &fds]() {
+        written = pipe.drainTo(fds[1]);
+        ::close(fds[1]);
+      });
+
+      std::vector<uint8_t> v;
+      uint8_t b[4096];
+      ssize_t n;
+      while ((n = ::read(fds[0], b, sizeof (b))) > 0) {
+        v.insert(v.end(), b, b + n);
+      }
+      ::close(fds[0]);
+      producer.join();
+      drainer.join();
+
+      REQUIRE(written == dataSize);
+      std::vector<uint8_t> expected;
+      for (size_t i = 0; i < dataSize; ++i) {
+        expected.push_back(i % 10 + '0');
+      }
+      REQUIRE(v == expected);
+    }
+
+    /* Decodes the records written by testShmRing(), returns the number of records that are not as expected.*/
+    int readShmRecords(const char* name, int count) {
+      int errors = 0;
+      ShmInputStream is(name);
+      DecoderPtr d = binaryDecoder();
+      for (int i = 0; i < count; ++i) {
+        if (!is.nextRecord()) {
+          return errors + count - i;
+        }
+        d->init(is);
+        std::string s = d->decodeString();
+        if (d->decodeInt() != i || s != std::string(i % 97, 'a' + i % 26)) {
+          ++errors;
+        }
+      }
+      return errors + (is.nextRecord() ? 1 : 0);
+    }
+
+    void testShmRing() {
+      std::string name = "/avro_test_ring_" + std::to_string(::getpid());
+      const int count = 2000;
+
+      ShmOutputStream os(name.c_str(), 512);
+      pid_t pid = ::fork();
+      REQUIRE(pid >= 0);
+      if (pid == 0) {
+        int errors = 1;
+        try {
+          errors = readShmRecords(name.c_str(), count);
+        } catch (...) {
+        }
+        ::_exit(errors == 0 ? 0 : 1);
+      }
+
+      EncoderPtr e = binaryEncoder();
+      e->init(os);
+      for (int i = 0; i < count; ++i) {
+        e->encodeString(std::string(i % 97, 'a' + i % 26));
+        e->encodeInt(i);
+        e->flush();
+      }
+      os.close();
+
+      int status = 0;
+      REQUIRE(::waitpid(pid, &status, 0) == pid);
+      REQUIRE(WIFEXITED(status));
+      REQUIRE(WEXITSTATUS(status) == 0);
+
+      // a record that cannot fit
+      EncoderPtr e2 = binaryEncoder();
+      ShmOutputStream small((name + "_small").c_str(), 64);
+      e2->init(small);
+      REQUIRE_THROWS_AS(e2->encodeString(std::string(100, 'x')), Exception);
+    }
+
+    void testFramedStream(FrameLengthEncoding encoding, size_t batchSize) {
+      const int count = 300;
+      MemoryOutputStream mos(64);
+      {
+        FramedOutputStream os(mos, encoding, batchSize);
+        EncoderPtr e = binaryEncoder();
+        e->init(os);
+        for (int i = 0; i < count; ++i) {
+          e->encodeString(std::string(i, 'a' + i % 26));
+          e->encodeInt(i);
+          e->flush();
+        }
+        os.endFrame();
+        os.sync();
+      }
+
+      std::shared_ptr<InputStream> in = memoryInputStream(mos);
+      FramedInputStream is(*in, encoding);
+      DecoderPtr d = binaryDecoder();
+      for (int i = 0; i < count; ++i) {
+        REQUIRE(is.nextFrame());
+        if (i % 3 == 0) {
+          continue;
+        }
+        if (i % 3 == 1) {
+          size_t size = is.frameSize();
+          if (const uint8_t* frame = is.contiguousFrame()) {
+            MemoryInputStream fis(frame, size);
+            d->init(fis);
+            REQUIRE(d->decodeString() == std::string(i, 'a' + i % 26));
+            REQUIRE(d->decodeInt() == i);
+            continue;
+          }
+        }
+        d->init(is);
+        REQUIRE(d->decodeString() == std::string(i, 'a' + i % 26));
+        REQUIRE(d->decodeInt() == i);
+      }
+      REQUIRE(is.nextFrame());
+      REQUIRE(is.frameSize() == 0U);
+      REQUIRE(!is.nextFrame());
+    }
+
+    void testFramedStreamTruncated() {
+      const uint8_t data[] = {0x00, 0x00, 0x01};
+      MemoryInputStream in(data, sizeof (data));
+      FramedInputStream is(in, FrameLengthEncoding::FIXED32);
+      REQUIRE_THROWS_AS(is.nextFrame(), Exception);
+    }
+
     static const char filename[] = "test_str.bin";
 
     struct FileRemover {
@@ -192,8 +474,36 @@ TEST_CASE("Avro C++ unit test suite for streams", "[all]") {
   for (auto& item : avro::stream::data) avro::stream::testNonEmpty_memoryStream<avro::stream::Fill2, avro::stream::Verify1>(item);
   for (auto& item : avro::stream::data) avro::stream::testNonEmpty_memoryStream<avro::stream::Fill2, avro::stream::Verify2>(item);
 
+  for (auto& item : avro::stream::data) avro::stream::testNonEmpty_growingMemoryStream<avro::stream::Fill1, avro::stream::Verify1>(item);
+  for (auto& item : avro::stream::data) avro::stream::testNonEmpty_growingMemoryStream<avro::stream::Fill2, avro::stream::Verify2>(item);
+
+  avro::stream::testMemoryStreamContiguous();
+  avro::stream::testMemoryStreamReuse();
+
   for (auto& item : avro::stream::data) avro::stream::testNonEmpty2(item);
 
+  avro::stream::testEmpty_bufferStream<avro::stream::CheckEmpty1>();
+  avro::stream::testEmpty_bufferStream<avro::stream::CheckEmpty2>();
+
+  for (auto& item : avro::stream::data) avro::stream::testNonEmpty_bufferStream<avro::stream::Fill1, avro::stream::Verify1>(item);
+  for (auto& item : avro::stream::data) avro::stream::testNonEmpty_bufferStream<avro::stream::Fill2, avro::stream::Verify1>(item);
+  for (auto& item : avro::stream::data) avro::stream::testNonEmpty_bufferStream<avro::stream::Fill2, avro::stream::Verify2>(item);
+
+  avro::stream::testBufferStreamNoCopy();
+
+  for (auto& item : avro::stream::data) avro::stream::testNonEmpty_chunkPipe<avro::stream::Fill1, avro::stream::Verify1>(item);
+  for (auto& item : avro::stream::data) avro::stream::testNonEmpty_chunkPipe<avro::stream::Fill2, avro::stream::Verify1>(item);
+  for (auto& item : avro::stream::data) avro::stream::testNonEmpty_chunkPipe<avro::stream::Fill2, avro::stream::Verify2>(item);
+
+  avro::stream::testChunkPipeDrain();
+
+  avro::stream::testShmRing();
+
+  avro::stream::testFramedStream(avro::FrameLengthEncoding::VARINT, 0);
+  avro::stream::testFramedStream(avro::FrameLengthEncoding::FIXED32, 0);
+  avro::stream::testFramedStream(avro::FrameLengthEncoding::VARINT, 4096);
+  avro::stream::testFramedStreamTruncated();
+
   avro::stream::testEmpty_fileStream<avro::stream::CheckEmpty1>();
   avro::stream::testEmpty_fileStream<avro::stream::CheckEmpty2>();
 
@@ -20,6 +20,7 @@
 #include <boost/bind.hpp>
 #include <boost/scoped_array.hpp>
 #include <fstream>
+#include <thread>
 #include <iostream>
 #include "buffer/BufferStream.hh"
 #include "buffer/BufferReader.hh"
@@ -938,3 +939,121 @@ TEST_CASE("Buffers: TestPrinter", "[TestPrinter]") {
   addDataToBuffer(ob, 128);
   std::cout << ob << std::endl;
 }
+
+struct CountingAllocator : public detail::ChunkAllocator {
+  size_t allocated;
+
+  CountingAllocator() : allocated(0) { }
+
+  boost::shared_array<detail::data_type> allocate(detail::size_type size) {
+    ++allocated;
+    return boost::shared_array<detail::data_type>(new detail::data_type[size]);
+  }
+};
+
+void fillAndRelease(size_t size) {
+  OutputBuffer ob;
+  addDataToBuffer(ob, size);
+}
+
+TEST_CASE("Buffers: TestChunkPool", "[TestChunkPool]") {
+  SECTION("Released blocks are reused by the same thread") {
+    detail::ChunkPool &pool = detail::ChunkPool::local();
+    fillAndRelease(kDefaultBlockSize);
+    size_t cached = pool.freeBlocks(kDefaultBlockSize);
+    REQUIRE(cached > 0U);
+
+    OutputBuffer ob(kDefaultBlockSize);
+    REQUIRE(pool.freeBlocks(kDefaultBlockSize) == cached - 1);
+    ob = OutputBuffer();
+    REQUIRE(pool.freeBlocks(kDefaultBlockSize) == cached);
+  }
+
+  SECTION("Blocks keep the requested capacity") {
+    OutputBuffer ob(kMinBlockSize + 1);
+    REQUIRE(ob.freeSpace() == kMinBlockSize + 1);
+    addDataToBuffer(ob, kMinBlockSize + 1);
+    InputBuffer ib(ob);
+    REQUIRE(ib.size() == kMinBlockSize + 1);
+  }
+
+  SECTION("Blocks released on another thread go back to their pool") {
+    detail::ChunkPool &pool = detail::ChunkPool::local();
+    std::vector<OutputBuffer> held;
+    while (pool.freeBlocks(kDefaultBlockSize)) {
+      held.push_back(OutputBuffer(kDefaultBlockSize));
+    }
+
+    OutputBuffer ob;
+    addDataToBuffer(ob, 4 * kDefaultBlockSize);
+    InputBuffer ib(ob);
+    ob = OutputBuffer();
+
+    std::thread releaser([&ib]() {
+      ib = InputBuffer();
+    });
+    releaser.join();
+    REQUIRE(pool.freeBlocks(kDefaultBlockSize) == 0U);
+
+    // the owner picks the returned blocks up once its own free list runs dry
+    OutputBuffer reused(kDefaultBlockSize);
+    REQUIRE(pool.freeBlocks(kDefaultBlockSize) > 0U);
+  }
+
+  SECTION("A custom allocator supplies every block") {
+    std::shared_ptr<CountingAllocator> allocator(new CountingAllocator);
+    OutputBuffer ob(0, allocator);
+    addDataToBuffer(ob, 3 * kMaxBlockSize);
+    REQUIRE(allocator->allocated > 0U);
+    REQUIRE(ob.size() == 3 * kMaxBlockSize);
+
+    OutputBuffer copy;
+    copy.append(ob);
+    REQUIRE(copy.size() == ob.size());
+  }
+}
+
+TEST_CASE("Buffers: TestReadVarInt", "[TestReadVarInt]") {
+  // 300 is 0xac 0x02, the maximum value takes ten bytes
+  const char small[] = {'\x01'};
+  const char split[] = {'\xac'};
+  const char rest[] = {'\x02', '\xff', '\xff', '\xff', '\xff', '\xff', '\xff', '\xff', '\xff', '\xff', '\x01', '\x80'};
+
+  OutputBuffer ob;
+  ob.appendForeignData(small, sizeof (small), detail::free_func());
+  ob.appendForeignData(split, sizeof (split), detail::free_func());
+  ob.appendForeignData(rest, sizeof (rest), detail::free_func());
+
+  BufferReader reader(ob);
+  uint64_t val = 0;
+  REQUIRE(reader.readVarInt(val));
+  REQUIRE(val == 1U);
+  REQUIRE(reader.readVarInt(val));
+  REQUIRE(val == 300U);
+  REQUIRE(reader.readVarInt(val));
+  REQUIRE(val == std::numeric_limits<uint64_t>::max());
+  REQUIRE(reader.bytesRemaining() == 1U);
+  REQUIRE(!reader.readVarInt(val));
+  REQUIRE(!reader.readVarInt(val));
+}
+
+TEST_CASE("Buffers: TestPeekContiguous", "[TestPeekContiguous]") {
+  const size_t size = kDefaultBlockSize + 100;
+  std::string data = makeString(size);
+  OutputBuffer ob;
+  addDataToBuffer(ob, size);
+  BufferReader reader(ob);
+
+  REQUIRE(reader.peekContiguous(kDefaultBlockSize) != 0);
+  REQUIRE(reader.peekContiguous(kDefaultBlockSize + 1) == 0);
+  reader.skip(kDefaultBlockSize - 5);
+  REQUIRE(reader.peekContiguous(5) != 0);
+  REQUIRE(reader.peekContiguous(6) == 0);
+
+  char buf[20];
+  REQUIRE(reader.read(buf, sizeof (buf)) == sizeof (buf));
+  REQUIRE(std::string(buf, sizeof (buf)) == data.substr(kDefaultBlockSize - 5, sizeof (buf)));
+  REQUIRE(reader.peekContiguous(85) != 0);
+  REQUIRE(*reader.peekContiguous(85) == data[kDefaultBlockSize + 15]);
+  REQUIRE(reader.peekContiguous(86) == 0);
+}